@@ -55,25 +55,33 @@
 #include "threadpool.h"
 #endif
 
-typedef struct { NVGcontext* vg; float* fbuff; int fbuffw, fbuffh; float sdfScale, sdfOffset; } SDFcontext;
-
-static const float INITIAL_SDF_DIST = 1E6f;
+// glyph SDFs are generated directly into the fontstash atlas; glyphs requested by fontstash are drawn in a single
+//  nanovg frame (so tiles are rendered in parallel) which is ended when fontstash flushes
+typedef struct { NVGcontext* vg; FONScontext* fs; unsigned char* atlas; } SDFcontext;
 
 static void sdfRender(void* uptr, void* fontimpl, unsigned char* output,
       int outWidth, int outHeight, int outStride, float scale, int padding, int glyph)
 {
   SDFcontext* ctx = (SDFcontext*)uptr;
-
-  nvgBeginFrame(ctx->vg, 0, 0, 1);
+  if(!ctx->atlas) {
+    int w = 0, h = 0;
+    ctx->atlas = (unsigned char*)fonsGetTextureData(ctx->fs, &w, &h);
+    nvgswSetFramebufferFormat(ctx->vg, ctx->atlas, w, h, outStride, NVGSW_A8);
+    nvgBeginFrame(ctx->vg, w, h, 1);
+  }
+  int offset = output - ctx->atlas;
+  nvgResetTransform(ctx->vg);
+  nvgTranslate(ctx->vg, offset % outStride, offset / outStride);
+  nvgScissor(ctx->vg, 0, 0, outWidth, outHeight);
   nvgDrawSTBTTGlyph(ctx->vg, (stbtt_fontinfo*)fontimpl, scale, padding, glyph);
-  nvgEndFrame(ctx->vg);
+}
 
-  for(int iy = 0; iy < outHeight; ++iy) {
-    for(int ix = 0; ix < outWidth; ++ix) {
-      float sd = ctx->fbuff[ix + iy*ctx->fbuffw] * ctx->sdfScale + ctx->sdfOffset;
-      output[ix + iy*outStride] = (unsigned char)(0.5f + glnvg__minf(glnvg__maxf(sd, 0.f), 255.f));
-      ctx->fbuff[ix + iy*ctx->fbuffw] = INITIAL_SDF_DIST;   // will get clamped to 255
-    }
+static void sdfFlush(void* uptr)
+{
+  SDFcontext* ctx = (SDFcontext*)uptr;
+  if(ctx->atlas) {
+    nvgEndFrame(ctx->vg);
+    ctx->atlas = NULL;
   }
 }
 
@@ -81,11 +89,10 @@ static void sdfDelete(void* uptr)
 {
   SDFcontext* ctx = (SDFcontext*)uptr;
   nvgswDelete(ctx->vg);
-  free(ctx->fbuff);
   free(ctx);
 }
 
-FONScontext* createFontstash(int nvgFlags, int maxAtlasFontPx)
+FONScontext* createFontstash(int nvgFlags, int numThreads)
 {
   FONSparams params;
   memset(&params, 0, sizeof(FONSparams));
@@ -95,21 +102,21 @@ FONScontext* createFontstash(int nvgFlags, int maxAtlasFontPx)
   params.sdfPixelDist = 32.0f;
 
   SDFcontext* ctx = malloc(sizeof(SDFcontext));
-  ctx->fbuffh = ctx->fbuffw = maxAtlasFontPx + 2*params.sdfPadding + 16;
-  // we use dist < 0.0f inside glyph; but for scale > 0, stbtt uses >on_edge_value for inside
-  ctx->sdfScale = -params.sdfPixelDist;
-  ctx->sdfOffset = 127;  // stbtt on_edge_value
-
-  ctx->fbuff = malloc(ctx->fbuffw*ctx->fbuffh*sizeof(float));
-  for(size_t ii = 0; ii < ctx->fbuffw*ctx->fbuffh; ++ii)
-    ctx->fbuff[ii] = INITIAL_SDF_DIST;
+  ctx->atlas = NULL;
   ctx->vg = nvgswCreate(NVG_AUTOW_DEFAULT | NVG_NO_FONTSTASH | NVGSW_PATHS_XC | NVGSW_SDFGEN);
-  nvgswSetFramebuffer(ctx->vg, ctx->fbuff, ctx->fbuffw, ctx->fbuffh, params.sdfPadding, 0,0,0);
+#ifndef NO_THREADING
+  if(numThreads > 1)
+    nvgswSetThreadCount(ctx->vg, numThreads);
+#endif
+  // we use dist < 0.0f inside glyph; but for scale > 0, stbtt uses >on_edge_value for inside
+  nvgswSetSDFParams(ctx->vg, params.sdfPadding, -params.sdfPixelDist, 127);  // 127 = stbtt on_edge_value
 
   params.userPtr = ctx;
   params.userSDFRender = sdfRender;
+  params.userSDFFlush = sdfFlush;
   params.userDelete = sdfDelete;
-  return fonsCreateInternal(&params);
+  ctx->fs = fonsCreateInternal(&params);
+  return ctx->fs;
 }
 
 int SDL_main(int argc, char* argv[])
@@ -236,11 +243,17 @@ int SDL_main(int argc, char* argv[])
 #ifndef NO_THREADING
     if(numThreads == 0)
       numThreads = numCPUCores();  // * (PLATFORM_MOBILE ? 1 : 2)
+#ifdef EXTERNAL_THREADPOOL
+    // app's own scheduler (threadpool.cpp) instead of renderer's built-in pool
     if(numThreads > 1) {
       int xthreads = dispBounds.h > dispBounds.w ? 2 : numThreads/2;  // prefer square-like tiles
       poolInit(numThreads);
       nvgswSetThreading(vg, xthreads, numThreads/xthreads, poolSubmit, poolWait);
     }
+#else
+    if(numThreads > 1)
+      nvgswSetThreadCount(vg, numThreads);
+#endif
 #endif
     if(swRender == 1) {
       sdlSurface = SDL_GetWindowSurface(sdlWindow);
@@ -283,7 +296,7 @@ int SDL_main(int argc, char* argv[])
     }
 #endif
   }
-  nvgSetFontStash(vg, createFontstash(nvgFlags, 2*48));
+  nvgSetFontStash(vg, createFontstash(nvgFlags, numThreads));
 
   // Android: copy assets out of APK
 #if 0 //defined __ANDROID__
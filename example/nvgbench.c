@@ -0,0 +1,526 @@
+// nvgbench: headless benchmark for the software renderer - renders the standard scenes from the example app into
+//  an offscreen buffer at several resolutions, thread counts and flag combinations, and writes JSON results;
+//  optionally writes final frame of each run as PNG and compares with golden images
+// usage: see printUsage() below; run from repository root, like the example app (data is loaded from example/)
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, sysconf w/ --std=c99
+#define _DEFAULT_SOURCE  // syscall (for perf_event_open)
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+#define NANOVG_SW_IMPLEMENTATION
+#include "nanovg.h"
+#include "nanovg_sw.h"
+#include "demo.h"
+
+#define FONTSTASH_IMPLEMENTATION
+#include "fontstash.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "stb_image_write.h"  // implementation is in demo.c
+
+#ifndef _WIN32
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+#include "tests.c"
+
+#ifdef _WIN32
+static double benchTime(void)
+{
+  LARGE_INTEGER freq, count;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&count);
+  return (double)count.QuadPart/freq.QuadPart;
+}
+
+static int benchCores(void) { SYSTEM_INFO si; GetSystemInfo(&si); return si.dwNumberOfProcessors; }
+#else
+#include <time.h>
+#include <unistd.h>
+static double benchTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1E-9*ts.tv_nsec;
+}
+
+static int benchCores(void) { return (int)sysconf(_SC_NPROCESSORS_ONLN); }
+#endif
+
+// hardware cache counters (--counters) for the calling thread, which does all rendering w/ --threads 1; only
+//  supported on Linux, and often not in VMs
+#define BENCH_NCOUNTERS 3
+static const char* benchCounterNames[BENCH_NCOUNTERS] = {"cache_refs", "cache_misses", "l1d_read_misses"};
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+static int benchOpenCounter(int idx)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = idx < 2 ? PERF_TYPE_HARDWARE : PERF_TYPE_HW_CACHE;
+  attr.config = idx == 0 ? PERF_COUNT_HW_CACHE_REFERENCES : idx == 1 ? PERF_COUNT_HW_CACHE_MISSES :
+      PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void benchStartCounter(int fd)
+{
+  ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+  ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static long long benchStopCounter(int fd)
+{
+  long long count = 0;
+  ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  return read(fd, &count, sizeof(count)) == sizeof(count) ? count : -1;
+}
+#else
+static int benchOpenCounter(int idx) { return -1; }
+static void benchStartCounter(int fd) {}
+static long long benchStopCounter(int fd) { return -1; }
+#endif
+
+#define BENCH_MAX_LIST 32
+
+typedef struct { const char* name; int flags; } BenchFlag;
+
+static const BenchFlag benchFlags[] = {
+  {"none", 0}, {"xc", NVGSW_PATHS_XC}, {"srgb", NVG_SRGB}, {"sdf", NVG_SDF_TEXT},
+  {"nosimd", NVGSW_NO_SIMD}, {"pm", NVGSW_PREMULTIPLIED}, {"async", NVGSW_ASYNC}
+};
+
+typedef struct {
+  int frames, warmup, tolerance;
+  const char* pngDir;
+  const char* goldenDir;
+  const char* tracePath;
+  int counterFds[BENCH_NCOUNTERS];  // -1 if unavailable or not requested
+  int flattenCompare;  // also run each scene w/ nvgFlattenRecursive
+  FILE* out;
+  int nresults, failures;
+} BenchOptions;
+
+// split comma separated list in place
+static int splitList(char* str, char** items)
+{
+  int n = 0;
+  char* tok = strtok(str, ",");
+  while(tok && n < BENCH_MAX_LIST) {
+    items[n++] = tok;
+    tok = strtok(NULL, ",");
+  }
+  return n;
+}
+
+// flag combination is names from benchFlags joined with '+', e.g. "xc+srgb"
+static int parseFlags(const char* str)
+{
+  int flags = 0;
+  char buf[256];
+  char* tok;
+  strncpy(buf, str, sizeof(buf)-1);
+  buf[sizeof(buf)-1] = '\0';
+  for(tok = strtok(buf, "+"); tok; tok = strtok(NULL, "+")) {
+    int ii, found = 0;
+    for(ii = 0; ii < (int)(sizeof(benchFlags)/sizeof(benchFlags[0])); ++ii) {
+      if(strcmp(tok, benchFlags[ii].name) == 0) {
+        flags |= benchFlags[ii].flags;
+        found = 1;
+      }
+    }
+    if(!found)
+      return -1;
+  }
+  return flags;
+}
+
+static int cmpDouble(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// sorts values
+static double percentile(double* values, int n, double p)
+{
+  int idx = (int)ceil(p*n) - 1;
+  qsort(values, n, sizeof(double), cmpDouble);
+  return values[idx < 0 ? 0 : (idx >= n ? n-1 : idx)];
+}
+
+// name of scene for output, e.g. "svg-tiger" for svg scene with svg/tiger.svg
+static void sceneName(char* name, int size, const char* scene, const char* svgFile)
+{
+  if(strcmp(scene, "svg") == 0) {
+    const char* base = strrchr(svgFile, '/');
+    const char* ext;
+    base = base ? base + 1 : svgFile;
+    ext = strrchr(base, '.');
+    snprintf(name, size, "svg-%.*s", ext ? (int)(ext - base) : (int)strlen(base), base);
+  }
+  else
+    snprintf(name, size, "%s", scene);
+}
+
+static const char* benchScenes[] = {"demo", "bigpaths", "smallpaths", "thinlines", "longline", "text", "textpaths", "svg"};
+
+static void drawScene(NVGcontext* vg, const char* scene, const char* svgFile, int w, int h, DemoData* data)
+{
+  if(strcmp(scene, "demo") == 0)
+    renderDemo(vg, w/2, h/2, w, h, 1.0f, 0, data);  // fixed time and mouse position so output is repeatable
+  else if(strcmp(scene, "bigpaths") == 0)
+    bigPathsTest(vg, 5, 4, w, h);
+  else if(strcmp(scene, "smallpaths") == 0)
+    smallPathsTest(vg, w, h);
+  else if(strcmp(scene, "thinlines") == 0)
+    thinLinesTest(vg, w, h);
+  else if(strcmp(scene, "longline") == 0)
+    longLineTest(vg, 100000, w, h);
+  else if(strcmp(scene, "text") == 0)
+    textPerformance(vg, 0, 24.0f, 0);
+  else if(strcmp(scene, "textpaths") == 0)
+    textPerformance(vg, 1, 24.0f, 0);
+  else if(strcmp(scene, "svg") == 0)
+    svgTest(vg, svgFile, w, h);
+}
+
+// compare RGBA framebuffer with golden PNG; returns number of pixels w/ any channel differing by more than
+//  tolerance, or -1 if golden image is missing or wrong size
+static int compareGolden(const unsigned char* fb, int w, int h, const char* path, int tolerance, int* maxDiff)
+{
+  int gw, gh, gn, ii, jj, bad = 0;
+  unsigned char* golden = stbi_load(path, &gw, &gh, &gn, 4);
+  *maxDiff = 0;
+  if(!golden)
+    return -1;
+  if(gw != w || gh != h) {
+    stbi_image_free(golden);
+    return -1;
+  }
+  for(ii = 0; ii < w*h; ++ii) {
+    int pxdiff = 0;
+    for(jj = 0; jj < 4; ++jj) {
+      int d = abs(fb[4*ii + jj] - golden[4*ii + jj]);
+      pxdiff = d > pxdiff ? d : pxdiff;
+    }
+    *maxDiff = pxdiff > *maxDiff ? pxdiff : *maxDiff;
+    bad += pxdiff > tolerance;
+  }
+  stbi_image_free(golden);
+  return bad;
+}
+
+static void runScene(BenchOptions* opts, NVGcontext* vg, DemoData* data, unsigned char* fb, int w, int h,
+    const char* scene, const char* svgFile, int threads, const char* flagsName, int flags, int recursive)
+{
+  int ii, jj, nframes = opts->frames + opts->warmup;
+  char name[256], path[512];
+  double* total = (double*)malloc(4*opts->frames*sizeof(double));
+  double* build = total + opts->frames;
+  double* render = build + opts->frames;
+  double* flatten = render + opts->frames;
+  double median;
+  long long counts[BENCH_NCOUNTERS];
+
+  sceneName(name, sizeof(name), scene, svgFile);
+  for(ii = 0; ii < nframes; ++ii) {
+    double t0, t1, t2;
+    if(ii == opts->warmup) {
+      for(jj = 0; jj < BENCH_NCOUNTERS; ++jj)
+        if(opts->counterFds[jj] >= 0) benchStartCounter(opts->counterFds[jj]);
+    }
+    // opaque gray background, as in example app
+    unsigned int* px = (unsigned int*)fb;
+    for(jj = 0; jj < w*h; ++jj)
+      px[jj] = 0xFF999999;
+    t0 = benchTime();
+    nvgBeginFrame(vg, w, h, 1.0f);
+    drawScene(vg, scene, svgFile, w, h, data);
+    t1 = benchTime();
+    nvgEndFrame(vg);
+    if(flags & NVGSW_ASYNC)
+      nvgswWaitFrame(vg);
+    t2 = benchTime();
+    if(ii >= opts->warmup) {
+      int k = ii - opts->warmup;
+      total[k] = 1000*(t2 - t0);
+      build[k] = 1000*(t1 - t0);
+      render[k] = 1000*(t2 - t1);
+#ifdef NVG_FRAME_STATS
+      {
+        NVGframeStats st;
+        nvgGetFrameStats(vg, &st);
+        flatten[k] = st.flattenMs;
+      }
+#endif
+    }
+  }
+  for(jj = 0; jj < BENCH_NCOUNTERS; ++jj)
+    counts[jj] = opts->counterFds[jj] >= 0 ? benchStopCounter(opts->counterFds[jj]) : -1;
+
+  median = percentile(total, opts->frames, 0.5);
+  fprintf(opts->out, "%s\n    {\"scene\": \"%s\", \"width\": %d, \"height\": %d, \"threads\": %d, \"flags\": \"%s\", "
+      "\"frames\": %d, \"median_ms\": %.3f, \"p95_ms\": %.3f, \"mpix_per_s\": %.2f, "
+      "\"build_ms\": %.3f, \"render_ms\": %.3f", opts->nresults > 0 ? "," : "", name, w, h, threads, flagsName,
+      opts->frames, median, percentile(total, opts->frames, 0.95), w*h/(1000*median),
+      percentile(build, opts->frames, 0.5), percentile(render, opts->frames, 0.5));
+  if(opts->flattenCompare)
+    fprintf(opts->out, ", \"flatten\": \"%s\"", recursive ? "recursive" : "counts");
+  // counters are per frame, including clearing framebuffer
+  for(jj = 0; jj < BENCH_NCOUNTERS; ++jj) {
+    if(counts[jj] >= 0)
+      fprintf(opts->out, ", \"%s\": %lld", benchCounterNames[jj], counts[jj]/opts->frames);
+  }
+#ifdef NVG_FRAME_STATS
+  {
+    // counters and phase times for last frame, and median flatten time (which varies w/ frame for demo scene)
+    NVGframeStats st;
+    double rasterMax = 0;
+    nvgGetFrameStats(vg, &st);
+    for(ii = 0; ii < st.nthreads; ++ii)
+      rasterMax = st.rasterizeMs[ii] > rasterMax ? st.rasterizeMs[ii] : rasterMax;
+    fprintf(opts->out, ", \"stats\": {\"fill_calls\": %d, \"triangle_calls\": %d, \"paths\": %d, \"points\": %d, "
+        "\"fill_verts\": %d, \"stroke_verts\": %d, \"edges\": %d, \"pixels_covered\": %lld, "
+        "\"pixels_blended\": %lld, \"glyphs\": %d, \"atlas_resets\": %d, \"flatten_ms\": %.3f, "
+        "\"expand_fill_ms\": %.3f, \"expand_stroke_ms\": %.3f, \"sort_ms\": %.3f, \"texture_ms\": %.3f, "
+        "\"rasterize_max_ms\": %.3f, \"flatten_median_ms\": %.3f}", st.fillCalls, st.triangleCalls, st.paths, st.points, st.fillVerts,
+        st.strokeVerts, st.edges, st.pixelsCovered, st.pixelsBlended, st.glyphs, st.atlasResets, st.flattenMs,
+        st.expandFillMs, st.expandStrokeMs, st.sortMs, st.textureMs, rasterMax, percentile(flatten, opts->frames, 0.5));
+  }
+#endif
+  opts->nresults++;
+
+  // PNG and golden image names do not include thread count: output has been checked to be identical for 1, 2,
+  //  and 4 threads and any order of runs for all scenes and flags none, xc, srgb, sdf, nosimd, pm, async, and
+  //  sdf+xc (tile size varies w/ thread count, but XC coverage and gradients don't depend on tile origin, and each
+  //  run gets a new context), so one set of golden images checks all runs; other flag combinations and
+  //  framebuffer formats have not been checked
+  snprintf(name + strlen(name), sizeof(name) - strlen(name), "_%s_%dx%d%s", flagsName, w, h,
+      recursive ? "_recursive" : "");
+  if(opts->pngDir) {
+    snprintf(path, sizeof(path), "%s/%s.png", opts->pngDir, name);
+    if(!stbi_write_png(path, w, h, 4, fb, w*4))
+      fprintf(stderr, "Error writing %s\n", path);
+  }
+  if(opts->goldenDir) {
+    int maxDiff, bad;
+    snprintf(path, sizeof(path), "%s/%s.png", opts->goldenDir, name);
+    bad = compareGolden(fb, w, h, path, opts->tolerance, &maxDiff);
+    if(bad < 0)
+      fprintf(opts->out, ", \"golden\": \"missing\"");
+    else
+      fprintf(opts->out, ", \"golden\": \"%s\", \"golden_max_diff\": %d, \"golden_bad_pixels\": %d",
+          bad > 0 ? "fail" : "pass", maxDiff, bad);
+    if(bad != 0) {
+      fprintf(stderr, "%s: golden image %s\n", name, bad < 0 ? "missing" : "mismatch");
+      opts->failures++;
+    }
+  }
+  fprintf(opts->out, "}");
+  fflush(opts->out);
+  free(total);
+}
+
+// new context and demo data for each run, since output depends on font atlas and image cache state left by
+//  previous runs (e.g., glyph positions in atlas, which change SDF text slightly); returns NULL on error
+static NVGcontext* benchCreate(int flags, int threads, DemoData* data)
+{
+  NVGcontext* vg = nvgswCreate(NVG_AUTOW_DEFAULT | flags);
+  if(!vg)
+    return NULL;
+  if(threads > 1)
+    nvgswSetThreadCount(vg, threads);  // thread count must be set before anything is drawn
+  nvgswSetFramebuffer(vg, NULL, 16, 16, 0, 8, 16, 24);  // so images are converted to framebuffer format
+  if(loadDemoData(vg, data, 0) == -1) {
+    nvgswDelete(vg);
+    return NULL;
+  }
+  nvgAtlasTextThreshold(vg, 48.0f);  // initialize atlas
+  return vg;
+}
+
+static void printUsage(void)
+{
+  printf("nvgbench: headless benchmark for nanovg software renderer; run from repository root\n"
+    "  --scenes <list>   scenes: demo,bigpaths,smallpaths,thinlines,longline,text,textpaths,svg (default: all)\n"
+    "  --svg <list>      SVG files for svg scene (default: example/svg/tiger.svg)\n"
+    "  --sizes <list>    framebuffer sizes (default: 1024x768,1920x1080)\n"
+    "  --threads <list>  thread counts (default: 1,<number of cores>)\n"
+    "  --flags <list>    flag combinations, names joined w/ '+' from: none,xc,srgb,sdf,nosimd,pm,async\n"
+    "                    (default: none,xc,srgb,sdf)\n"
+    "  --frames <n>      timed frames per run (default: 20), after 2 warmup frames\n"
+    "  --out <file>      JSON output file (default: stdout)\n"
+    "  --png <dir>       write final frame of each run to <dir>/<scene>_<flags>_<w>x<h>.png\n"
+    "  --golden <dir>    compare final frame with golden image of same name in <dir>; exit status is 1 if any\n"
+    "                    image is missing or differs\n"
+    "  --tolerance <n>   max channel difference from golden image (default: 2)\n"
+    "  --trace <file>    write Chrome trace JSON of most recent frames to <file> (requires build w/ NVG_TRACE)\n"
+    "  --counters 1      add per frame hardware cache counters of rendering thread (Linux only; use w/\n"
+    "                    --threads 1)\n"
+    "  --flatten 1       repeat each run w/ nanovg's original recursive curve flattening (nvgFlattenRecursive),\n"
+    "                    to compare points and flatten time, e.g. --scenes textpaths,svg (requires build w/\n"
+    "                    NVG_FRAME_STATS); images are named <scene>_<flags>_<w>x<h>_recursive.png\n");
+}
+
+int main(int argc, char* argv[])
+{
+  char defaultThreads[32];
+  char scenesArg[256] = "demo,bigpaths,smallpaths,thinlines,longline,text,textpaths,svg";
+  char svgArg[1024] = "example/svg/tiger.svg";  // DATA_PATH("svg/tiger.svg")
+  char sizesArg[256] = "1024x768,1920x1080";
+  char flagsArg[256] = "none,xc,srgb,sdf";
+  char* scenes[BENCH_MAX_LIST];
+  char* svgs[BENCH_MAX_LIST];
+  char* sizes[BENCH_MAX_LIST];
+  char* threadList[BENCH_MAX_LIST];
+  char* flagList[BENCH_MAX_LIST];
+  char* threadsArg = defaultThreads;
+  int nscenes, nsvgs, nsizes, nthreads, nflags, argi, fi, ti, si, ci, vi, counters = 0, cores = benchCores();
+  BenchOptions opts;
+
+  memset(&opts, 0, sizeof(opts));
+  opts.frames = 20;
+  opts.warmup = 2;
+  opts.tolerance = 2;
+  opts.out = stdout;
+  if(cores > 1)
+    snprintf(defaultThreads, sizeof(defaultThreads), "1,%d", cores);
+  else
+    strcpy(defaultThreads, "1");
+
+  for(argi = 1; argi < argc; ++argi) {
+    const char* arg = argv[argi];
+    const char* val = argi + 1 < argc ? argv[argi+1] : NULL;
+    if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+      printUsage();
+      return 0;
+    }
+    if(!val) {
+      fprintf(stderr, "Missing value for %s\n", arg);
+      return 2;
+    }
+    ++argi;
+    if(strcmp(arg, "--scenes") == 0) snprintf(scenesArg, sizeof(scenesArg), "%s", val);
+    else if(strcmp(arg, "--svg") == 0) snprintf(svgArg, sizeof(svgArg), "%s", val);
+    else if(strcmp(arg, "--sizes") == 0) snprintf(sizesArg, sizeof(sizesArg), "%s", val);
+    else if(strcmp(arg, "--threads") == 0) threadsArg = argv[argi];
+    else if(strcmp(arg, "--flags") == 0) snprintf(flagsArg, sizeof(flagsArg), "%s", val);
+    else if(strcmp(arg, "--frames") == 0) opts.frames = atoi(val) > 0 ? atoi(val) : 1;
+    else if(strcmp(arg, "--png") == 0) opts.pngDir = val;
+    else if(strcmp(arg, "--golden") == 0) opts.goldenDir = val;
+    else if(strcmp(arg, "--tolerance") == 0) opts.tolerance = atoi(val);
+    else if(strcmp(arg, "--trace") == 0) opts.tracePath = val;
+    else if(strcmp(arg, "--counters") == 0) counters = atoi(val);
+    else if(strcmp(arg, "--flatten") == 0) opts.flattenCompare = atoi(val);
+    else if(strcmp(arg, "--out") == 0) {
+      opts.out = fopen(val, "w");
+      if(!opts.out) {
+        fprintf(stderr, "Error opening %s\n", val);
+        return 2;
+      }
+    }
+    else {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      printUsage();
+      return 2;
+    }
+  }
+
+  nscenes = splitList(scenesArg, scenes);
+  nsvgs = splitList(svgArg, svgs);
+  nsizes = splitList(sizesArg, sizes);
+  nthreads = splitList(threadsArg, threadList);
+  nflags = splitList(flagsArg, flagList);
+  for(ci = 0; ci < nscenes; ++ci) {
+    int known = 0;
+    for(vi = 0; vi < (int)(sizeof(benchScenes)/sizeof(benchScenes[0])); ++vi)
+      known = known || strcmp(scenes[ci], benchScenes[vi]) == 0;
+    if(!known) {
+      fprintf(stderr, "Unknown scene %s\n", scenes[ci]);
+      return 2;
+    }
+  }
+  for(fi = 0; fi < nflags; ++fi) {
+    if(parseFlags(flagList[fi]) < 0) {
+      fprintf(stderr, "Unknown flags %s\n", flagList[fi]);
+      return 2;
+    }
+  }
+
+#ifndef NVG_FRAME_STATS
+  if(opts.flattenCompare) {
+    fprintf(stderr, "--flatten requires build w/ NVG_FRAME_STATS (make -f Makefile.bench STATS=1)\n");
+    return 2;
+  }
+#endif
+  for(ci = 0; ci < BENCH_NCOUNTERS; ++ci) {
+    opts.counterFds[ci] = counters ? benchOpenCounter(ci) : -1;
+    if(counters && opts.counterFds[ci] < 0)
+      fprintf(stderr, "Counter %s not available\n", benchCounterNames[ci]);
+  }
+
+  fprintf(opts.out, "{\n  \"cores\": %d,\n  \"warmup_frames\": %d,\n  \"results\": [", cores, opts.warmup);
+  for(fi = 0; fi < nflags; ++fi) {
+    int flags = parseFlags(flagList[fi]);
+    for(ti = 0; ti < nthreads; ++ti) {
+      int threads = atoi(threadList[ti]);
+      for(si = 0; si < nsizes; ++si) {
+        int w = 0, h = 0;
+        unsigned char* fb;
+        if(sscanf(sizes[si], "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+          fprintf(stderr, "Invalid size %s\n", sizes[si]);
+          return 2;
+        }
+        fb = (unsigned char*)malloc(w*h*4);
+        for(ci = 0; ci < nscenes; ++ci) {
+          int isSvg = strcmp(scenes[ci], "svg") == 0;
+          for(vi = 0; vi < (isSvg ? nsvgs : 1); ++vi) {
+            int ri;
+            for(ri = 0; ri < (opts.flattenCompare ? 2 : 1); ++ri) {
+              DemoData data;
+              NVGcontext* vg = benchCreate(flags, threads, &data);
+              if(!vg) {
+                fprintf(stderr, "Error creating context for flags %s, or loading demo data from example/: please "
+                    "run from repository root\n", flagList[fi]);
+                return 2;
+              }
+              nvgswSetFramebuffer(vg, fb, w, h, 0, 8, 16, 24);
+              fprintf(stderr, "%s %dx%d, %d threads, flags %s%s\n", scenes[ci], w, h, threads, flagList[fi],
+                  ri ? ", recursive flattening" : "");
+#ifdef NVG_FRAME_STATS
+              nvgFlattenRecursive(vg, ri);
+#endif
+              runScene(&opts, vg, &data, fb, w, h, scenes[ci], isSvg ? svgs[vi] : NULL, threads, flagList[fi],
+                  flags, ri);
+              freeDemoData(vg, &data);
+              nvgswDelete(vg);
+            }
+          }
+        }
+        free(fb);
+      }
+    }
+  }
+  fprintf(opts.out, "\n  ]\n}\n");
+  if(opts.out != stdout)
+    fclose(opts.out);
+  if(opts.tracePath && !nvgTraceDump(opts.tracePath))
+    fprintf(stderr, "Error writing trace %s (tracing requires NVG_TRACE)\n", opts.tracePath);
+  return opts.failures > 0 ? 1 : 0;
+}
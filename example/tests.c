@@ -417,7 +417,14 @@ static void svgTest(NVGcontext* vg, const char* filename, int fbWidth, int fbHei
   }
 #else
   //static const char* filename = DATA_PATH("Opt_page1.svg");  //argc > 1 ? argv[1] :
+  static char* imageFile = NULL;
+  if(image && strcmp(imageFile, filename) != 0) {
+    nsvgDelete(image);
+    image = NULL;
+  }
   if(!image) {
+    imageFile = realloc(imageFile, strlen(filename) + 1);
+    strcpy(imageFile, filename);
     image = nsvgParseFromFile(filename, "px", 96.0f);
     if(!image) {
       NVG_LOG("Error loading %s\n", filename);
@@ -474,6 +481,38 @@ static void bigPathsTest(NVGcontext* vg, int xpaths, int ypaths, int fbWidth, in
   }
 }
 
+// chart-like polylines w/ many short segments, drawn w/ hairline strokes; round joins, since sharp miter joins
+//  (the default) are expanded instead of drawn by the backend's thin stroke path
+static void thinLinesTest(NVGcontext* vg, int fbWidth, int fbHeight)
+{
+  nvgStrokeWidth(vg, 1.0f);
+  nvgLineJoin(vg, NVG_ROUND);
+  for(int ii = 0; ii < 40; ++ii) {
+    float y0 = fbHeight*(ii + 0.5f)/40;
+    nvgStrokeColor(vg, nvgHSLA(ii/40.0f, 0.7f, 0.4f, 255));
+    nvgBeginPath(vg);
+    nvgMoveTo(vg, 0, y0);
+    for(int x = 2; x < fbWidth; x += 2)
+      nvgLineTo(vg, x, y0 + 0.1f*fbHeight*sinf(x*0.013f*(ii + 1))*cosf(x*0.0021f));
+    nvgStroke(vg);
+  }
+}
+
+// single hairline polyline w/ nsegs segments, all in one draw call
+static void longLineTest(NVGcontext* vg, int nsegs, int fbWidth, int fbHeight)
+{
+  nvgStrokeWidth(vg, 1.0f);
+  nvgLineJoin(vg, NVG_ROUND);
+  nvgStrokeColor(vg, nvgRGBA(0,96,160,255));
+  nvgBeginPath(vg);
+  nvgMoveTo(vg, 0, 0.5f*fbHeight);
+  for(int ii = 1; ii <= nsegs; ++ii) {
+    float t = (float)ii/nsegs;
+    nvgLineTo(vg, fbWidth*t, fbHeight*(0.5f + 0.45f*sinf(t*6.2832f*40)*sinf(t*3.1416f*3 + ii%7)));
+  }
+  nvgStroke(vg);
+}
+
 static int freadall(const char* filename, char** bufferout)
 {
   FILE* f = fopen(filename, "rb");
@@ -58,6 +58,9 @@ struct FONSparams {
   void* userPtr;
   void (*userSDFRender)(void* uptr, void* fontimpl, unsigned char* output,
       int outWidth, int outHeight, int outStride, float scale, int padding, int glyph);
+  // if set, userSDFRender may defer rendering (e.g., to generate a batch of glyphs in parallel) until
+  //  userSDFFlush, which is called before texture data is validated, moved, or freed
+  void (*userSDFFlush)(void* uptr);
   void (*userDelete)(void* uptr);
 };
 typedef struct FONSparams FONSparams;
@@ -115,6 +118,8 @@ FONSparams* fonsInternalParams(FONScontext* ctx);
 void fonsSetErrorCallback(FONScontext* s, void (*callback)(void* uptr, int error, int val), void* uptr);
 // Returns current atlas size.
 void fonsGetAtlasSize(FONScontext* s, int* width, int* height, int* atlasFontPx);
+// Returns total number of glyphs rasterized into atlas since stash was created.
+int fonsGetGlyphsRendered(FONScontext* s);
 // Expands the atlas size.
 int fonsExpandAtlas(FONScontext* s, int width, int height);
 // Resets the whole stash.
@@ -507,6 +512,7 @@ struct FONScontext
   int nfallbacks;
   void (*handleError)(void* uptr, int error, int val);
   void* errorUptr;
+  int glyphsRendered;
 };
 
 #ifdef STB_TRUETYPE_IMPLEMENTATION
@@ -1021,6 +1027,7 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, int fontid, unsigned int co
         FONStexelU8* dst = (FONStexelU8*)stash->texData + (gx+pad + (gy+pad)*stash->atlas->width);
         fons__tt_renderGlyphBitmap(&font->font, dst, cellw - pad, cellh - pad, stash->atlas->width, scale, g);
       }
+      ++stash->glyphsRendered;
     }
 
     stash->dirtyRect[0] = fons__mini(stash->dirtyRect[0], gx);
@@ -1259,9 +1266,16 @@ const void* fonsGetTextureData(FONScontext* stash, int* width, int* height)
   return data;
 }
 
+static void fons__flushSDF(FONScontext* stash)
+{
+  if (stash->params.userSDFFlush)
+    stash->params.userSDFFlush(stash->params.userPtr);
+}
+
 int fonsValidateTexture(FONScontext* stash, int* dirty)
 {
   if (stash == NULL) return 0;
+  fons__flushSDF(stash);
   if (stash->dirtyRect[0] < stash->dirtyRect[2] && stash->dirtyRect[1] < stash->dirtyRect[3]) {
     dirty[0] = stash->dirtyRect[0];
     dirty[1] = stash->dirtyRect[1];
@@ -1282,6 +1296,7 @@ void fonsDeleteInternal(FONScontext* stash)
   int i;
   if (stash == NULL) return;
 
+  fons__flushSDF(stash);
   if (stash->params.userDelete)
     stash->params.userDelete(stash->params.userPtr);
 
@@ -1311,6 +1326,11 @@ void fonsGetAtlasSize(FONScontext* stash, int* width, int* height, int* atlasFon
   if (atlasFontPx) *atlasFontPx = stash->atlasFontPx;
 }
 
+int fonsGetGlyphsRendered(FONScontext* stash)
+{
+  return stash ? stash->glyphsRendered : 0;
+}
+
 int fonsExpandAtlas(FONScontext* stash, int width, int height)
 {
   unsigned char* data = NULL;
@@ -1327,6 +1347,7 @@ int fonsExpandAtlas(FONScontext* stash, int width, int height)
     return 0;
 
   // Copy old texture data over.
+  fons__flushSDF(stash);
   texelBytes = stash->params.flags & FONS_SUMMED ? sizeof(FONStexelF) : sizeof(FONStexelU8);
   data = (unsigned char*)realloc(stash->texData, width * height * texelBytes);
   if (data == NULL)
@@ -1356,6 +1377,7 @@ int fonsResetAtlas(FONScontext* stash, int width, int height, int atlasFontPx)
   if (stash == NULL) return 0;
 
   // Reset atlas
+  fons__flushSDF(stash);
   fons__atlasReset(stash->atlas, width, height);  //, cellw, cellh);
 
   // Clear texture data.
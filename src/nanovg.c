@@ -3,6 +3,9 @@
 //   based on nanovg:
 // Copyright (c) 2013 Mikko Mononen memon@inside.org
 //
+#if (defined(NVG_FRAME_STATS) || defined(NVG_TRACE)) && !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L  // for clock_gettime
+#endif
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -15,6 +18,15 @@
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#if defined(NVG_FRAME_STATS) || defined(NVG_TRACE)
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
 #ifdef _MSC_VER
 #pragma warning(disable: 4100)  // unreferenced formal parameter
 #pragma warning(disable: 4127)  // conditional expression is constant
@@ -34,6 +46,21 @@
 
 #define NVG_KAPPA90 0.5522847493f	// Length proportional to radius of a cubic bezier handle for 90deg arcs.
 
+// display list paths are flattened again if drawn scaled up by more than this factor
+#define NVG_DL_RETESS_SCALE 1.5f
+// number of scales for which flattened points are kept by a path object
+#define NVG_PATHOBJ_LEVELS 4
+// max segments for a single curve
+#define NVG_MAX_CURVE_SEGS 512
+// max quadratics used to approximate a cubic when counting segments (see nvg__flattenCubic)
+#define NVG_MAX_CURVE_QUADS 16
+// min uniform segments for a curve to be considered for flattening by parabola integrals, which cost more than
+//  forward differencing for curves w/ few segments
+#define NVG_MIN_PARABOLA_SEGS 16
+// max distance (pixels) between outer corner of a miter or bevel join and round join for a thin stroke to be drawn
+//  w/ renderLines, which only draws round joins
+#define NVG_THIN_JOIN_TOL 0.125f
+
 #define NVG_COUNTOF(arr) (sizeof(arr) / sizeof(0[arr]))
 
 
@@ -41,9 +68,10 @@ enum NVGcommands {
   NVG_MOVETO = 0,
   NVG_LINETO = 1,
   NVG_BEZIERTO = 2,
-  NVG_CLOSE = 3,  // commands >= NVG_CLOSE do not affect position
-  NVG_WINDING = 4,
-  NVG_RESTART = 5,
+  NVG_QUADTO = 3,
+  NVG_CLOSE = 4,  // commands >= NVG_CLOSE do not affect position
+  NVG_WINDING = 5,
+  NVG_RESTART = 6,
 };
 
 struct NVGstate {
@@ -90,6 +118,85 @@ struct NVGpathCache {
 };
 typedef struct NVGpathCache NVGpathCache;
 
+enum NVGdlCallType {
+  NVG_DL_FILL = 0,
+  NVG_DL_TRIANGLES = 1,
+  NVG_DL_TEXT = 2,
+};
+
+// recorded renderFill or renderTriangles call, or text drawn from atlas
+struct NVGdlCall {
+  int type;
+  int flags;
+  NVGpaint paint;
+  NVGcompositeOperationState compositeOperation;
+  NVGscissor scissor;
+  int pathOffset;  // fill: paths, w/ NVGpath::first = offset of fill vertices
+  int npaths;
+  int vertOffset;  // triangles: vertices
+  int nverts;
+  int cmdOffset;  // fill: path commands (in device space), so that paths can be flattened again
+  int ncmds;
+  float strokeWidth;  // strokes only: stroke params for stroking again
+  int lineCap;
+  int lineJoin;
+  float miterLimit;
+  int textIdx;  // text only
+};
+typedef struct NVGdlCall NVGdlCall;
+
+// text drawn from atlas is drawn again w/ nvgText if atlas has changed since recording
+struct NVGdlText {
+  NVGstate state;
+  float x, y;
+  int strOffset;
+  int nstr;
+  int ncalls;  // number of following calls generated by this text
+  int atlasGeneration;
+};
+typedef struct NVGdlText NVGdlText;
+
+struct NVGdisplayList {
+  NVGdlCall* calls;
+  int ncalls;
+  int ccalls;
+  NVGpath* paths;
+  int npaths;
+  int cpaths;
+  NVGvertex* verts;
+  int nverts;
+  int cverts;
+  float* commands;
+  int ncommands;
+  int ccommands;
+  NVGdlText* texts;
+  int ntexts;
+  int ctexts;
+  char* strings;
+  int nstrings;
+  int cstrings;
+};
+
+// flattened path object in local coords for one quantized scale
+struct NVGpathLevel {
+  int level;  // quantized scale = 2^(level/2)
+  float tessTol;  // ctx->tessTol when flattened (changes w/ device pixel ratio)
+  unsigned int lastUsed;
+  NVGpoint* points;
+  int npoints;
+  NVGpath* paths;
+  int npaths;
+};
+typedef struct NVGpathLevel NVGpathLevel;
+
+struct NVGpathObject {
+  float* commands;  // in local coords
+  int ncommands;
+  NVGpathLevel levels[NVG_PATHOBJ_LEVELS];
+  int nlevels;
+  unsigned int counter;
+};
+
 struct NVGcontext {
   NVGparams params;
   float* commands;
@@ -107,6 +214,17 @@ struct NVGcontext {
   FONScontext* fs;
   int fontImages[NVG_MAX_FONTIMAGES];
   int fontImageIdx;
+  int atlasGeneration;  // incremented whenever atlas is reset (so glyph positions are invalid)
+  NVGdisplayList* recording;
+  // current path is a single axis-aligned (rounded) rect if ncommands == rectCommands: device space x0, y0,
+  //  x1, y1 and corner radius
+  float rectShape[5];
+  int rectCommands;
+#ifdef NVG_FRAME_STATS
+  NVGframeStats stats;
+  int statsGlyphs0;  // fonsGetGlyphsRendered() at start of frame
+  int flattenRecursive;  // see nvgFlattenRecursive
+#endif
 };
 
 static float nvg__sqrtf(float a) { return sqrtf(a); }
@@ -239,6 +357,142 @@ static NVGstate* nvg__getState(NVGcontext* ctx)
   return &ctx->states[ctx->nstates-1];
 }
 
+#if defined(NVG_FRAME_STATS) || defined(NVG_TRACE)
+double nvgStatsTime(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER t, f;
+  QueryPerformanceCounter(&t);
+  QueryPerformanceFrequency(&f);
+  return 1000.0*(double)t.QuadPart/(double)f.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return 1000.0*ts.tv_sec + 1E-6*ts.tv_nsec;
+#endif
+}
+#endif
+
+#ifdef NVG_TRACE
+// events kept per thread; must be power of 2
+#ifndef NVG_TRACE_EVENTS
+#define NVG_TRACE_EVENTS 16384
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define NVG_THREAD_LOCAL __declspec(thread)
+#define nvg__atomicLoadPtr(p) (_ReadWriteBarrier(), *(void* volatile*)(p))
+#define nvg__atomicCASPtr(p, expect, v) (InterlockedCompareExchangePointer((PVOID volatile*)(p), (v), (expect)) == (expect))
+#define nvg__atomicLoadU(p) (_ReadWriteBarrier(), *(volatile unsigned int*)(p))
+#define nvg__atomicStoreU(p, v) do { _ReadWriteBarrier(); *(volatile unsigned int*)(p) = (v); } while(0)
+#else
+#define NVG_THREAD_LOCAL __thread
+#define nvg__atomicLoadPtr(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define nvg__atomicCASPtr(p, expect, v) __extension__ ({ void* e_ = (expect); \
+    __atomic_compare_exchange_n((void**)(p), &e_, (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); })
+#define nvg__atomicLoadU(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define nvg__atomicStoreU(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+typedef struct NVGtraceEvent {
+  const char* name;
+  double ts;  // ms
+  double dur;  // complete ('X') events only
+  int arg;
+  char phase;  // 'B', 'E', or 'X'
+} NVGtraceEvent;
+
+// each ring is only written by its thread, so recording needs no locks; rings are never freed, so events from
+//  threads which have exited can still be dumped
+typedef struct NVGtraceRing {
+  NVGtraceEvent events[NVG_TRACE_EVENTS];
+  unsigned int count;  // total events recorded
+  int tid;
+  const char* name;
+  struct NVGtraceRing* next;
+} NVGtraceRing;
+
+static NVGtraceRing* nvg__traceRings = NULL;
+static NVG_THREAD_LOCAL NVGtraceRing* nvg__traceRing = NULL;
+
+static NVGtraceRing* nvg__traceThreadRing(void)
+{
+  NVGtraceRing* ring = nvg__traceRing;
+  if (ring) return ring;
+  ring = (NVGtraceRing*)calloc(1, sizeof(NVGtraceRing));
+  if (ring == NULL) return NULL;
+  do {
+    ring->next = (NVGtraceRing*)nvg__atomicLoadPtr(&nvg__traceRings);
+    ring->tid = ring->next ? ring->next->tid + 1 : 1;
+  } while (!nvg__atomicCASPtr(&nvg__traceRings, ring->next, ring));
+  nvg__traceRing = ring;
+  return ring;
+}
+
+void nvgTraceEvent(const char* name, char phase, double ts, double dur, int arg)
+{
+  NVGtraceRing* ring = nvg__traceThreadRing();
+  NVGtraceEvent* ev;
+  if (ring == NULL) return;
+  ev = &ring->events[ring->count & (NVG_TRACE_EVENTS-1)];
+  ev->name = name;
+  ev->ts = ts;
+  ev->dur = dur;
+  ev->arg = arg;
+  ev->phase = phase;
+  nvg__atomicStoreU(&ring->count, ring->count + 1);
+}
+
+void nvgTraceThreadName(const char* name)
+{
+  NVGtraceRing* ring = nvg__traceThreadRing();
+  if (ring) ring->name = name;
+}
+
+int nvgTraceDump(const char* path)
+{
+  NVGtraceRing* ring;
+  double t0 = 1E300;
+  int nout = 0;
+  FILE* f = fopen(path, "w");
+  if (f == NULL) return 0;
+  // timestamps are written relative to oldest recorded event
+  for (ring = (NVGtraceRing*)nvg__atomicLoadPtr(&nvg__traceRings); ring; ring = ring->next) {
+    unsigned int n = nvg__atomicLoadU(&ring->count);
+    unsigned int first = n > NVG_TRACE_EVENTS ? n - NVG_TRACE_EVENTS : 0;
+    if (n > 0 && ring->events[first & (NVG_TRACE_EVENTS-1)].ts < t0)
+      t0 = ring->events[first & (NVG_TRACE_EVENTS-1)].ts;
+  }
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  for (ring = (NVGtraceRing*)nvg__atomicLoadPtr(&nvg__traceRings); ring; ring = ring->next) {
+    unsigned int i, n = nvg__atomicLoadU(&ring->count);
+    unsigned int first = n > NVG_TRACE_EVENTS ? n - NVG_TRACE_EVENTS : 0;
+    int depth = 0;
+    fprintf(f, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+        "\"args\": {\"name\": \"%s %d\"}}", nout++ ? "," : "", ring->tid, ring->name ? ring->name : "thread", ring->tid);
+    for (i = first; i < n; ++i) {
+      NVGtraceEvent* ev = &ring->events[i & (NVG_TRACE_EVENTS-1)];
+      // skip end events whose begin event has been overwritten
+      if (ev->phase == 'B') ++depth;
+      else if (ev->phase == 'E' && --depth < 0) { depth = 0; continue; }
+      fprintf(f, ",\n{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %d",
+          ev->name, ev->phase, 1000*(ev->ts - t0), ring->tid);
+      if (ev->phase == 'X') fprintf(f, ", \"dur\": %.3f", 1000*ev->dur);
+      if (ev->arg >= 0) fprintf(f, ", \"args\": {\"arg\": %d}", ev->arg);
+      fputc('}', f);
+    }
+  }
+  fprintf(f, "\n]}\n");
+  return fclose(f) == 0;
+}
+#else
+int nvgTraceDump(const char* path)
+{
+  NVG_NOTUSED(path);
+  return 0;
+}
+#endif
+
 NVGcontext* nvgCreateInternal(NVGparams* params)
 {
   FONSparams fontParams;
@@ -319,6 +573,8 @@ void nvgDeleteInternal(NVGcontext* ctx)
   if (ctx->params.renderDelete != NULL)
     ctx->params.renderDelete(ctx->params.userPtr);
 
+  nvgDeleteDisplayList(ctx->recording);
+
   free(ctx);
 }
 
@@ -349,11 +605,13 @@ static void nvg__freeFontImages(NVGcontext* ctx)
     ctx->fontImages[j] = ctx->fontImages[0];
     ctx->fontImages[0] = fontImage;
     ctx->fontImageIdx = 0;
+    ctx->atlasGeneration++;
   }
 }
 
 void nvgBeginFrame(NVGcontext* ctx, float windowWidth, float windowHeight, float devicePixelRatio)
 {
+  NVG_TRACE_BEGIN("buildFrame", -1);
   // moved from end of nvgEndFrame()
   nvg__freeFontImages(ctx);
   ctx->nstates = 0;
@@ -363,19 +621,43 @@ void nvgBeginFrame(NVGcontext* ctx, float windowWidth, float windowHeight, float
   nvg__setDevicePixelRatio(ctx, devicePixelRatio);
 
   ctx->params.renderViewport(ctx->params.userPtr, windowWidth, windowHeight, devicePixelRatio);
+  NVG_STAT(memset(&ctx->stats, 0, sizeof(NVGframeStats)));
+  NVG_STAT(ctx->statsGlyphs0 = fonsGetGlyphsRendered(ctx->fs));
 }
 
 void nvgCancelFrame(NVGcontext* ctx)
 {
   ctx->params.renderCancel(ctx->params.userPtr);
+  NVG_TRACE_END("buildFrame");
 }
 
 void nvgEndFrame(NVGcontext* ctx)
 {
+  NVG_TRACE_END("buildFrame");
+  NVG_TRACE_BEGIN("endFrame", -1);
   ctx->params.renderFlush(ctx->params.userPtr);
   //nvg__freeFontImages(ctx);
+  NVG_TRACE_END("endFrame");
 }
 
+void nvgGetFrameStats(NVGcontext* ctx, NVGframeStats* stats)
+{
+  memset(stats, 0, sizeof(NVGframeStats));
+#ifdef NVG_FRAME_STATS
+  *stats = ctx->stats;
+  stats->glyphs = fonsGetGlyphsRendered(ctx->fs) - ctx->statsGlyphs0;
+#endif
+  if (ctx->params.renderGetStats)
+    ctx->params.renderGetStats(ctx->params.userPtr, stats);
+}
+
+#ifdef NVG_FRAME_STATS
+void nvgFlattenRecursive(NVGcontext* ctx, int enable)
+{
+  ctx->flattenRecursive = enable;
+}
+#endif
+
 // Color
 NVGcolor nvgRGB(unsigned char r, unsigned char g, unsigned char b) { return nvgRGBA(r,g,b,255); }
 NVGcolor nvgRGBf(float r, float g, float b) { return nvgRGBAf(r,g,b,1.0f); }
@@ -808,14 +1090,23 @@ int nvgCreateImageMem(NVGcontext* ctx, int imageFlags, unsigned char* data, int
 
 int nvgCreateImageRGBA(NVGcontext* ctx, int w, int h, int imageFlags, const unsigned char* data)
 {
-  return ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_RGBA, w, h, imageFlags, data);
+  NVG_STAT(double t0 = nvgStatsTime());
+  NVG_TRACE_BEGIN("createImage", -1);
+  int image = ctx->params.renderCreateTexture(ctx->params.userPtr, NVG_TEXTURE_RGBA, w, h, imageFlags, data);
+  NVG_TRACE_END("createImage");
+  NVG_STAT(ctx->stats.textureMs += nvgStatsTime() - t0);
+  return image;
 }
 
 void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data)
 {
   int w, h;
+  NVG_STAT(double t0 = nvgStatsTime());
+  NVG_TRACE_BEGIN("updateImage", image);
   ctx->params.renderGetTextureSize(ctx->params.userPtr, image, &w, &h);
   ctx->params.renderUpdateTexture(ctx->params.userPtr, image, 0,0, w,h, data);
+  NVG_TRACE_END("updateImage");
+  NVG_STAT(ctx->stats.textureMs += nvgStatsTime() - t0);
 }
 
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h)
@@ -940,13 +1231,25 @@ int nvgMultiGradient(NVGcontext* ctx, int imageFlags, float* stops, NVGcolor* co
 }
 
 // Scissoring
+// path bounds will be clipped to AABB of scissor
+static void nvg__calcScissorBounds(NVGstate* state)
+{
+  float* sxform = state->scissor.xform;
+  float ex = state->scissor.extent[0], ey = state->scissor.extent[1];
+  float tex = ex*nvg__absf(sxform[0]) + ey*nvg__absf(sxform[2]);
+  float tey = ex*nvg__absf(sxform[1]) + ey*nvg__absf(sxform[3]);
+  state->scissorBounds[0] = sxform[4]-tex;
+  state->scissorBounds[1] = sxform[5]-tey;
+  state->scissorBounds[2] = sxform[4]+tex;
+  state->scissorBounds[3] = sxform[5]+tey;
+}
+
 void nvgScissor(NVGcontext* ctx, float x, float y, float w, float h)
 {
   NVGstate* state = nvg__getState(ctx);
   float* sxform = state->scissor.xform;
   float ex = nvg__maxf(0.0f, w)*0.5f;
   float ey = nvg__maxf(0.0f, h)*0.5f;
-  float tex, tey;
 
   nvgTransformIdentity(sxform);
   sxform[4] = x+ex;  //w*0.5f;
@@ -955,14 +1258,7 @@ void nvgScissor(NVGcontext* ctx, float x, float y, float w, float h)
 
   state->scissor.extent[0] = ex;  //w*0.5f;
   state->scissor.extent[1] = ey;  //h*0.5f;
-
-  // path bounds will be clipped to AABB of scissor
-  tex = ex*nvg__absf(sxform[0]) + ey*nvg__absf(sxform[2]);
-  tey = ex*nvg__absf(sxform[1]) + ey*nvg__absf(sxform[3]);
-  state->scissorBounds[0] = sxform[4]-tex;
-  state->scissorBounds[1] = sxform[5]-tey;
-  state->scissorBounds[2] = sxform[4]+tex;
-  state->scissorBounds[3] = sxform[5]+tey;
+  nvg__calcScissorBounds(state);
 }
 
 static void nvg__isectRects(float* dst,
@@ -1064,44 +1360,44 @@ static float nvg__distPtSeg(float x, float y, float px, float py, float qx, floa
   return dx*dx + dy*dy;
 }
 
-static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
+static int nvg__reserveCommands(NVGcontext* ctx, int nvals)
 {
-  NVGstate* state = nvg__getState(ctx);
-  int i;
-
   if (ctx->ncommands+nvals > ctx->ccommands) {
     float* commands;
     int ccommands = ctx->ncommands+nvals + ctx->ccommands/2;
     commands = (float*)realloc(ctx->commands, sizeof(float)*ccommands);
-    if (commands == NULL) return;
+    if (commands == NULL) return 0;
     ctx->commands = commands;
     ctx->ccommands = ccommands;
   }
+  return 1;
+}
 
-  if ((int)vals[0] < NVG_CLOSE) {
-    ctx->commandx = vals[nvals-2];
-    ctx->commandy = vals[nvals-1];
-  }
-
-  // transform commands
-  i = 0;
+static void nvg__transformCommands(float* vals, int nvals, const float* xform)
+{
+  int i = 0;
   while (i < nvals) {
     int cmd = (int)vals[i];
     switch (cmd) {
     case NVG_MOVETO:
-      nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
+      nvgTransformPoint(&vals[i+1],&vals[i+2], xform, vals[i+1],vals[i+2]);
       i += 3;
       break;
     case NVG_LINETO:
-      nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
+      nvgTransformPoint(&vals[i+1],&vals[i+2], xform, vals[i+1],vals[i+2]);
       i += 3;
       break;
     case NVG_BEZIERTO:
-      nvgTransformPoint(&vals[i+1],&vals[i+2], state->xform, vals[i+1],vals[i+2]);
-      nvgTransformPoint(&vals[i+3],&vals[i+4], state->xform, vals[i+3],vals[i+4]);
-      nvgTransformPoint(&vals[i+5],&vals[i+6], state->xform, vals[i+5],vals[i+6]);
+      nvgTransformPoint(&vals[i+1],&vals[i+2], xform, vals[i+1],vals[i+2]);
+      nvgTransformPoint(&vals[i+3],&vals[i+4], xform, vals[i+3],vals[i+4]);
+      nvgTransformPoint(&vals[i+5],&vals[i+6], xform, vals[i+5],vals[i+6]);
       i += 7;
       break;
+    case NVG_QUADTO:
+      nvgTransformPoint(&vals[i+1],&vals[i+2], xform, vals[i+1],vals[i+2]);
+      nvgTransformPoint(&vals[i+3],&vals[i+4], xform, vals[i+3],vals[i+4]);
+      i += 5;
+      break;
     case NVG_CLOSE:
       i++;
       break;
@@ -1112,9 +1408,20 @@ static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
       i++;
     }
   }
+}
 
-  memcpy(&ctx->commands[ctx->ncommands], vals, nvals*sizeof(float));
+static void nvg__appendCommands(NVGcontext* ctx, float* vals, int nvals)
+{
+  NVGstate* state = nvg__getState(ctx);
+  if (!nvg__reserveCommands(ctx, nvals)) return;
+
+  if ((int)vals[0] < NVG_CLOSE) {
+    ctx->commandx = vals[nvals-2];
+    ctx->commandy = vals[nvals-1];
+  }
 
+  nvg__transformCommands(vals, nvals, state->xform);
+  memcpy(&ctx->commands[ctx->ncommands], vals, nvals*sizeof(float));
   ctx->ncommands += nvals;
 }
 
@@ -1268,19 +1575,123 @@ static void nvg__segment(NVGvertex* vtx, float x0, float y0, float x1, float y1)
   nvg__vset2(vtx, x0, y0, x1, y1, 0, 0);
 }
 
-static void nvg__tesselateBezier(NVGcontext* ctx,
-                 float x1, float y1, float x2, float y2,
-                 float x3, float y3, float x4, float y4,
-                 int level) //, int type)
+// Curves are flattened w/ the fewest segments from either nanovg's original recursive subdivision or a count
+//  computed up front, w/ points from the latter written directly to space reserved in the path cache.
+//  Subdivision is tried first, stopping as soon as it reaches the up front count, which is from Wang's formula
+//  for segments uniform in t w/ points from forward differencing.  Subdivision wins for most SVG cubics, since
+//  it adapts to curvature, while uniform segments are usually fewer for glyph quadratics.  Uniform t also wastes
+//  segments where the parameterization is uneven (e.g. a control point at an endpoint), detected as Wang's error
+//  bound exceeding four times the bound from the distance of control points to the chord.  In that case, if
+//  more than NVG_MIN_PARABOLA_SEGS segments are needed, the curve is mapped to segments of y = x^2 and the count
+//  from an approximation of the integral of sqrt(curvature) is used if at least 25% smaller, w/ points at equal
+//  increments of the integral (R. Levien, "Flattening quadratic Béziers").  tol is max distance from curve to
+//  segment, (4/9)*sqrt(tessTol) being the bound implied by the subdivision's flatness test
+
+typedef struct NVGflatQuad {
+  float x0, y0, x1, y1, x2, y2;
+  float a0, da, u0, uscale, val;  // range of parabola integral, its inverse at start, scale to t, and weight
+} NVGflatQuad;
+
+static float nvg__parabolaIntegral(float x)
+{
+  const float d = 0.67f;
+  return x / (1.0f - d + nvg__sqrtf(nvg__sqrtf(d*d*d*d + 0.25f*x*x)));
+}
+
+static float nvg__parabolaInvIntegral(float x)
+{
+  const float b = 0.39f;
+  return x * (1.0f - b + nvg__sqrtf(b*b + 0.25f*x*x));
+}
+
+// returns 2*sqrtTol * number of segments needed for quad q, or -1 if q can't be handled (straight w/ control
+//  point beyond an end)
+static float nvg__quadParams(NVGflatQuad* q, float sqrtTol)
+{
+  float ddx = 2*q->x1 - q->x0 - q->x2, ddy = 2*q->y1 - q->y0 - q->y2;
+  float cross = (q->x2 - q->x0)*ddy - (q->y2 - q->y0)*ddx;
+  float x0, x2, scale;
+  if (cross == 0) {
+    float dot = (q->x1 - q->x0)*(q->x2 - q->x0) + (q->y1 - q->y0)*(q->y2 - q->y0);
+    float len2 = (q->x2 - q->x0)*(q->x2 - q->x0) + (q->y2 - q->y0)*(q->y2 - q->y0);
+    q->val = 0;
+    return dot >= 0 && dot <= len2 ? 0 : -1;
+  }
+  x0 = ((q->x1 - q->x0)*ddx + (q->y1 - q->y0)*ddy) / cross;
+  x2 = ((q->x2 - q->x1)*ddx + (q->y2 - q->y1)*ddy) / cross;
+  scale = nvg__absf(cross / (nvg__sqrtf(ddx*ddx + ddy*ddy) * (x2 - x0)));
+  q->a0 = nvg__parabolaIntegral(x0);
+  q->da = nvg__parabolaIntegral(x2) - q->a0;
+  if ((x0 < 0) == (x2 < 0))
+    q->val = nvg__absf(q->da) * nvg__sqrtf(scale);
+  else  // includes vertex of parabola
+    q->val = sqrtTol * nvg__absf(q->da) / nvg__parabolaIntegral(sqrtTol / nvg__sqrtf(scale));
+  q->u0 = nvg__parabolaInvIntegral(q->a0);
+  q->uscale = 1.0f / (nvg__parabolaInvIntegral(q->a0 + q->da) - q->u0);
+  return q->val < 1e30f ? q->val : -1;
+}
+
+// ceil(x^(1/4)), w/o sqrt for the common small values
+static int nvg__curveSegs(float x)
+{
+  if (x <= 1) return 1;
+  if (x <= 16) return 2;
+  return (int)nvg__minf(ceilf(nvg__sqrtf(nvg__sqrtf(x))), 1E6f);
+}
+
+static NVGpoint* nvg__reservePoints(NVGcontext* ctx, int n)
+{
+  if (ctx->cache->npoints+n > ctx->cache->cpoints) {
+    NVGpoint* points;
+    int cpoints = ctx->cache->npoints+n + ctx->cache->cpoints/2;
+    points = (NVGpoint*)realloc(ctx->cache->points, sizeof(NVGpoint)*cpoints);
+    if (points == NULL) return NULL;
+    ctx->cache->points = points;
+    ctx->cache->cpoints = cpoints;
+  }
+  return &ctx->cache->points[ctx->cache->npoints];
+}
+
+// add point to reserved space; as w/ nvg__addPoint, point is skipped if equal to previous (w/in distTol)
+static void nvg__curvePoint(NVGcontext* ctx, NVGpath* path, float x, float y)
+{
+  NVGpoint* pt = &ctx->cache->points[ctx->cache->npoints];
+  if (path->count > 0 && nvg__ptEquals(pt[-1].x,pt[-1].y, x,y, ctx->distTol))
+    return;
+  pt->x = x;
+  pt->y = y;
+  ctx->cache->npoints++;
+  path->count++;
+}
+
+// limit for nvg__subdivCubic (passed by pointer so that curve coordinates are the only float args)
+typedef struct NVGsubdivLimit {
+  int first;  // npoints before curve
+  float segs4;
+} NVGsubdivLimit;
+
+// subdivision w/ the flatness test nanovg originally used (w/o limit for nvgFlattenRecursive); returns 0 as soon
+//  as the number of points added since lim->first would reach lim->segs4^(1/4) (points already added are left for
+//  caller to discard)
+static int nvg__subdivCubic(NVGcontext* ctx, float x1, float y1, float x2, float y2,
+                            float x3, float y3, float x4, float y4, int level, const NVGsubdivLimit* lim)
 {
   float dx = x4 - x1;
   float dy = y4 - y1;
   float d2 = nvg__absf(((x2 - x4) * dy - (y2 - y4) * dx));
   float d3 = nvg__absf(((x3 - x4) * dy - (y3 - y4) * dx));
 
-  if ((d2 + d3)*(d2 + d3) < ctx->tessTol * (dx*dx + dy*dy) || level >= 9)
-    nvg__addPoint(ctx, x4, y4); //, type);
-  else {  //if (level < 9)  -- this was the previous logic (so if level reached 10, no point was added!)
+  if ((d2 + d3)*(d2 + d3) < ctx->tessTol * (dx*dx + dy*dy) || level >= 9) {
+    if (lim) {
+      float k = (float)(ctx->cache->npoints - lim->first + 1);
+      if (k*k*k*k >= lim->segs4) return 0;
+    }
+    nvg__addPoint(ctx, x4, y4);
+    return 1;
+  }
+  else if (level == 0 && lim && lim->segs4 <= 16)
+    return 0;  // up front count is 2 (the most common case), so subdivision can't win
+  else {
     float x12 = (x1+x2)*0.5f;
     float y12 = (y1+y2)*0.5f;
     float x23 = (x2+x3)*0.5f;
@@ -1294,12 +1705,150 @@ static void nvg__tesselateBezier(NVGcontext* ctx,
     float x1234 = (x123+x234)*0.5f;
     float y1234 = (y123+y234)*0.5f;
 
-    nvg__tesselateBezier(ctx, x1,y1, x12,y12, x123,y123, x1234,y1234, level+1); //, 0);
-    nvg__tesselateBezier(ctx, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1); //, type);
+    if (!nvg__subdivCubic(ctx, x1,y1, x12,y12, x123,y123, x1234,y1234, level+1, lim)) return 0;
+    return nvg__subdivCubic(ctx, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1, lim);
   }
 }
 
-static void nvg__flattenPaths(NVGcontext* ctx)
+// flatten by subdivision if that needs fewer segments than the up front count n = ceil(segs4^(1/4)) (compared
+//  as k^4 < segs4, to skip the sqrts when subdivision wins), so the result never has more points than nanovg's
+//  original flattening; returns 0, w/ no points added, otherwise
+static int nvg__trySubdiv(NVGcontext* ctx, NVGpath* path, float x1, float y1, float x2, float y2,
+                          float x3, float y3, float x4, float y4, float segs4)
+{
+  int npoints = ctx->cache->npoints, count = path->count;
+  NVGsubdivLimit lim = { npoints, segs4 };
+  if (segs4 <= 1) return 0;
+  if (nvg__subdivCubic(ctx, x1,y1, x2,y2, x3,y3, x4,y4, 0, &lim)) return 1;
+  ctx->cache->npoints = npoints;
+  path->count = count;
+  return 0;
+}
+
+// flatten curve approximated by quads if that needs clearly fewer than nmax segments; returns 0 otherwise
+static int nvg__flattenQuads(NVGcontext* ctx, NVGpath* path, NVGflatQuad* quads, int nquads, float tol, int nmax)
+{
+  // leave some of tolerance for error in integral approximations
+  float sqrtTol = nvg__sqrtf(0.8f*tol), sum = 0, acc = 0, step;
+  int i, k = 0, n;
+  for (i = 0; i < nquads; i++) {
+    float val = nvg__quadParams(&quads[i], sqrtTol);
+    if (val < 0) return 0;
+    sum += val;
+  }
+  n = nvg__maxi((int)ceilf(0.5f*sum/sqrtTol), 1);
+  // evaluating integrals for each point costs more than forward differencing, so require a 25% saving
+  if (4*n > 3*nmax) return 0;
+  if (nvg__reservePoints(ctx, n) == NULL) return 1;
+  step = sum/n;
+  for (i = 1; i < n; i++) {
+    float v = step*i, t, u;
+    NVGflatQuad* q;
+    while (k < nquads-1 && acc + quads[k].val < v)
+      acc += quads[k++].val;
+    q = &quads[k];
+    t = q->val > 0 ? (nvg__parabolaInvIntegral(q->a0 + q->da*(v - acc)/q->val) - q->u0)*q->uscale : 1.0f;
+    u = 1.0f - t;
+    nvg__curvePoint(ctx, path, u*u*q->x0 + 2*u*t*q->x1 + t*t*q->x2, u*u*q->y0 + 2*u*t*q->y1 + t*t*q->y2);
+  }
+  nvg__curvePoint(ctx, path, quads[nquads-1].x2, quads[nquads-1].y2);
+  return 1;
+}
+
+static void nvg__flattenQuad(NVGcontext* ctx, float x0, float y0, float x1, float y1, float x2, float y2, float tol)
+{
+  NVGpath* path = nvg__lastPath(ctx);
+  // distance from chord for n uniform segments is at most |P0 - 2P1 + P2| / (4n^2); for n = 1, distance is
+  //  half that of P1 from chord
+  float ax = x0 - 2*x1 + x2, ay = y0 - 2*y1 + y2, dd = ax*ax + ay*ay, segs4 = dd*0.0625f/(tol*tol);
+  float lx = x2 - x0, ly = y2 - y0, dc = (x1 - x0)*ly - (y1 - y0)*lx;
+  float h, px = x0, py = y0, d1x, d1y, d2x, d2y;
+  int i, n;
+  // as a cubic, control points are 2/3 of the way to P1
+  if (nvg__trySubdiv(ctx, path, x0, y0, x0 + 2.0f/3.0f*(x1 - x0), y0 + 2.0f/3.0f*(y1 - y0),
+                     x2 + 2.0f/3.0f*(x1 - x2), y2 + 2.0f/3.0f*(y1 - y2), x2, y2, segs4))
+    return;
+  n = nvg__curveSegs(segs4);
+  if (n > NVG_MIN_PARABOLA_SEGS && dd*(lx*lx + ly*ly) > 64*dc*dc) {
+    NVGflatQuad q = { x0, y0, x1, y1, x2, y2 };
+    if (nvg__flattenQuads(ctx, path, &q, 1, tol, n)) return;
+  }
+  n = nvg__clampi(n, 1, NVG_MAX_CURVE_SEGS);
+  if (nvg__reservePoints(ctx, n) == NULL) return;
+  h = 1.0f/n;
+  d1x = ax*h*h + 2*(x1 - x0)*h;
+  d1y = ay*h*h + 2*(y1 - y0)*h;
+  d2x = 2*ax*h*h;
+  d2y = 2*ay*h*h;
+  for (i = 1; i < n; i++) {
+    px += d1x;  py += d1y;
+    d1x += d2x;  d1y += d2y;
+    nvg__curvePoint(ctx, path, px, py);
+  }
+  nvg__curvePoint(ctx, path, x2, y2);
+}
+
+static void nvg__flattenCubic(NVGcontext* ctx, float x0, float y0, float x1, float y1,
+                              float x2, float y2, float x3, float y3, float tol)
+{
+  NVGpath* path = nvg__lastPath(ctx);
+  // distance from chord for n uniform segments is at most 3/4 max(|P0 - 2P1 + P2|, |P1 - 2P2 + P3|) / n^2; for
+  //  n = 1, it is at most 3/4 of max distance of P1, P2 from chord
+  float ax = x0 - 2*x1 + x2, ay = y0 - 2*y1 + y2, bx = x1 - 2*x2 + x3, by = y1 - 2*y2 + y3;
+  float dd = nvg__maxf(ax*ax + ay*ay, bx*bx + by*by), segs4 = dd*0.5625f/(tol*tol), lx, ly, dc, cx, cy, ex, ey;
+  float h, px = x0, py = y0, d1x, d1y, d2x, d2y, d3x, d3y;
+  int i, n;
+  if (nvg__trySubdiv(ctx, path, x0, y0, x1, y1, x2, y2, x3, y3, segs4))
+    return;
+  n = nvg__curveSegs(segs4);
+  lx = x3 - x0;  ly = y3 - y0;
+  dc = nvg__maxf(nvg__absf((x1 - x0)*ly - (y1 - y0)*lx), nvg__absf((x2 - x0)*ly - (y2 - y0)*lx));
+  cx = 3*(x1 - x0);  cy = 3*(y1 - y0);
+  ex = x3 - 3*x2 + 3*x1 - x0;  ey = y3 - 3*y2 + 3*y1 - y0;
+  if (n > NVG_MIN_PARABOLA_SEGS && dd*(lx*lx + ly*ly) > 16*dc*dc) {
+    // number of quads approximating cubic w/ error < tol/10: error is |P3 - 3P2 + 3P1 - P0|*sqrt(3)/36/nquads^3
+    NVGflatQuad quads[NVG_MAX_CURVE_QUADS];
+    float r = (ex*ex + ey*ey)/(432*0.01f*tol*tol), tx0 = x0, ty0 = y0, dx0 = cx, dy0 = cy;
+    int nq = 1;
+    while (nq < NVG_MAX_CURVE_QUADS && (float)nq*nq*nq*nq*nq*nq < r)
+      nq++;
+    if ((float)nq*nq*nq*nq*nq*nq >= r && nq < n) {
+      h = 1.0f/nq;
+      for (i = 0; i < nq; i++) {
+        // quad control point from ends and tangents of cubic segment: (3*(C1 + C2) - P0 - P3)/4
+        float t = (i+1)*h, tx1, ty1, dx1, dy1;
+        tx1 = i == nq-1 ? x3 : ((ex*t + 3*ax)*t + cx)*t + x0;
+        ty1 = i == nq-1 ? y3 : ((ey*t + 3*ay)*t + cy)*t + y0;
+        dx1 = (3*ex*t + 6*ax)*t + cx;
+        dy1 = (3*ey*t + 6*ay)*t + cy;
+        quads[i].x0 = tx0;  quads[i].y0 = ty0;
+        quads[i].x1 = 0.5f*(tx0 + tx1) + 0.25f*(dx0 - dx1)*h;
+        quads[i].y1 = 0.5f*(ty0 + ty1) + 0.25f*(dy0 - dy1)*h;
+        quads[i].x2 = tx1;  quads[i].y2 = ty1;
+        tx0 = tx1;  ty0 = ty1;  dx0 = dx1;  dy0 = dy1;
+      }
+      if (nvg__flattenQuads(ctx, path, quads, nq, tol, n)) return;
+    }
+  }
+  n = nvg__clampi(n, 1, NVG_MAX_CURVE_SEGS);
+  if (nvg__reservePoints(ctx, n) == NULL) return;
+  h = 1.0f/n;
+  d1x = (ex*h + 3*ax)*h*h + cx*h;
+  d1y = (ey*h + 3*ay)*h*h + cy*h;
+  d2x = 6*ex*h*h*h + 6*ax*h*h;
+  d2y = 6*ey*h*h*h + 6*ay*h*h;
+  d3x = 6*ex*h*h*h;
+  d3y = 6*ey*h*h*h;
+  for (i = 1; i < n; i++) {
+    px += d1x;  py += d1y;
+    d1x += d2x;  d1y += d2y;
+    d2x += d3x;  d2y += d3y;
+    nvg__curvePoint(ctx, path, px, py);
+  }
+  nvg__curvePoint(ctx, path, x3, y3);
+}
+
+static void nvg__flattenCommands(NVGcontext* ctx, float* commands, int ncommands)
 {
   NVGpathCache* cache = ctx->cache;
   NVGpoint* last;
@@ -1311,39 +1860,59 @@ static void nvg__flattenPaths(NVGcontext* ctx)
   float* cp1;
   float* cp2;
   float* p;
-
-  if (cache->npaths > 0)
-    return;
+  float tol = (4.0f/9.0f)*nvg__sqrtf(ctx->tessTol);
 
   // Flatten
   i = 0;
-  while (i < ctx->ncommands) {
-    int cmd = (int)ctx->commands[i];
+  while (i < ncommands) {
+    int cmd = (int)commands[i];
     switch (cmd) {
     case NVG_MOVETO:
       // skip extraneous MOVETO ... this allows us to avoid removing a Mx,x l0,0 path
-      if (i+3 < ctx->ncommands && (int)ctx->commands[i+3] != NVG_MOVETO) {
+      if (i+3 < ncommands && (int)commands[i+3] != NVG_MOVETO) {
         nvg__addPath(ctx);
-        p = &ctx->commands[i+1];
+        p = &commands[i+1];
         nvg__addPoint(ctx, p[0], p[1]);
       }
       i += 3;
       break;
     case NVG_LINETO:
-      p = &ctx->commands[i+1];
+      p = &commands[i+1];
       nvg__addPoint(ctx, p[0], p[1]);  // note that p is not added if equal to previous point (w/in distTol)
       i += 3;
       break;
     case NVG_BEZIERTO:
       last = nvg__lastPoint(ctx);
       if (last != NULL) {
-        cp1 = &ctx->commands[i+1];
-        cp2 = &ctx->commands[i+3];
-        p = &ctx->commands[i+5];
-        nvg__tesselateBezier(ctx, last->x,last->y, cp1[0],cp1[1], cp2[0],cp2[1], p[0],p[1], 0);
+        cp1 = &commands[i+1];
+        cp2 = &commands[i+3];
+        p = &commands[i+5];
+#ifdef NVG_FRAME_STATS
+        if (ctx->flattenRecursive)
+          nvg__subdivCubic(ctx, last->x,last->y, cp1[0],cp1[1], cp2[0],cp2[1], p[0],p[1], 0, NULL);
+        else
+#endif
+        nvg__flattenCubic(ctx, last->x,last->y, cp1[0],cp1[1], cp2[0],cp2[1], p[0],p[1], tol);
       }
       i += 7;
       break;
+    case NVG_QUADTO:
+      last = nvg__lastPoint(ctx);
+      if (last != NULL) {
+        cp1 = &commands[i+1];
+        p = &commands[i+3];
+#ifdef NVG_FRAME_STATS
+        if (ctx->flattenRecursive) {  // elevated to cubic, as nvgQuadTo did before
+          float x0 = last->x, y0 = last->y;
+          nvg__subdivCubic(ctx, x0,y0, x0 + 2.0f/3.0f*(cp1[0] - x0),y0 + 2.0f/3.0f*(cp1[1] - y0),
+              p[0] + 2.0f/3.0f*(cp1[0] - p[0]),p[1] + 2.0f/3.0f*(cp1[1] - p[1]), p[0],p[1], 0, NULL);
+        }
+        else
+#endif
+        nvg__flattenQuad(ctx, last->x,last->y, cp1[0],cp1[1], p[0],p[1], tol);
+      }
+      i += 5;
+      break;
     case NVG_CLOSE:
       path = nvg__lastPath(ctx);
       if (path)
@@ -1353,7 +1922,7 @@ static void nvg__flattenPaths(NVGcontext* ctx)
     case NVG_WINDING:
       path = nvg__lastPath(ctx);
       if (path)
-        path->winding = (unsigned char)ctx->commands[i+1];
+        path->winding = (unsigned char)commands[i+1];
       i += 2;
       break;
     case NVG_RESTART:
@@ -1394,6 +1963,16 @@ static void nvg__flattenPaths(NVGcontext* ctx)
   // this is where we could store or print area info, i.e. bbox area/sum(polyArea) = overdraw ratio
 }
 
+static void nvg__flattenPaths(NVGcontext* ctx)
+{
+  if (ctx->cache->npaths > 0)
+    return;
+  NVG_STAT(double t0 = nvgStatsTime());
+  nvg__flattenCommands(ctx, ctx->commands, ctx->ncommands);
+  NVG_STAT(ctx->stats.flattenMs += nvgStatsTime() - t0);
+  NVG_STAT(ctx->stats.points += ctx->cache->npoints);
+}
+
 static void nvg__calcBounds(NVGcontext* ctx)
 {
   NVGstate* state = nvg__getState(ctx);
@@ -1465,6 +2044,7 @@ static int nvg__expandStroke(NVGcontext* ctx, float strokeWidth, int lineCap, in
   int i, j, csegs = 0;
   int ncap = nvg__curveDivs(w, NVG_PI, ctx->tessTol);	// Calculate divisions per half circle.
   float mlimsq = w*w*miterLimit*miterLimit;  // (miter_length_limit/2)^2, since w = stroke_width/2
+  NVG_STAT(double t0 = nvgStatsTime());
 
   // Calculate max vertex usage.
   for (i = 0; i < cache->npaths; ++i) {
@@ -1647,6 +2227,7 @@ static int nvg__expandStroke(NVGcontext* ctx, float strokeWidth, int lineCap, in
     verts = dst;
   }
 
+  NVG_STAT(ctx->stats.expandStrokeMs += nvgStatsTime() - t0);
   return 1;
 }
 
@@ -1729,6 +2310,7 @@ static int nvg__expandFill(NVGcontext* ctx)  //, float w, int lineJoin, float mi
   NVGpathCache* cache = ctx->cache;
   NVGvertex* verts;
   int i, j, csegs = 0;
+  NVG_STAT(double t0 = nvgStatsTime());
 
   // Calculate max vertex usage.
   for (i = 0; i < cache->npaths; i++) {
@@ -1767,6 +2349,7 @@ static int nvg__expandFill(NVGcontext* ctx)  //, float w, int lineJoin, float mi
       path->convex = (nvg__triarea2(v0->x0, v0->y0, v->x0, v->y0, v->x1, v->y1) > 0) == sgn;
     }
   }
+  NVG_STAT(ctx->stats.expandFillMs += nvgStatsTime() - t0);
   return 1;
 }
 
@@ -1774,6 +2357,7 @@ static int nvg__expandFill(NVGcontext* ctx)  //, float w, int lineJoin, float mi
 void nvgBeginPath(NVGcontext* ctx)
 {
   ctx->ncommands = 0;
+  ctx->rectCommands = 0;
   nvg__clearPathCache(ctx);
 }
 
@@ -1797,12 +2381,7 @@ void nvgBezierTo(NVGcontext* ctx, float c1x, float c1y, float c2x, float c2y, fl
 
 void nvgQuadTo(NVGcontext* ctx, float cx, float cy, float x, float y)
 {
-  float x0 = ctx->commandx;
-  float y0 = ctx->commandy;
-  float vals[] = { NVG_BEZIERTO,
-      x0 + 2.0f/3.0f*(cx - x0), y0 + 2.0f/3.0f*(cy - y0),
-      x + 2.0f/3.0f*(cx - x), y + 2.0f/3.0f*(cy - y),
-      x, y };
+  float vals[] = { NVG_QUADTO, cx, cy, x, y };
   nvg__appendCommands(ctx, vals, NVG_COUNTOF(vals));
 }
 
@@ -1936,8 +2515,25 @@ void nvgArc(NVGcontext* ctx, float cx, float cy, float r, float a0, float a1, in
   nvg__appendCommands(ctx, vals, nvals);
 }
 
+// path can be filled w/ renderRect if rect is its only shape and transform is axis-aligned, w/ equal x and y
+//  scale if corners are rounded
+static void nvg__setRectShape(NVGcontext* ctx, int ncommands0, float x, float y, float w, float h, float r)
+{
+  float* t = nvg__getState(ctx)->xform;
+  float x0 = t[0]*x + t[4], y0 = t[3]*y + t[5], x1 = t[0]*(x + w) + t[4], y1 = t[3]*(y + h) + t[5];
+  if (ncommands0 != 0 || ctx->ncommands == 0 || t[1] != 0.0f || t[2] != 0.0f) return;
+  if (r > 0 && nvg__absf(t[0]) != nvg__absf(t[3])) return;
+  ctx->rectShape[0] = nvg__minf(x0, x1);
+  ctx->rectShape[1] = nvg__minf(y0, y1);
+  ctx->rectShape[2] = nvg__maxf(x0, x1);
+  ctx->rectShape[3] = nvg__maxf(y0, y1);
+  ctx->rectShape[4] = r*nvg__absf(t[0]);
+  ctx->rectCommands = ctx->ncommands;
+}
+
 void nvgRect(NVGcontext* ctx, float x, float y, float w, float h)
 {
+  int ncommands0 = ctx->ncommands;
   float vals[] = {
     NVG_MOVETO, x,y,
     NVG_LINETO, x,y+h,
@@ -1946,6 +2542,7 @@ void nvgRect(NVGcontext* ctx, float x, float y, float w, float h)
     NVG_CLOSE
   };
   nvg__appendCommands(ctx, vals, NVG_COUNTOF(vals));
+  nvg__setRectShape(ctx, ncommands0, x, y, w, h, 0);
 }
 
 void nvgRoundedRect(NVGcontext* ctx, float x, float y, float w, float h, float r)
@@ -1959,6 +2556,7 @@ void nvgRoundedRectVarying(NVGcontext* ctx, float x, float y, float w, float h,
     nvgRect(ctx, x, y, w, h);
     return;
   } else {
+    int ncommands0 = ctx->ncommands;
     float halfw = nvg__absf(w)*0.5f;
     float halfh = nvg__absf(h)*0.5f;
     float rxBL = nvg__minf(radBottomLeft, halfw) * nvg__signf(w), ryBL = nvg__minf(radBottomLeft, halfh) * nvg__signf(h);
@@ -1978,6 +2576,10 @@ void nvgRoundedRectVarying(NVGcontext* ctx, float x, float y, float w, float h,
       NVG_CLOSE
     };
     nvg__appendCommands(ctx, vals, NVG_COUNTOF(vals));
+    // corners must be circular
+    if (radTopLeft == radTopRight && radTopLeft == radBottomRight && radTopLeft == radBottomLeft
+        && radTopLeft <= nvg__minf(halfw, halfh))
+      nvg__setRectShape(ctx, ncommands0, x, y, w, h, radTopLeft);
   }
 }
 
@@ -2016,6 +2618,549 @@ void nvgDebugDumpPathCache(NVGcontext* ctx)
   }
 }
 
+// Path objects
+
+NVGpathObject* nvgCreatePathObject(NVGcontext* ctx)
+{
+  NVGstate* state = nvg__getState(ctx);
+  NVGpathObject* obj;
+  float inv[6];
+
+  // commands are stored in device space, so undo current transform
+  if (!nvgTransformInverse(inv, state->xform)) return NULL;
+  obj = (NVGpathObject*)malloc(sizeof(NVGpathObject));
+  if (obj == NULL) return NULL;
+  memset(obj, 0, sizeof(NVGpathObject));
+  obj->commands = (float*)malloc(sizeof(float)*nvg__maxi(ctx->ncommands, 1));
+  if (obj->commands == NULL) {
+    free(obj);
+    return NULL;
+  }
+  memcpy(obj->commands, ctx->commands, sizeof(float)*ctx->ncommands);
+  obj->ncommands = ctx->ncommands;
+  nvg__transformCommands(obj->commands, obj->ncommands, inv);
+  return obj;
+}
+
+void nvgDeletePathObject(NVGpathObject* obj)
+{
+  int i;
+  if (obj == NULL) return;
+  for (i = 0; i < obj->nlevels; ++i) {
+    free(obj->levels[i].points);
+    free(obj->levels[i].paths);
+  }
+  free(obj->commands);
+  free(obj);
+}
+
+static int nvg__reservePathCache(NVGcontext* ctx, int npoints, int npaths)
+{
+  NVGpathCache* cache = ctx->cache;
+  if (npoints > cache->cpoints) {
+    NVGpoint* points = (NVGpoint*)realloc(cache->points, sizeof(NVGpoint)*npoints);
+    if (points == NULL) return 0;
+    cache->points = points;
+    cache->cpoints = npoints;
+  }
+  if (npaths > cache->cpaths) {
+    NVGpath* paths = (NVGpath*)realloc(cache->paths, sizeof(NVGpath)*npaths);
+    if (paths == NULL) return 0;
+    cache->paths = paths;
+    cache->cpaths = npaths;
+  }
+  return 1;
+}
+
+// get flattened path for scale, flattening if necessary; path cache is overwritten
+static NVGpathLevel* nvg__pathObjectLevel(NVGcontext* ctx, NVGpathObject* obj, float scale)
+{
+  NVGpathCache* cache = ctx->cache;
+  NVGpathLevel* lvl;
+  float tessTol = ctx->tessTol, distTol = ctx->distTol, qscale;
+  int i, level = (int)ceilf(2*log2f(nvg__maxf(scale, 1e-6f)));
+
+  for (i = 0; i < obj->nlevels; ++i) {
+    lvl = &obj->levels[i];
+    if (lvl->level == level && lvl->tessTol == tessTol) {
+      lvl->lastUsed = ++obj->counter;
+      return lvl;
+    }
+  }
+
+  // replace least recently used level
+  if (obj->nlevels < NVG_PATHOBJ_LEVELS)
+    lvl = &obj->levels[obj->nlevels++];
+  else {
+    lvl = &obj->levels[0];
+    for (i = 1; i < obj->nlevels; ++i) {
+      if (obj->levels[i].lastUsed < lvl->lastUsed)
+        lvl = &obj->levels[i];
+    }
+  }
+
+  // flatten in local coords; quantized scale is rounded up so path is never coarser than nvgFill would make it
+  qscale = powf(2.0f, 0.5f*level);
+  ctx->tessTol = tessTol/(qscale*qscale);
+  ctx->distTol = distTol/qscale;
+  nvg__clearPathCache(ctx);
+  NVG_STAT(double t0 = nvgStatsTime());
+  nvg__flattenCommands(ctx, obj->commands, obj->ncommands);
+  NVG_STAT(ctx->stats.flattenMs += nvgStatsTime() - t0);
+  NVG_STAT(ctx->stats.points += cache->npoints);
+  ctx->tessTol = tessTol;
+  ctx->distTol = distTol;
+
+  lvl->tessTol = -1;  // invalid until copied
+  lvl->npoints = lvl->npaths = 0;
+  if (cache->npoints > 0) {
+    NVGpoint* points = (NVGpoint*)realloc(lvl->points, sizeof(NVGpoint)*cache->npoints);
+    if (points == NULL) return NULL;
+    lvl->points = points;
+    memcpy(lvl->points, cache->points, sizeof(NVGpoint)*cache->npoints);
+  }
+  if (cache->npaths > 0) {
+    NVGpath* paths = (NVGpath*)realloc(lvl->paths, sizeof(NVGpath)*cache->npaths);
+    if (paths == NULL) return NULL;
+    lvl->paths = paths;
+    memcpy(lvl->paths, cache->paths, sizeof(NVGpath)*cache->npaths);
+  }
+  lvl->npoints = cache->npoints;
+  lvl->npaths = cache->npaths;
+  lvl->level = level;
+  lvl->tessTol = tessTol;
+  lvl->lastUsed = ++obj->counter;
+  return lvl;
+}
+
+void nvgFillPathObject(NVGcontext* ctx, NVGpathObject* obj)
+{
+  NVGstate* state = nvg__getState(ctx);
+  NVGpathCache* cache = ctx->cache;
+  float* t = state->xform;
+  NVGpathLevel* lvl;
+  int i;
+
+  nvgBeginPath(ctx);
+  if (obj == NULL) return;
+  lvl = nvg__pathObjectLevel(ctx, obj, nvg__getAverageScale(t));
+  nvg__clearPathCache(ctx);
+  if (lvl == NULL || !nvg__reservePathCache(ctx, lvl->npoints, lvl->npaths)) return;
+  for (i = 0; i < lvl->npoints; ++i)
+    nvgTransformPoint(&cache->points[i].x, &cache->points[i].y, t, lvl->points[i].x, lvl->points[i].y);
+  memcpy(cache->paths, lvl->paths, sizeof(NVGpath)*lvl->npaths);
+  cache->npoints = lvl->npoints;
+  cache->npaths = lvl->npaths;
+  // winding was enforced in local coords; a reflection reverses it
+  if (t[0]*t[3] - t[1]*t[2] < 0) {
+    for (i = 0; i < cache->npaths; ++i) {
+      if (cache->paths[i].winding != NVG_AUTOW)
+        nvg__polyReverse(&cache->points[cache->paths[i].first], cache->paths[i].count);
+    }
+  }
+  nvgFill(ctx);
+}
+
+// Display lists
+
+// grow array *buf by n elements
+static int nvg__dlReserve(void** buf, int* count, int* cap, int n, int size)
+{
+  if (*count + n > *cap) {
+    int c = *count + n + *cap/2;
+    void* p = realloc(*buf, (size_t)c*size);
+    if (p == NULL) return 0;
+    *buf = p;
+    *cap = c;
+  }
+  *count += n;
+  return 1;
+}
+#define NVG_DL_RESERVE(dl, arr, count) nvg__dlReserve((void**)&(dl)->arr, &(dl)->n##arr, &(dl)->c##arr, (count), sizeof(*(dl)->arr))
+
+static NVGdlCall* nvg__dlAddCall(NVGcontext* ctx, int type, NVGpaint* paint, int flags)
+{
+  NVGstate* state = nvg__getState(ctx);
+  NVGdisplayList* dl = ctx->recording;
+  NVGdlCall* call;
+  if (!NVG_DL_RESERVE(dl, calls, 1)) return NULL;
+  call = &dl->calls[dl->ncalls-1];
+  memset(call, 0, sizeof(NVGdlCall));
+  call->type = type;
+  call->flags = flags;
+  if (paint) call->paint = *paint;
+  call->compositeOperation = state->compositeOperation;
+  call->scissor = state->scissor;
+  return call;
+}
+
+static void nvg__recordFill(NVGcontext* ctx, NVGpaint* paint, int flags, float strokeWidth)
+{
+  NVGstate* state = nvg__getState(ctx);
+  NVGpathCache* cache = ctx->cache;
+  NVGdisplayList* dl = ctx->recording;
+  NVGdlCall* call = nvg__dlAddCall(ctx, NVG_DL_FILL, paint, flags);
+  int i;
+  if (call == NULL) return;
+  call->pathOffset = dl->npaths;
+  call->npaths = cache->npaths;
+  if (!NVG_DL_RESERVE(dl, paths, cache->npaths)) goto error;
+  for (i = 0; i < cache->npaths; ++i) {
+    NVGpath* path = &dl->paths[call->pathOffset + i];
+    *path = cache->paths[i];
+    path->first = dl->nverts;
+    path->fill = NULL;
+    if (!NVG_DL_RESERVE(dl, verts, path->nfill)) goto error;
+    memcpy(&dl->verts[path->first], cache->paths[i].fill, path->nfill*sizeof(NVGvertex));
+  }
+  // dashed strokes can't be stroked again since dash array is owned by caller
+  if (strokeWidth <= 0 || !state->dashArray || state->dashArray[0] < 0) {
+    call->cmdOffset = dl->ncommands;
+    call->ncmds = ctx->ncommands;
+    if (!NVG_DL_RESERVE(dl, commands, ctx->ncommands)) goto error;
+    memcpy(&dl->commands[call->cmdOffset], ctx->commands, ctx->ncommands*sizeof(float));
+  }
+  call->strokeWidth = strokeWidth;
+  call->lineCap = state->lineCap;
+  call->lineJoin = state->lineJoin;
+  call->miterLimit = state->miterLimit;
+  return;
+error:
+  dl->ncalls--;
+}
+
+static void nvg__recordTriangles(NVGcontext* ctx, NVGpaint* paint, const NVGvertex* verts, int nverts)
+{
+  NVGdisplayList* dl = ctx->recording;
+  NVGdlCall* call = nvg__dlAddCall(ctx, NVG_DL_TRIANGLES, paint, 0);
+  if (call == NULL) return;
+  call->vertOffset = dl->nverts;
+  call->nverts = nverts;
+  if (!NVG_DL_RESERVE(dl, verts, nverts)) {
+    dl->ncalls--;
+    return;
+  }
+  memcpy(&dl->verts[call->vertOffset], verts, nverts*sizeof(NVGvertex));
+}
+
+// returns index of text call or -1
+static int nvg__beginRecordText(NVGcontext* ctx, float x, float y, const char* string, const char* end)
+{
+  NVGdisplayList* dl = ctx->recording;
+  NVGdlText* text;
+  NVGdlCall* call;
+  int nstr = (int)(end - string);
+  if (!NVG_DL_RESERVE(dl, texts, 1)) return -1;
+  text = &dl->texts[dl->ntexts-1];
+  text->state = *nvg__getState(ctx);
+  text->state.dashArray = NULL;
+  text->x = x;
+  text->y = y;
+  text->strOffset = dl->nstrings;
+  text->nstr = nstr;
+  if (!NVG_DL_RESERVE(dl, strings, nstr) || !(call = nvg__dlAddCall(ctx, NVG_DL_TEXT, NULL, 0))) {
+    dl->ntexts--;
+    return -1;
+  }
+  memcpy(&dl->strings[text->strOffset], string, nstr);
+  call->textIdx = dl->ntexts-1;
+  return dl->ncalls-1;
+}
+
+static void nvg__endRecordText(NVGcontext* ctx, int callIdx)
+{
+  NVGdisplayList* dl = ctx->recording;
+  NVGdlText* text = &dl->texts[dl->calls[callIdx].textIdx];
+  int i, atlas = 0;
+  for (i = callIdx + 1; i < dl->ncalls; ++i)
+    atlas = atlas || dl->calls[i].type == NVG_DL_TRIANGLES;
+  if (atlas) {
+    text->ncalls = dl->ncalls - callIdx - 1;
+    text->atlasGeneration = ctx->atlasGeneration;
+  } else {
+    // text was drawn as paths, so text call isn't needed
+    dl->nstrings -= text->nstr;
+    dl->ntexts--;
+    dl->ncalls--;
+    memmove(&dl->calls[callIdx], &dl->calls[callIdx+1], (dl->ncalls - callIdx)*sizeof(NVGdlCall));
+  }
+}
+
+// all fills and strokes go through these to support recording
+static void nvg__renderFill(NVGcontext* ctx, NVGpaint* paint, int flags, float strokeWidth)
+{
+  NVGstate* state = nvg__getState(ctx);
+  if (ctx->recording)
+    nvg__recordFill(ctx, paint, flags, strokeWidth);
+  else {
+#ifdef NVG_FRAME_STATS
+    int i, nverts = 0;
+    for (i = 0; i < ctx->cache->npaths; ++i)
+      nverts += ctx->cache->paths[i].nfill;
+    ctx->stats.fillCalls++;
+    ctx->stats.paths += ctx->cache->npaths;
+    *(strokeWidth > 0 ? &ctx->stats.strokeVerts : &ctx->stats.fillVerts) += nverts;
+#endif
+    ctx->params.renderFill(ctx->params.userPtr, paint, state->compositeOperation, &state->scissor, flags,
+        ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths);
+  }
+}
+
+// fill current path w/ renderRect if it is a single axis-aligned rect; bounds are clipped to scissor as for
+//  renderFill
+static int nvg__renderRect(NVGcontext* ctx, NVGpaint* paint, int flags)
+{
+  NVGstate* state = nvg__getState(ctx);
+  float bounds[4];
+  if (ctx->recording || !ctx->params.renderRect || ctx->rectCommands == 0 || ctx->ncommands != ctx->rectCommands
+      || (flags & NVG_PATH_NO_AA))
+    return 0;
+  memcpy(bounds, ctx->rectShape, sizeof(bounds));
+  if (state->scissor.extent[0] >= 0) {
+    bounds[0] = nvg__maxf(bounds[0], state->scissorBounds[0]);
+    bounds[1] = nvg__maxf(bounds[1], state->scissorBounds[1]);
+    bounds[2] = nvg__minf(bounds[2], state->scissorBounds[2]);
+    bounds[3] = nvg__minf(bounds[3], state->scissorBounds[3]);
+  }
+  if (!ctx->params.renderRect(ctx->params.userPtr, paint, state->compositeOperation, &state->scissor, flags,
+      bounds, ctx->rectShape, ctx->rectShape[4]))
+    return 0;
+  NVG_STAT(ctx->stats.fillCalls++);
+  NVG_STAT(ctx->stats.paths++);
+  return 1;
+}
+
+// check that all joins of thin stroke are within NVG_THIN_JOIN_TOL of round joins; joins are beveled where
+//  nvg__expandStroke would bevel them, i.e., where miter would exceed miter limit
+static int nvg__thinJoinsRound(NVGcontext* ctx, float strokeWidth)
+{
+  NVGstate* state = nvg__getState(ctx);
+  NVGpathCache* cache = ctx->cache;
+  float w = 0.5f*strokeWidth;
+  // min cos of half the turn angle: miter tip is w/cos from point and bevel is w*cos from it, vs. w for round
+  float cmiter = w/(w + NVG_THIN_JOIN_TOL), cbevel = nvg__maxf(1 - NVG_THIN_JOIN_TOL/w, 0);
+  float mlimsq = state->miterLimit*state->miterLimit;
+  int i, j;
+  if (state->lineJoin == NVG_ROUND)
+    return 1;
+  for (i = 0; i < cache->npaths; ++i) {
+    NVGpath* path = &cache->paths[i];
+    NVGpoint* pts = &cache->points[path->first];
+    int n = path->count, closed = path->closed && n > 2;
+    for (j = closed ? 0 : 1; j < (closed ? n : n - 1); ++j) {
+      NVGpoint* p0 = &pts[j > 0 ? j-1 : n-1];
+      NVGpoint* p2 = &pts[j+1 < n ? j+1 : 0];
+      float d01x = pts[j].x - p0->x, d01y = pts[j].y - p0->y;
+      float d12x = p2->x - pts[j].x, d12y = p2->y - pts[j].y;
+      float lensq = (d01x*d01x + d01y*d01y)*(d12x*d12x + d12y*d12y);
+      // cos^2 of half turn angle = (1 + cos(turn))/2
+      float csq = lensq > 0 ? 0.5f*(1 + (d01x*d12x + d01y*d12y)/sqrtf(lensq)) : 1;
+      int miter = state->lineJoin == NVG_MITER && csq*mlimsq >= 1;
+      if (csq < (miter ? cmiter*cmiter : cbevel*cbevel))
+        return 0;
+    }
+  }
+  return 1;
+}
+
+// draw thin stroke of flattened paths w/ renderLines, w/o stroke expansion
+static int nvg__renderLines(NVGcontext* ctx, NVGpaint* paint, int flags, float strokeWidth)
+{
+  NVGstate* state = nvg__getState(ctx);
+  NVGpathCache* cache = ctx->cache;
+  NVGvertex* verts;
+  float pad = 0.5f*strokeWidth + 1.0f;  // antialiasing reaches less than a pixel beyond stroke
+  int i, j, nverts = 0;
+  if (ctx->recording || !ctx->params.renderLines || strokeWidth > ctx->params.thinStrokeWidth
+      || (flags & NVG_PATH_NO_AA) || !nvg__thinJoinsRound(ctx, strokeWidth))
+    return 0;
+  for (i = 0; i < cache->npaths; ++i)
+    nverts += cache->paths[i].count;
+  verts = nvg__allocTempVerts(ctx, nverts);
+  if (verts == NULL) return 0;
+  cache->bounds[0] = cache->bounds[1] = 1e6f;
+  cache->bounds[2] = cache->bounds[3] = -1e6f;
+  for (i = 0; i < cache->npaths; ++i) {
+    NVGpath* path = &cache->paths[i];
+    NVGpoint* pts = &cache->points[path->first];
+    int n = path->count;
+    // single point is a zero length segment, drawn for round and square caps
+    path->fill = verts;
+    path->nfill = path->closed && n > 2 ? n : (n > 1 ? n - 1 : n);
+    for (j = 0; j < path->nfill; ++j, ++verts) {
+      NVGpoint* p1 = &pts[j+1 < n ? j+1 : 0];
+      verts->x0 = pts[j].x;  verts->y0 = pts[j].y;
+      verts->x1 = p1->x;  verts->y1 = p1->y;
+    }
+    for (j = 0; j < n; ++j) {
+      cache->bounds[0] = nvg__minf(cache->bounds[0], pts[j].x);
+      cache->bounds[1] = nvg__minf(cache->bounds[1], pts[j].y);
+      cache->bounds[2] = nvg__maxf(cache->bounds[2], pts[j].x);
+      cache->bounds[3] = nvg__maxf(cache->bounds[3], pts[j].y);
+    }
+  }
+  cache->bounds[0] -= pad;
+  cache->bounds[1] -= pad;
+  cache->bounds[2] += pad;
+  cache->bounds[3] += pad;
+  if (state->scissor.extent[0] >= 0) {
+    cache->bounds[0] = nvg__maxf(cache->bounds[0], state->scissorBounds[0]);
+    cache->bounds[1] = nvg__maxf(cache->bounds[1], state->scissorBounds[1]);
+    cache->bounds[2] = nvg__minf(cache->bounds[2], state->scissorBounds[2]);
+    cache->bounds[3] = nvg__minf(cache->bounds[3], state->scissorBounds[3]);
+  }
+  if (!ctx->params.renderLines(ctx->params.userPtr, paint, state->compositeOperation, &state->scissor, flags,
+      cache->bounds, strokeWidth, state->lineCap, cache->paths, cache->npaths))
+    return 0;
+  NVG_STAT(ctx->stats.fillCalls++);
+  NVG_STAT(ctx->stats.paths += cache->npaths);
+  NVG_STAT(ctx->stats.strokeVerts += nverts);
+  return 1;
+}
+
+static void nvg__renderTriangles(NVGcontext* ctx, NVGpaint* paint, const NVGvertex* verts, int nverts)
+{
+  NVGstate* state = nvg__getState(ctx);
+  if (ctx->recording)
+    nvg__recordTriangles(ctx, paint, verts, nverts);
+  else {
+    NVG_STAT(ctx->stats.triangleCalls++);
+    ctx->params.renderTriangles(ctx->params.userPtr, paint, state->compositeOperation, &state->scissor, verts, nverts);
+  }
+}
+
+void nvgBeginRecording(NVGcontext* ctx)
+{
+  nvgDeleteDisplayList(ctx->recording);
+  ctx->recording = (NVGdisplayList*)malloc(sizeof(NVGdisplayList));
+  if (ctx->recording != NULL)
+    memset(ctx->recording, 0, sizeof(NVGdisplayList));
+}
+
+NVGdisplayList* nvgEndRecording(NVGcontext* ctx)
+{
+  NVGdisplayList* dl = ctx->recording;
+  ctx->recording = NULL;
+  return dl;
+}
+
+void nvgDeleteDisplayList(NVGdisplayList* dl)
+{
+  if (dl == NULL) return;
+  free(dl->calls);
+  free(dl->paths);
+  free(dl->verts);
+  free(dl->commands);
+  free(dl->texts);
+  free(dl->strings);
+  free(dl);
+}
+
+void nvgDrawDisplayList(NVGcontext* ctx, NVGdisplayList* dl, const float* xform)
+{
+  NVGstate* state;
+  float t[6], sx, sy, scale;
+  int i, j, k, rotated;
+  if (dl == NULL) return;
+  if (xform)
+    memcpy(t, xform, sizeof(float)*6);
+  else
+    nvgTransformIdentity(t);
+  sx = nvg__sqrtf(t[0]*t[0] + t[2]*t[2]);
+  sy = nvg__sqrtf(t[1]*t[1] + t[3]*t[3]);
+  scale = nvg__getAverageScale(t);
+  rotated = t[1] != 0.0f || t[2] != 0.0f;
+
+  nvgSave(ctx);
+  state = nvg__getState(ctx);
+  for (i = 0; i < dl->ncalls; ++i) {
+    NVGdlCall* call = &dl->calls[i];
+    NVGpaint paint = call->paint;
+    if (call->type == NVG_DL_TEXT) {
+      // draw text again if glyphs have moved or if nvgText might not use atlas w/ this transform
+      NVGdlText* text = &dl->texts[call->textIdx];
+      if (text->atlasGeneration != ctx->atlasGeneration || scale > NVG_DL_RETESS_SCALE
+          || scale < 1/NVG_DL_RETESS_SCALE || (rotated && (ctx->params.flags & NVG_ROTATED_TEXT_AS_PATHS))) {
+        const char* str = &dl->strings[text->strOffset];
+        *state = text->state;
+        nvgTransformMultiply(state->xform, t);
+        if (state->scissor.extent[0] > -0.5f) {
+          nvgTransformMultiply(state->scissor.xform, t);
+          nvg__calcScissorBounds(state);
+        }
+        nvgText(ctx, text->x, text->y, str, str + text->nstr);
+        i += text->ncalls;
+      }
+      continue;
+    }
+
+    state->compositeOperation = call->compositeOperation;
+    state->scissor = call->scissor;
+    if (state->scissor.extent[0] > -0.5f) {
+      nvgTransformMultiply(state->scissor.xform, t);
+      nvg__calcScissorBounds(state);
+    }
+    if (call->type == NVG_DL_TRIANGLES) {
+      NVGvertex* verts = nvg__allocTempVerts(ctx, call->nverts);
+      if (verts == NULL) continue;
+      for (j = 0; j < call->nverts; ++j) {
+        NVGvertex* v = &dl->verts[call->vertOffset + j];
+        nvgTransformPoint(&verts[j].x0, &verts[j].y0, t, v->x0, v->y0);
+        verts[j].x1 = v->x1;  // texture coords
+        verts[j].y1 = v->y1;
+      }
+      // paint xform holds text scale (see nvg__renderText)
+      paint.xform[0] *= sx;
+      paint.xform[3] *= sy;
+      nvg__renderTriangles(ctx, &paint, verts, call->nverts);
+      continue;
+    }
+
+    nvgTransformMultiply(paint.xform, t);
+    nvgBeginPath(ctx);
+    state->shapeAntiAlias = !(call->flags & NVG_PATH_NO_AA);
+    if (call->ncmds > 0 && scale > NVG_DL_RETESS_SCALE) {
+      // scaled up too much to reuse flattened path
+      if (!nvg__reserveCommands(ctx, call->ncmds)) continue;
+      memcpy(ctx->commands, &dl->commands[call->cmdOffset], call->ncmds*sizeof(float));
+      nvg__transformCommands(ctx->commands, call->ncmds, t);
+      ctx->ncommands = call->ncmds;
+      nvg__flattenPaths(ctx);
+      if (call->strokeWidth > 0)
+        nvg__expandStroke(ctx, call->strokeWidth*scale, call->lineCap, call->lineJoin, call->miterLimit);
+      else
+        nvg__expandFill(ctx);
+    } else {
+      NVGvertex* verts;
+      int nverts = 0;
+      for (j = 0; j < call->npaths; ++j)
+        nverts += dl->paths[call->pathOffset + j].nfill;
+      verts = nvg__allocTempVerts(ctx, nverts);
+      if (verts == NULL) continue;
+      for (j = 0; j < call->npaths; ++j) {
+        NVGpath* src = &dl->paths[call->pathOffset + j];
+        NVGpath* path;
+        nvg__addPath(ctx);
+        if (ctx->cache->npaths != j+1) break;
+        path = nvg__lastPath(ctx);
+        *path = *src;
+        path->first = 0;
+        path->count = 0;
+        path->fill = verts;
+        for (k = 0; k < src->nfill; ++k, ++verts) {
+          NVGvertex* v = &dl->verts[src->first + k];
+          nvgTransformPoint(&verts->x0, &verts->y0, t, v->x0, v->y0);
+          nvgTransformPoint(&verts->x1, &verts->y1, t, v->x1, v->y1);
+        }
+      }
+    }
+    nvg__calcBounds(ctx);
+    nvg__renderFill(ctx, &paint, call->flags, call->strokeWidth);
+  }
+  nvgBeginPath(ctx);
+  nvgRestore(ctx);
+}
+
 void nvgFill(NVGcontext* ctx)
 {
   NVGstate* state = nvg__getState(ctx);
@@ -2026,12 +3171,15 @@ void nvgFill(NVGcontext* ctx)
   fillPaint.innerColor.a *= state->alpha;
   fillPaint.outerColor.a *= state->alpha;
 
+  // rects can be filled w/o flattening
+  if (nvg__renderRect(ctx, &fillPaint, flags))
+    return;
+
   nvg__flattenPaths(ctx);
   nvg__expandFill(ctx);
   nvg__calcBounds(ctx);
 
-  ctx->params.renderFill(ctx->params.userPtr, &fillPaint, state->compositeOperation, &state->scissor, flags,
-      ctx->cache->bounds, ctx->cache->paths, ctx->cache->npaths);
+  nvg__renderFill(ctx, &fillPaint, flags, 0);
 
   // clear convex flag so it isn't erroneously applied to a subsequent stroke
   if(ctx->cache->npaths == 1) ctx->cache->paths[0].convex = 0;
@@ -2067,11 +3215,12 @@ void nvgStroke(NVGcontext* ctx)
     cache->paths += npaths0;
     cache->npaths -= npaths0;
   }
-  nvg__expandStroke(ctx, strokeWidth, state->lineCap, state->lineJoin, state->miterLimit);
-  nvg__calcBounds(ctx);
-
-  ctx->params.renderFill(ctx->params.userPtr, &strokePaint,
-      state->compositeOperation, &state->scissor, flags, cache->bounds, cache->paths, cache->npaths);
+  // thin strokes can be drawn directly from flattened paths
+  if (!nvg__renderLines(ctx, &strokePaint, flags, strokeWidth)) {
+    nvg__expandStroke(ctx, strokeWidth, state->lineCap, state->lineJoin, state->miterLimit);
+    nvg__calcBounds(ctx);
+    nvg__renderFill(ctx, &strokePaint, flags, strokeWidth);
+  }
   // restore path cache
   cache->npaths = npaths0;
   cache->npoints = npoints0;
@@ -2149,6 +3298,8 @@ void nvgAtlasTextThreshold(NVGcontext* ctx, float px)
   if (atlasFontPx > currAtlasFontPx) {
     int w = NVG_INIT_FONTIMAGE_SIZE, h = NVG_INIT_FONTIMAGE_SIZE;
     fonsResetAtlas(ctx->fs, w, h, atlasFontPx);
+    NVG_STAT(ctx->stats.atlasResets++);
+    ctx->atlasGeneration++;
 
     if (ctx->fontImageIdx < 0) {
       int type = (ctx->params.flags & NVG_SDF_TEXT) ? NVG_TEXTURE_ALPHA : NVG_TEXTURE_FLOAT;
@@ -2208,7 +3359,11 @@ static void nvg__flushTextTexture(NVGcontext* ctx)
       int y = dirty[1];
       int w = dirty[2] - dirty[0];
       int h = dirty[3] - dirty[1];
+      NVG_STAT(double t0 = nvgStatsTime());
+      NVG_TRACE_BEGIN("uploadFontAtlas", -1);
       ctx->params.renderUpdateTexture(ctx->params.userPtr, fontImage, x,y, w,h, data);
+      NVG_TRACE_END("uploadFontAtlas");
+      NVG_STAT(ctx->stats.textureMs += nvgStatsTime() - t0);
     }
   }
 }
@@ -2240,6 +3395,8 @@ static int nvg__allocTextAtlas(NVGcontext* ctx)
   ++ctx->fontImageIdx;
   fonsGetAtlasSize(ctx->fs, NULL, NULL, &atlasFontPx);
   fonsResetAtlas(ctx->fs, iw, ih, atlasFontPx);
+  NVG_STAT(ctx->stats.atlasResets++);
+  ctx->atlasGeneration++;
   return 1;
 }
 
@@ -2268,7 +3425,7 @@ static void nvg__renderText(NVGcontext* ctx, FONSstate* fons, NVGvertex* verts,
   // feather is used a flag to enable gamma adjust for text
   //paint.feather = ctx->sRGBTextAdj ? 1 : 0;
   paint.radius = state->fontBlur;
-  ctx->params.renderTriangles(ctx->params.userPtr, &paint, state->compositeOperation, &state->scissor, verts, nverts);
+  nvg__renderTriangles(ctx, &paint, verts, nverts);
 }
 
 static void nvg__drawSTBTTGlyph(NVGcontext* ctx, stbtt_fontinfo* font, int glyph)
@@ -2402,19 +3559,27 @@ float nvgText(NVGcontext* ctx, float x, float y, const char* string, const char*
   NVGstate* state = nvg__getState(ctx);
   FONSstate fons;
   float* t = state->xform;
-  float pxsize;
+  float pxsize, nextx;
+  int textCall = -1;
 
+  if (end == NULL)
+    end = string + strlen(string);
+  if (ctx->recording)
+    textCall = nvg__beginRecordText(ctx, x, y, string, end);
   nvg__fonsSetup(ctx, &fons);
   pxsize = fonsGetSize(&fons);
   if(ctx->atlasTextThresh <= 0
       || nvg__sqrtf(t[0]*t[0] + t[2]*t[2])*pxsize > ctx->atlasTextThresh
       || nvg__sqrtf(t[1]*t[1] + t[3]*t[3])*pxsize > ctx->atlasTextThresh
       || ((ctx->params.flags & NVG_ROTATED_TEXT_AS_PATHS) && (t[1] != 0.0f || t[2] != 0.0f))) {
-    float nextx = nvg__textAsPaths(ctx, &fons, x, y, string, end);
+    nextx = nvg__textAsPaths(ctx, &fons, x, y, string, end);
     nvgFill(ctx);
-    return nextx;
   }
-  return nvg__textFromAtlas(ctx, &fons, x, y, string, end);
+  else
+    nextx = nvg__textFromAtlas(ctx, &fons, x, y, string, end);
+  if (textCall >= 0)
+    nvg__endRecordText(ctx, textCall);
+  return nextx;
 }
 
 float nvgTextAsPaths(NVGcontext* ctx, float x, float y, const char* string, const char* end)
@@ -18,6 +18,8 @@ extern "C" {
 #endif
 
 typedef struct NVGcontext NVGcontext;
+typedef struct NVGdisplayList NVGdisplayList;
+typedef struct NVGpathObject NVGpathObject;
 
 struct NVGcolor {
   union {
@@ -146,6 +148,44 @@ void nvgCancelFrame(NVGcontext* ctx);
 // Ends drawing flushing remaining render state.
 void nvgEndFrame(NVGcontext* ctx);
 
+#define NVG_STATS_MAX_THREADS 64
+
+// Counters and timings (in milliseconds) for the last frame, filled in by nanovg.c and the backend
+struct NVGframeStats {
+  int fillCalls;  // renderFill calls (fills and strokes)
+  int triangleCalls;  // renderTriangles calls (text from atlas)
+  int paths;
+  int points;  // flattened points
+  int fillVerts;
+  int strokeVerts;
+  int glyphs;  // glyphs rasterized into font atlas
+  int atlasResets;
+  float flattenMs;
+  float expandFillMs;
+  float expandStrokeMs;
+  float textureMs;  // texture creation and updates, incl. font atlas uploads and backend mipmap generation
+  // backend
+  int edges;  // edges submitted to rasterizer
+  long long pixelsCovered;  // pixels w/ nonzero coverage
+  long long pixelsBlended;  // pixels passed to blending (incl. zero coverage ones within spans)
+  float sortMs;
+  int nthreads;
+  float rasterizeMs[NVG_STATS_MAX_THREADS];  // per thread
+};
+typedef struct NVGframeStats NVGframeStats;
+
+// Get stats for frame ended by last nvgEndFrame; stats are only collected if nanovg.c and the backend are
+//  compiled with NVG_FRAME_STATS defined, otherwise all values are zero.  With NVGSW_ASYNC, rasterizer
+//  stats are complete after nvgswWaitFrame
+void nvgGetFrameStats(NVGcontext* ctx, NVGframeStats* stats);
+
+// Write events recorded by all threads (frame phases, backend tasks, and sampled expensive draw calls) as Chrome
+//  trace event JSON, viewable in chrome://tracing or ui.perfetto.dev; only the most recent events are kept for
+//  each thread.  Events are only recorded if nanovg.c and the backend are compiled with NVG_TRACE defined.
+//  Should be called while no frame is being rendered (with NVGSW_ASYNC, after nvgswWaitFrame).  Returns 0 if
+//  tracing is not enabled or file can't be written
+int nvgTraceDump(const char* path);
+
 //
 // Composite operation
 //
@@ -512,6 +552,46 @@ void nvgFill(NVGcontext* ctx);
 // Fills the current path with current stroke style.
 void nvgStroke(NVGcontext* ctx);
 
+//
+// Display lists
+//
+// Fills, strokes, and text drawn between nvgBeginRecording() and nvgEndRecording() are not rendered, but
+// are instead saved, after flattening and stroking, in a display list which can be drawn any number of times
+// with nvgDrawDisplayList().  Paths are only flattened again if the list is drawn with a transform that
+// scales up by more than a small factor; text is laid out again if the font atlas has changed or the
+// transform can't be applied to atlas glyphs.  Drawing a display list clears the current path.
+
+// Begins recording a new display list.
+void nvgBeginRecording(NVGcontext* ctx);
+
+// Ends recording and returns display list, which must be deleted with nvgDeleteDisplayList().
+NVGdisplayList* nvgEndRecording(NVGcontext* ctx);
+
+// Draws display list, with transform xform (float[6], can be NULL for identity) applied on top of the
+// transform(s) in effect when the list was recorded.  Current state (transform, paint, scissor) is ignored.
+void nvgDrawDisplayList(NVGcontext* ctx, NVGdisplayList* dl, const float* xform);
+
+// Deletes display list.
+void nvgDeleteDisplayList(NVGdisplayList* dl);
+
+//
+// Path objects
+//
+// A path object holds a copy of a path which can be filled many times with different transforms.  The
+// flattened path is cached for a few (quantized) scale factors, so drawing the same path translated or
+// rotated only needs to transform the cached points.
+
+// Creates path object from the current path, in the coordinate system of the current transform.
+// Returns NULL on failure.  Must be deleted with nvgDeletePathObject().
+NVGpathObject* nvgCreatePathObject(NVGcontext* ctx);
+
+// Replaces current path with the path object, transformed by the current transform, and fills it
+// with the current fill style.  nvgStroke() can be called afterwards to stroke the same path.
+void nvgFillPathObject(NVGcontext* ctx, NVGpathObject* path);
+
+// Deletes path object.
+void nvgDeletePathObject(NVGpathObject* path);
+
 
 //
 // Text
@@ -700,7 +780,16 @@ struct NVGparams {
   void (*renderFlush)(void* uptr);
   void (*renderFill)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, int flags, const float* bounds, const NVGpath* paths, int npaths);
   void (*renderTriangles)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, const NVGvertex* verts, int nverts);
+  // optional; fill of axis-aligned rect (x0, y0, x1, y1 in device space) w/ circular corners of given radius -
+  //  returns 0 if not handled, in which case path is passed to renderFill
+  int (*renderRect)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, int flags, const float* bounds, const float* rect, float radius);
+  // optional; strokes at most thinStrokeWidth wide (device pixels) are passed here w/o join and cap geometry: fill of
+  //  each path is its segments (x0,y0 -> x1,y1), w/ closing segment if closed, to be drawn w/ round joins; strokes
+  //  w/ miter or bevel joins visibly different from round are not passed - returns 0 if not handled
+  int (*renderLines)(void* uptr, NVGpaint* paint, NVGcompositeOperationState compositeOperation, NVGscissor* scissor, int flags, const float* bounds, float strokeWidth, int lineCap, const NVGpath* paths, int npaths);
+  float thinStrokeWidth;
   void (*renderDelete)(void* uptr);
+  void (*renderGetStats)(void* uptr, NVGframeStats* stats);  // optional; fills backend fields
 };
 typedef struct NVGparams NVGparams;
 
@@ -720,6 +809,43 @@ NVGparams* nvgInternalParams(NVGcontext* ctx);
 // Debug function to dump cached path data.
 void nvgDebugDumpPathCache(NVGcontext* ctx);
 
+// NVG_STAT(...) expands to its arguments only when frame stats are enabled
+#ifdef NVG_FRAME_STATS
+#define NVG_STAT(...) __VA_ARGS__
+#else
+#define NVG_STAT(...)
+#endif
+
+#ifdef NVG_FRAME_STATS
+// flatten curves only w/ nanovg's original recursive subdivision (quadratics elevated to cubics), to compare
+//  points and flatten time in benchmarks; flattened copies already kept by path objects are not affected
+void nvgFlattenRecursive(NVGcontext* ctx, int enable);
+#endif
+
+#if defined(NVG_FRAME_STATS) || defined(NVG_TRACE)
+// monotonic clock in milliseconds, for frame stats and tracing
+double nvgStatsTime(void);
+#endif
+
+// trace events go to a ring buffer for calling thread; name must be a string literal (only pointer is saved);
+//  arg is shown in trace viewer if >= 0
+#ifdef NVG_TRACE
+void nvgTraceEvent(const char* name, char phase, double ts, double dur, int arg);
+void nvgTraceThreadName(const char* name);
+#define NVG_TRACE_BEGIN(name, arg) nvgTraceEvent(name, 'B', nvgStatsTime(), 0, arg)
+#define NVG_TRACE_END(name) nvgTraceEvent(name, 'E', nvgStatsTime(), 0, -1)
+// complete event, for events only recorded after they end (e.g., if duration exceeds a threshold)
+#define NVG_TRACE_COMPLETE(name, t0, t1, arg) nvgTraceEvent(name, 'X', t0, (t1) - (t0), arg)
+#define NVG_TRACE_THREAD(name) nvgTraceThreadName(name)
+#define NVG_TRACING(...) __VA_ARGS__
+#else
+#define NVG_TRACE_BEGIN(name, arg)
+#define NVG_TRACE_END(name)
+#define NVG_TRACE_COMPLETE(name, t0, t1, arg)
+#define NVG_TRACE_THREAD(name)
+#define NVG_TRACING(...)
+#endif
+
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -20,6 +20,14 @@ extern "C" {
 enum NVGSWcreateFlags {
   NVGSW_PATHS_XC = 1<<3,  // use exact coverage algorithm for path rendering
   NVGSW_SDFGEN = 1<<4,  // to generate distance field textures for use by another renderer
+  NVGSW_NO_SIMD = 1<<5,  // use scalar (reference) span blending even if SIMD kernels are available
+  NVGSW_DAMAGE = 1<<6,  // only redraw tiles affected by draw calls that changed since previous frame
+  NVGSW_ASYNC = 1<<7,  // nvgEndFrame returns without waiting for rasterization (requires threading)
+  // blend with premultiplied colors and texels, so all composite operations (nvgGlobalCompositeOperation) are as
+  //  fast as source over; blend funcs w/ color factors or NVG_SRC_ALPHA_SATURATE are supported but evaluated per
+  //  pixel; NVG_SRGB (linear blending) is ignored and NVG_IMAGE_NOCOPY images must be premultiplied
+  NVGSW_PREMULTIPLIED = 1<<8,
+  NVGSW_PIN_THREADS = 1<<9,  // pin nvgswSetThreadCount workers to CPUs (Windows, and Linux w/ _GNU_SOURCE)
 };
 
 
@@ -28,11 +36,63 @@ NVGcontext* nvgswCreate(int flags);
 void nvgswDelete(NVGcontext* ctx);
 void nvgswSetFramebuffer(NVGcontext* vg, void* dest, int w, int h, int rshift, int gshift, int bshift, int ashift);
 
+enum NVGSWformat {
+  NVGSW_RGBA8 = 0,  // 32-bit, bytes R,G,B,A in memory (same as nvgswSetFramebuffer with shifts 0,8,16,24)
+  NVGSW_BGRA8,  // 32-bit, bytes B,G,R,A in memory
+  NVGSW_RGB565,  // 16-bit, R in high bits; no alpha
+  NVGSW_A8,  // 8-bit alpha only, e.g., for masks
+  NVGSW_RGBA16F,  // 64-bit half float R,G,B,A; with NVG_SRGB, color values are linear (not sRGB encoded)
+};
+
+// Set framebuffer with one of the formats above and stride in bytes per row (0 for w * bytes per pixel); colors
+//  written are premultiplied by alpha if framebuffer is initially cleared to zero (this is also true for
+//  nvgswSetFramebuffer)
+void nvgswSetFramebufferFormat(NVGcontext* vg, void* dest, int w, int h, int stride, int format);
+
+// xthreads*ythreads tasks are submitted for each frame; each task renders tiles until none are left
 typedef void (*taskFn_t)(void*);
 typedef void (*poolSubmit_t)(taskFn_t, void*);
 typedef void (*poolWait_t)(void);
 void nvgswSetThreading(NVGcontext* vg, int xthreads, int ythreads, poolSubmit_t submit, poolWait_t wait);
 
+// Alternative to nvgswSetThreading using a persistent pool of n - 1 worker threads owned by the context; the
+//  thread calling nanovg runs tasks while waiting, so n threads render each frame.  Must be called before
+//  nvgswSetFramebuffer
+void nvgswSetThreadCount(NVGcontext* vg, int n);
+
+// With NVGSW_ASYNC, nvgEndFrame submits the frame's tasks to the pool and returns, so the next frame can be built
+//  while the previous one is rasterized; nvgswWaitFrame() blocks until the last submitted frame is complete and
+//  must be called before reading the framebuffer.  The next nvgEndFrame, nvgswSetFramebuffer, texture creation
+//  (if texture array must grow) and texture updates wait implicitly; texture deletes are deferred until the frame
+//  completes.  Pool tasks are only submitted and waited on from the thread calling nanovg.
+void nvgswWaitFrame(NVGcontext* vg);
+
+// With NVGSW_DAMAGE, framebuffer contents must be preserved between frames (i.e., not cleared by caller); damaged
+//  tiles are cleared to zero and redrawn.  Changing framebuffer in nvgswSetFramebuffer forces a full redraw.
+//  Returns number of rectangles (x, y, w, h) redrawn by last nvgEndFrame; rects is valid until next frame
+int nvgswGetDamage(NVGcontext* vg, const int** rects);
+
+// Draw calls (or rows of them) completely hidden by later opaque fills are skipped; returns number of call/tile
+//  pairs skipped entirely and number of pixels of call bounds skipped by last nvgEndFrame
+void nvgswGetCullStats(NVGcontext* vg, int* skippedCalls, int* skippedPixels);
+
+// Coverage for atlas text glyphs is cached (with x position quantized to 1/4 pixel) and reused while glyph
+//  scale, weight, and subpixel offset are unchanged; least recently used glyphs are evicted when cache exceeds
+//  maxBytes (default 4MB); 0 disables cache
+void nvgswSetGlyphCacheSize(NVGcontext* vg, int maxBytes);
+
+// With NVGSW_SDFGEN, each fill writes signed distance to path (negative inside, clamped to +/-radius) for pixels
+//  within radius of path and inside scissor; for an NVGSW_A8 framebuffer, dist*scale + offset (clamped to 0-255) is
+//  written, otherwise framebuffer is float.  Defaults are radius 4, scale -32, offset 127 (fontstash defaults).
+//  Many glyphs can be generated in one frame, e.g., each translated and scissored to its cell in an A8 atlas, in
+//  which case tiles are rendered in parallel like any other frame
+void nvgswSetSDFParams(NVGcontext* vg, int radius, float scale, float offset);
+
+// Strokes at most width device pixels wide (default NVGSW_THIN_STROKE_WIDTH = 1) are rasterized directly from
+//  path segments instead of expanded to a polygon; joins are round (strokes w/ sharp miter or bevel joins are still
+//  expanded) and segments of a stroke don't add coverage where they overlap.  0 disables
+void nvgswSetThinStrokeWidth(NVGcontext* vg, float width);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +102,7 @@ void nvgswSetThreading(NVGcontext* vg, int xthreads, int ythreads, poolSubmit_t
 #ifdef NANOVG_SW_IMPLEMENTATION
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
 #include "nanovg.h"
@@ -51,6 +112,28 @@ void nvgswSetThreading(NVGcontext* vg, int xthreads, int ythreads, poolSubmit_t
 #define NVG_LOG(...) fprintf(stderr, __VA_ARGS__)
 #endif
 
+// SIMD span blending - define NANOVG_SW_NO_SIMD to build with scalar code only
+#ifndef NANOVG_SW_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SWNVG__SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define SWNVG__AVX2 1
+#define SWNVG__TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define SWNVG__AVX2 1
+#define SWNVG__TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SWNVG__NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
 enum SWNVGpaintType {
   SWNVG_PAINT_NONE = 0,
   SWNVG_PAINT_COLOR,
@@ -63,16 +146,369 @@ enum SWNVGpaintType {
 #define SWNVG__FIXSHIFT		10
 #define SWNVG__FIX			(1 << SWNVG__FIXSHIFT)
 #define SWNVG__FIXMASK		(SWNVG__FIX-1)
-#define SWNVG__MEMPAGE_SIZE	1024
+
+// framebuffer is split into tiles of this size for multithreaded rendering
+#ifndef NVGSW_TILE_SIZE
+#define NVGSW_TILE_SIZE 64
+#endif
+
+// with NVG_TRACE, every NVGSW_TRACE_SAMPLE-th draw call rasterized by each thread is timed and recorded if it
+//  takes at least NVGSW_TRACE_MIN_MS in a tile
+#ifndef NVGSW_TRACE_SAMPLE
+#define NVGSW_TRACE_SAMPLE 8
+#endif
+#ifndef NVGSW_TRACE_MIN_MS
+#define NVGSW_TRACE_MIN_MS 0.02
+#endif
+
+// default for nvgswSetThinStrokeWidth
+#ifndef NVGSW_THIN_STROKE_WIDTH
+#define NVGSW_THIN_STROKE_WIDTH 1.0f
+#endif
+
+// how far ahead in previous frame's calls to look for a match when computing damage
+#define SWNVG__DAMAGE_LOOKAHEAD 32
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define swnvg__atomicLoad(p) (_ReadWriteBarrier(), *(volatile int*)(p))
+#define swnvg__atomicStore(p, v) do { _ReadWriteBarrier(); *(volatile int*)(p) = (v); } while(0)
+#define swnvg__atomicAdd(p, v) _InterlockedExchangeAdd((volatile long*)(p), (v))
+#define swnvg__atomicCAS(p, expect, v) (_InterlockedCompareExchange((volatile long*)(p), (v), (expect)) == (expect))
+#else
+#define swnvg__atomicLoad(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define swnvg__atomicStore(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define swnvg__atomicAdd(p, v) __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define swnvg__atomicCAS(p, expect, v) __extension__ ({ int e_ = (expect); \
+    __atomic_compare_exchange_n((p), &e_, (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); })
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#define swnvg__yield() SwitchToThread()
+#else
+#include <sched.h>
+#include <pthread.h>
+#define swnvg__yield() sched_yield()
+#endif
+
+// built-in worker pool (nvgswSetThreadCount): tasks are claimed from a fixed ring w/ CAS, so dispatch takes no
+//  locks; idle workers and the waiting thread spin briefly, then block on a condition variable (futex on Linux)
+#define SWNVG__POOL_TASKS 256  // more than max tasks per batch (64) so submitting never has to wait
+#define SWNVG__POOL_SPIN 2000
+
+#if defined(SWNVG__SSE2)
+#define swnvg__pause() _mm_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__aarch64__) || defined(__arm__))
+#define swnvg__pause() __asm__ __volatile__("yield")
+#else
+#define swnvg__pause() do {} while(0)
+#endif
+
+#ifdef _WIN32
+typedef HANDLE swnvg__thread_t;
+typedef SRWLOCK swnvg__mutex_t;
+typedef CONDITION_VARIABLE swnvg__cond_t;
+#define swnvg__fence() MemoryBarrier()
+#define swnvg__mutexInit(m) InitializeSRWLock(m)
+#define swnvg__mutexDestroy(m) do {} while(0)
+#define swnvg__lock(m) AcquireSRWLockExclusive(m)
+#define swnvg__unlock(m) ReleaseSRWLockExclusive(m)
+#define swnvg__condInit(c) InitializeConditionVariable(c)
+#define swnvg__condDestroy(c) do {} while(0)
+#define swnvg__condWait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define swnvg__condBroadcast(c) WakeAllConditionVariable(c)
+#else
+typedef pthread_t swnvg__thread_t;
+typedef pthread_mutex_t swnvg__mutex_t;
+typedef pthread_cond_t swnvg__cond_t;
+#define swnvg__fence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define swnvg__mutexInit(m) pthread_mutex_init(m, NULL)
+#define swnvg__mutexDestroy(m) pthread_mutex_destroy(m)
+#define swnvg__lock(m) pthread_mutex_lock(m)
+#define swnvg__unlock(m) pthread_mutex_unlock(m)
+#define swnvg__condInit(c) pthread_cond_init(c, NULL)
+#define swnvg__condDestroy(c) pthread_cond_destroy(c)
+#define swnvg__condWait(c, m) pthread_cond_wait(c, m)
+#define swnvg__condBroadcast(c) pthread_cond_broadcast(c)
+#endif
+
+// yield occasionally while spinning so threads we are waiting on can run if CPUs are oversubscribed
+static void swnvg__spinPause(int spins)
+{
+  if (spins % 64 == 0)
+    swnvg__yield();
+  else
+    swnvg__pause();
+}
+
+typedef struct SWNVGpoolTask {
+  taskFn_t fn;
+  void* arg;
+} SWNVGpoolTask;
+
+typedef struct SWNVGpool {
+  SWNVGpoolTask tasks[SWNVG__POOL_TASKS];
+  int head;  // index of next task to be claimed
+  int tail;  // number of tasks submitted
+  int pending;  // tasks submitted but not yet finished
+  int drained;  // value of tail when pending was last seen to be zero
+  int sleepers;  // workers blocked on workCond
+  int waiting;  // submitting thread blocked on doneCond
+  int quit;
+  int pin;
+  int nworkers;
+  swnvg__thread_t* workers;
+  swnvg__mutex_t lock;
+  swnvg__cond_t workCond;
+  swnvg__cond_t doneCond;
+} SWNVGpool;
+
+typedef struct SWNVGworker {
+  SWNVGpool* pool;
+  int idx;
+} SWNVGworker;
+
+// run one task if available
+static int swnvg__poolRunOne(SWNVGpool* p)
+{
+  SWNVGpoolTask task;
+  int h = swnvg__atomicLoad(&p->head);
+  if (h >= swnvg__atomicLoad(&p->tail)) return 0;
+  if (!swnvg__atomicCAS(&p->head, h, h + 1)) return 1;  // lost race, but there may be more work
+  task = p->tasks[h % SWNVG__POOL_TASKS];
+  task.fn(task.arg);
+  if (swnvg__atomicAdd(&p->pending, -1) == 1) {
+    swnvg__fence();
+    if (swnvg__atomicLoad(&p->waiting)) {
+      swnvg__lock(&p->lock);
+      swnvg__condBroadcast(&p->doneCond);
+      swnvg__unlock(&p->lock);
+    }
+  }
+  return 1;
+}
+
+// tasks are only submitted from thread calling nanovg; a slot can't be reused until all tasks have finished
+//  (i.e., all slots have been read), which always happens between batches
+static void swnvg__poolSubmit(SWNVGpool* p, taskFn_t fn, void* arg)
+{
+  int t = p->tail;
+  if (swnvg__atomicLoad(&p->pending) == 0)
+    p->drained = t;
+  if (t - p->drained >= SWNVG__POOL_TASKS) {
+    fn(arg);
+    return;
+  }
+  p->tasks[t % SWNVG__POOL_TASKS].fn = fn;
+  p->tasks[t % SWNVG__POOL_TASKS].arg = arg;
+  swnvg__atomicAdd(&p->pending, 1);
+  swnvg__atomicStore(&p->tail, t + 1);
+  // fences on both sides ensure a worker going to sleep either sees new tail or is seen by us
+  swnvg__fence();
+  if (swnvg__atomicLoad(&p->sleepers)) {
+    swnvg__lock(&p->lock);
+    swnvg__condBroadcast(&p->workCond);
+    swnvg__unlock(&p->lock);
+  }
+}
+
+// waiting thread helps run tasks, then spins and finally blocks until last task finishes
+static void swnvg__poolWait(SWNVGpool* p)
+{
+  int spins = 0;
+  while (swnvg__atomicLoad(&p->pending) > 0) {
+    if (swnvg__poolRunOne(p))
+      spins = 0;
+    else if (++spins < SWNVG__POOL_SPIN)
+      swnvg__spinPause(spins);
+    else {
+      swnvg__lock(&p->lock);
+      swnvg__atomicStore(&p->waiting, 1);
+      swnvg__fence();
+      while (swnvg__atomicLoad(&p->pending) > 0)
+        swnvg__condWait(&p->doneCond, &p->lock);
+      swnvg__atomicStore(&p->waiting, 0);
+      swnvg__unlock(&p->lock);
+    }
+  }
+}
+
+// pin worker to idx-th CPU available to process (skipping first, for the calling thread); only supported on
+//  Windows and on Linux w/ _GNU_SOURCE
+static void swnvg__pinThread(int idx)
+{
+#if defined(_WIN32)
+  DWORD_PTR procMask, sysMask;
+  int bit, n = 0;
+  if (!GetProcessAffinityMask(GetCurrentProcess(), &procMask, &sysMask)) return;
+  for (bit = 0; bit < 8*(int)sizeof(DWORD_PTR); ++bit)
+    n += (procMask >> bit) & 1;
+  if (n == 0) return;
+  idx = (idx + 1) % n;
+  for (bit = 0; bit < 8*(int)sizeof(DWORD_PTR); ++bit) {
+    if (((procMask >> bit) & 1) && idx-- == 0) {
+      SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << bit);
+      return;
+    }
+  }
+#elif defined(__linux__) && defined(_GNU_SOURCE)
+  cpu_set_t avail, set;
+  int cpu, n;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(avail), &avail) != 0 || (n = CPU_COUNT(&avail)) == 0) return;
+  idx = (idx + 1) % n;
+  for (cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &avail) && idx-- == 0) {
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+      return;
+    }
+  }
+#else
+  (void)idx;
+#endif
+}
+
+static void swnvg__poolWorker(SWNVGworker* w)
+{
+  SWNVGpool* p = w->pool;
+  int spins = 0;
+  NVG_TRACE_THREAD("nvgsw worker");
+  if (p->pin)
+    swnvg__pinThread(w->idx);
+  while (!swnvg__atomicLoad(&p->quit)) {
+    if (swnvg__poolRunOne(p))
+      spins = 0;
+    else if (++spins < SWNVG__POOL_SPIN)
+      swnvg__spinPause(spins);
+    else {
+      swnvg__lock(&p->lock);
+      swnvg__atomicAdd(&p->sleepers, 1);
+      swnvg__fence();
+      while (!swnvg__atomicLoad(&p->quit) && swnvg__atomicLoad(&p->head) >= swnvg__atomicLoad(&p->tail))
+        swnvg__condWait(&p->workCond, &p->lock);
+      swnvg__atomicAdd(&p->sleepers, -1);
+      swnvg__unlock(&p->lock);
+      spins = 0;
+    }
+  }
+  free(w);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI swnvg__workerMain(LPVOID arg) { swnvg__poolWorker((SWNVGworker*)arg); return 0; }
+#else
+static void* swnvg__workerMain(void* arg) { swnvg__poolWorker((SWNVGworker*)arg); return NULL; }
+#endif
+
+static void swnvg__poolDelete(SWNVGpool* p)
+{
+  int i;
+  if (!p) return;
+  swnvg__lock(&p->lock);
+  swnvg__atomicStore(&p->quit, 1);
+  swnvg__condBroadcast(&p->workCond);
+  swnvg__unlock(&p->lock);
+  for (i = 0; i < p->nworkers; ++i) {
+#ifdef _WIN32
+    WaitForSingleObject(p->workers[i], INFINITE);
+    CloseHandle(p->workers[i]);
+#else
+    pthread_join(p->workers[i], NULL);
+#endif
+  }
+  swnvg__condDestroy(&p->workCond);
+  swnvg__condDestroy(&p->doneCond);
+  swnvg__mutexDestroy(&p->lock);
+  free(p->workers);
+  free(p);
+}
+
+static SWNVGpool* swnvg__poolCreate(int nworkers, int pin)
+{
+  int i;
+  SWNVGpool* p = (SWNVGpool*)malloc(sizeof(SWNVGpool));
+  if (!p) return NULL;
+  memset(p, 0, sizeof(SWNVGpool));
+  p->pin = pin;
+  swnvg__mutexInit(&p->lock);
+  swnvg__condInit(&p->workCond);
+  swnvg__condInit(&p->doneCond);
+  p->workers = (swnvg__thread_t*)malloc(sizeof(swnvg__thread_t)*nworkers);
+  if (!p->workers) { swnvg__poolDelete(p); return NULL; }
+  for (i = 0; i < nworkers; ++i) {
+    SWNVGworker* w = (SWNVGworker*)malloc(sizeof(SWNVGworker));
+    if (!w) break;
+    w->pool = p;
+    w->idx = i;
+#ifdef _WIN32
+    p->workers[i] = CreateThread(NULL, 0, swnvg__workerMain, w, 0, NULL);
+    if (!p->workers[i]) { free(w); break; }
+#else
+    if (pthread_create(&p->workers[i], NULL, swnvg__workerMain, w) != 0) { free(w); break; }
+#endif
+    p->nworkers = i + 1;
+  }
+  if (p->nworkers < nworkers) {
+    swnvg__poolDelete(p);
+    return NULL;
+  }
+  return p;
+}
 
 typedef unsigned int rgba32_t;
 
+// blend span of pixels w/ per-pixel source color or w/ a single color; cover is per-pixel coverage
+typedef void (*swnvg__blendSpanFn)(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear);
+typedef void (*swnvg__blendSolidFn)(unsigned char* dst, rgba32_t src, const unsigned char* cover, int count, int linear);
+// premultiplied blending (NVGSW_PREMULTIPLIED) - each blend factor (src RGB, dst RGB, src alpha, dst alpha) is
+//  k0 + ks*srca + kd*dsta, so every composite operation is the same multiply-add
+typedef struct SWNVGblend {
+  int k0[4], ks[4], kd[4];
+  int srcOver;
+  int perPixel;  // color factors or NVG_SRC_ALPHA_SATURATE, which k0, ks, kd can't express
+} SWNVGblend;
+typedef void (*swnvg__blendSpanPMFn)(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, const SWNVGblend* b);
+typedef void (*swnvg__blendSolidPMFn)(unsigned char* dst, rgba32_t src, const unsigned char* cover, int count, const SWNVGblend* b);
+// convert span of framebuffer pixels to or from 8888 (for formats other than 32-bit)
+typedef void (*swnvg__loadSpanFn)(rgba32_t* dst, const unsigned char* src, int count, int linear);
+typedef void (*swnvg__storeSpanFn)(unsigned char* dst, const rgba32_t* src, int count, int linear);
+// bilinear image sampling for span of pixels
+typedef void (*swnvg__texSpanFn)(rgba32_t* dst, const rgba32_t* img, int w, int h, float qx, float qy, float dqx, float dqy, int count);
+// gradient parameter (0 = inner color, 1 = outer color) for span of pixels starting at x,y
+struct SWNVGcall;
+typedef void (*swnvg__gradSpanFn)(float* d, const struct SWNVGcall* call, int x, int y, int count);
+
+enum SWNVGgradType {
+  SWNVG_GRAD_BOX = 0,  // also radial
+  SWNVG_GRAD_LINEAR
+};
+
+// size of color ramp for 2-stop gradients
+#define SWNVG__RAMP_SIZE 256
+// linear gradient parameter is recalculated every this many pixels instead of stepped
+#define SWNVG__GRAD_ANCHOR 32
+
+#define SWNVG__MAX_MIPS 16
+
 struct SWNVGtexture {
   int id;
   void* data;
   int width, height;
   int type;
   int flags;
+  int generation;  // incremented on update, for damage tracking
+  int opaque;  // all texels have alpha = 255
+  // mip levels 1 to nmips for NVG_IMAGE_GENERATE_MIPMAPS - built when image is first drawn minified
+  rgba32_t* mips;
+  int mipOffset[SWNVG__MAX_MIPS+1];
+  int nmips;
+  int mipsValid;
+  int release;  // deleted (or discarded) while in use by frame being rendered; freed when frame completes
 };
 typedef struct SWNVGtexture SWNVGtexture;
 
@@ -88,8 +524,10 @@ struct SWNVGcall {
   int imgOffset;
   int bounds[4];
   NVGcompositeOperationState blendFunc;
+  SWNVGblend blend;  // blendFunc as factors for NVGSW_PREMULTIPLIED
   SWNVGtexture* tex;
 
+  // members from scissorMat up to sortState are hashed for damage tracking
   float scissorMat[6];
   float paintMat[6];
   rgba32_t innerCol;
@@ -99,47 +537,107 @@ struct SWNVGcall {
   float extent[2];
   float radius;
   float feather;
+  float shape[5];  // rect calls: x0, y0, x1, y1, corner radius
+  float lineWidth;  // line calls: stroke width
+  int sortState;  // 0 = unsorted, 1 = sorting, 2 = sorted
+
+  // derived from above for gradients
+  int gradType;
+  float gradLinear[3];  // linear gradient parameter = gradLinear[0]*x + gradLinear[1]*y + gradLinear[2]
+  int rampOffset;  // offset of color ramp in SWNVGcontext::ramps, or -1
+  float lod;  // image mip level of detail, 0 if not minified
+  // scissor factor is 1 for |q| <= scissorIn and 0 for |q| >= scissorOut, q = scissorMat * point
+  float scissorIn[2];
+  float scissorOut[2];
+  // for occlusion culling: if occluder is set, pixels in interior (inclusive) are fully covered by opaque paint
+  int occluder;
+  int interior[4];
+  int glyphOffset;  // offset in SWNVGcontext::quadGlyphs for atlas quads, or -1
+  // for rotated or skewed atlas quads: atlas texels per pixel, (ds/dx, ds/dy, dt/dx, dt/dy)
+  int affineQuads;
+  float quadMat[4];
+  int rect;  // filled analytically from shape instead of edges (renderRect)
+  int lines;  // thin stroke drawn from segments in edges (renderLines)
 };
 typedef struct SWNVGcall SWNVGcall;
 
 typedef struct SWNVGedge {
   float x0,y0, x1,y1;
   int dir;
-  struct SWNVGedge* next;
 } SWNVGedge;
 
-typedef struct SWNVGactiveEdge {
-  int x,dx;
-  float ey;
-  int dir;
-  struct SWNVGactiveEdge *next;
-} SWNVGactiveEdge;
-
-typedef struct SWNVGmemPage {
-  unsigned char mem[SWNVG__MEMPAGE_SIZE];
-  int size;
-  struct SWNVGmemPage* next;
-} SWNVGmemPage;
+typedef struct SWNVGcallRecord {
+  unsigned long long hash;
+  int bounds[4];
+} SWNVGcallRecord;
+
+#define SWNVG__GLYPH_KEYLEN 13
+
+typedef struct SWNVGglyph {
+  unsigned int key[SWNVG__GLYPH_KEYLEN];  // texture, texcoords, scale, radius, subpixel offset, rotation/skew
+  int next;  // next entry in hash chain or free list
+  int lruPrev, lruNext;
+  int frame;  // last frame in which glyph was drawn
+  int texRows[2];  // atlas rows read, for invalidation by texture update
+  int w, h;
+  float fx, fy;  // offset of quad origin from first pixel
+  unsigned char* cover;
+  // source of coverage for new glyph, valid during renderFlush
+  SWNVGcall* call;
+  NVGvertex *v00, *v11;
+} SWNVGglyph;
 
 struct SWNVGcontext;
 typedef struct SWNVGthreadCtx {
   struct SWNVGcontext* context;
   int threadnum;
-  int x0, y0, x1, y1;
+  int x0, y0, x1, y1;  // current tile
+  int nextTile, endTile;  // this thread's range of tiles - nextTile is shared w/ other threads for stealing
 
-  SWNVGactiveEdge* freelist;
-  SWNVGmemPage* pages;
-  SWNVGmemPage* curpage;
+  // active edge table for sub-scanline rasterizer - structure of arrays, kept sorted by x
+  int* aetX;
+  int* aetDx;
+  float* aetEy;
+  int* aetDir;
+  int naet;
+  int caet;
 
   unsigned char* scanline;
+  rgba32_t* spanColors;  // source colors for image and gradient spans
+  float* spanDist;  // gradient parameter for span
+  rgba32_t* mipColors;  // colors from second mip level for trilinear filtering
   int cscanline;
 
+  // XC coverage for current tile: difference from pixel to left, tileW x tileH
+  float* covtex;
   int* lineLimits;
+  float* sdfDist;  // NVGSW_SDFGEN: squared distance to nearest edge for current tile
+  unsigned char* lineCov;  // thin stroke coverage for current tile, tileW x tileH
+  int* lineRows;  // x range written to lineCov for each row
+
+  // occlusion culling: visible rows (y0, y1) for each call in current tile
+  int* clipRows;
+  int cclipRows;
+  int culledCalls, culledPixels;
+#ifdef NVG_FRAME_STATS
+  long long statCovered, statBlended;
+  double statRasterMs, statSortMs;
+#endif
+#ifdef NVG_TRACE
+  int traceSample;  // calls rasterized, for sampling
+#endif
+
+  // scratch for sorting edges of a call by starting row
+  SWNVGedge* sortEdges;
+  int csortEdges;
+  int* sortCounts;
+  int csortCounts;
 } SWNVGthreadCtx;
 
 struct SWNVGcontext {
   unsigned char* bitmap;
   int width, height, stride;
+  int format, bpp;  // NVGSWformat and bytes per pixel
   int rshift, gshift, bshift, ashift;
   SWNVGtexture* textures;
   int ntextures;
@@ -155,24 +653,116 @@ struct SWNVGcontext {
   struct NVGvertex* verts;
   int cverts;
   int nverts;
+  rgba32_t* ramps;  // color ramps for 2-stop gradients
+  int cramps;
+  int nramps;
 
   // rasterizer data
   SWNVGedge* edges;
   int nedges;
   int cedges;
 
+  // NVGSW_ASYNC: per frame buffers are swapped with these when frame is submitted; workers render frame from a
+  //  copy of context made at submission
+  SWNVGcall* spareCalls;
+  int cspareCalls;
+  struct NVGvertex* spareVerts;
+  int cspareVerts;
+  rgba32_t* spareRamps;
+  int cspareRamps;
+  SWNVGedge* spareEdges;
+  int cspareEdges;
+  struct SWNVGcontext* flight;
+  int inFlight;
+
   poolSubmit_t poolSubmit;
   poolWait_t poolWait;
+  SWNVGpool* pool;  // built-in pool, used instead of poolSubmit/poolWait if set
   SWNVGthreadCtx* threads;
   int xthreads;
   int ythreads;
-  float* covtex;
+
+  // tiles and per-tile call lists
+  int tileW, tileH;
+  int xtiles, ytiles;
+  int* tileCallStart;
+  int* tileCalls;
+  int ctileCalls;
+
+  // damage tracking - previous frame's calls and tiles to be redrawn
+  SWNVGcallRecord* prevCalls;
+  int nprevCalls;
+  int cprevCalls;
+  SWNVGcallRecord* curCalls;
+  int ccurCalls;
+  int damageValid;  // 0 to redraw everything
+  unsigned char* dirtyTiles;
+  int* damageTiles;
+  int ndamageTiles;
+  int* damageRects;
+  int ndamageRects;
+
+  // occlusion culling stats for last frame
+  int culledCalls, culledPixels;
+#ifdef NVG_FRAME_STATS
+  NVGframeStats stats;  // backend fields only
+#endif
+
+  // NVGSW_SDFGEN distance radius and mapping to 8-bit output
+  int sdfRadius;
+  float sdfScale, sdfOffset;
+
+  // glyph coverage cache - hash table of entries, doubly linked list in order of use (head is most recent)
+  struct SWNVGglyph* glyphs;
+  int nglyphs;
+  int cglyphs;
+  int freeGlyph;
+  int* glyphHash;
+  int nglyphHash;  // power of 2
+  int lruHead, lruTail;
+  size_t glyphBytes;
+  size_t maxGlyphBytes;
+  int frame;
+  int* quadGlyphs;  // cache entry for each atlas quad drawn this frame, or -1
+  int cquadGlyphs;
+  int* newGlyphs;  // entries to render this frame
+  int nnewGlyphs;
+  int cnewGlyphs;
+
+  // span blending kernels, chosen at nvgswCreate and for framebuffer format
+  swnvg__blendSpanFn blendSpan;
+  swnvg__blendSolidFn blendSolid;
+  swnvg__loadSpanFn loadSpan;
+  swnvg__storeSpanFn storeSpan;
+  swnvg__blendSpanPMFn blendSpanPM;
+  swnvg__blendSolidPMFn blendSolidPM;
+  swnvg__gradSpanFn gradBox;
+  swnvg__texSpanFn texSpan;
+  const char* kernelName;
 };
 typedef struct SWNVGcontext SWNVGcontext;
 
+static void swnvg__submit(SWNVGcontext* gl, taskFn_t fn, void* arg)
+{
+  if (gl->pool)
+    swnvg__poolSubmit(gl->pool, fn, arg);
+  else
+    gl->poolSubmit(fn, arg);
+}
+
+static void swnvg__wait(SWNVGcontext* gl)
+{
+  NVG_TRACE_BEGIN("poolWait", -1);
+  if (gl->pool)
+    swnvg__poolWait(gl->pool);
+  else
+    gl->poolWait();
+  NVG_TRACE_END("poolWait");
+}
+
 #define LINEAR_TO_SRGB_DIV 2047
 static rgba32_t sRGBToLinear[256];
-static unsigned char linearToSRGB[LINEAR_TO_SRGB_DIV + 1];
+static unsigned char linearToSRGB[LINEAR_TO_SRGB_DIV + 4];  // padding for 32-bit gather
 static float sRGBgamma = 2.31f;
 
 static void swnvg__sRGBLUTCalc()
@@ -184,45 +774,6 @@ static void swnvg__sRGBLUTCalc()
     linearToSRGB[i] = (unsigned char)(0.5f + powf(i/((float)LINEAR_TO_SRGB_DIV), 1/sRGBgamma)*255);
 }
 
-static SWNVGmemPage* swnvg__nextPage(SWNVGthreadCtx* r, SWNVGmemPage* cur)
-{
-  SWNVGmemPage *newp;
-  // If using existing chain, return the next page in chain
-  if (cur != NULL && cur->next != NULL) return cur->next;
-  // Alloc new page
-  newp = (SWNVGmemPage*)malloc(sizeof(SWNVGmemPage));
-  if (newp == NULL) return NULL;
-  memset(newp, 0, sizeof(SWNVGmemPage));
-  // Add to linked list
-  if (cur != NULL)
-    cur->next = newp;
-  else
-    r->pages = newp;
-  return newp;
-}
-
-static void swnvg__resetPool(SWNVGthreadCtx* r)
-{
-  SWNVGmemPage* p = r->pages;
-  while (p != NULL) {
-    p->size = 0;
-    p = p->next;
-  }
-  r->curpage = r->pages;
-}
-
-static unsigned char* swnvg__alloc(SWNVGthreadCtx* r, int size)
-{
-  unsigned char* buf;
-  if (size > SWNVG__MEMPAGE_SIZE) return NULL;
-  if (r->curpage == NULL || r->curpage->size+size > SWNVG__MEMPAGE_SIZE) {
-    r->curpage = swnvg__nextPage(r, r->curpage);
-  }
-  buf = &r->curpage->mem[r->curpage->size];
-  r->curpage->size += size;
-  return buf;
-}
-
 static void swnvg__addEdge(SWNVGcontext* r, NVGvertex* vtx)
 {
   SWNVGedge* e;
@@ -250,40 +801,59 @@ static void swnvg__addEdge(SWNVGcontext* r, NVGvertex* vtx)
   }
 }
 
-static SWNVGactiveEdge* swnvg__addActive(SWNVGthreadCtx* r, SWNVGedge* e, float startPoint)
+static int swnvg__growActive(SWNVGthreadCtx* r, int n)
 {
-   SWNVGactiveEdge* z;
+  int* x; int* dx; float* ey; int* dir;
+  int c = r->caet > 0 ? r->caet * 2 : 64;
+  if (n <= r->caet) return 1;
+  x = (int*)realloc(r->aetX, sizeof(int) * c);
+  if (x != NULL) r->aetX = x;
+  dx = (int*)realloc(r->aetDx, sizeof(int) * c);
+  if (dx != NULL) r->aetDx = dx;
+  ey = (float*)realloc(r->aetEy, sizeof(float) * c);
+  if (ey != NULL) r->aetEy = ey;
+  dir = (int*)realloc(r->aetDir, sizeof(int) * c);
+  if (dir != NULL) r->aetDir = dir;
+  if (x == NULL || dx == NULL || ey == NULL || dir == NULL) return 0;
+  r->caet = c;
+  return 1;
+}
 
-  if (r->freelist != NULL) {
-    // Restore from freelist.
-    z = r->freelist;
-    r->freelist = z->next;
-  } else {
-    // Alloc new edge.
-    z = (SWNVGactiveEdge*)swnvg__alloc(r, sizeof(SWNVGactiveEdge));
-    if (z == NULL) return NULL;
-  }
+// shift active edge at position i left to its sorted position in [0, i); equal x keeps existing order
+static void swnvg__sortActive(SWNVGthreadCtx* r, int i)
+{
+  int x = r->aetX[i], dx = r->aetDx[i], dir = r->aetDir[i];
+  float ey = r->aetEy[i];
+  if (i == 0 || r->aetX[i-1] <= x) return;
+  do {
+    r->aetX[i] = r->aetX[i-1];
+    r->aetDx[i] = r->aetDx[i-1];
+    r->aetEy[i] = r->aetEy[i-1];
+    r->aetDir[i] = r->aetDir[i-1];
+    --i;
+  } while (i > 0 && r->aetX[i-1] > x);
+  r->aetX[i] = x;
+  r->aetDx[i] = dx;
+  r->aetEy[i] = ey;
+  r->aetDir[i] = dir;
+}
 
+static int swnvg__addActive(SWNVGthreadCtx* r, SWNVGedge* e, float startPoint, int nsub)
+{
+  int i = r->naet;
   float dxdy = (e->x1 - e->x0) / (e->y1 - e->y0);
-//	STBTT_assert(e->y0 <= start_point);
+  if (!swnvg__growActive(r, i + 1)) return 0;
   // round dx down to avoid going too far
   if (dxdy < 0)
-    z->dx = (int)(-floorf(SWNVG__FIX * -dxdy));
+    r->aetDx[i] = (int)(-floorf(SWNVG__FIX * -dxdy)) * nsub;
   else
-    z->dx = (int)floorf(SWNVG__FIX * dxdy);
-  z->x = (int)floorf(SWNVG__FIX * (e->x0 + dxdy * (startPoint - e->y0)));
-//	z->x -= off_x * FIX;
-  z->ey = e->y1;
-  z->next = 0;
-  z->dir = e->dir;
-
-  return z;
-}
-
-static void swnvg__freeActive(SWNVGthreadCtx* r, SWNVGactiveEdge* z)
-{
-  z->next = r->freelist;
-  r->freelist = z;
+    r->aetDx[i] = (int)floorf(SWNVG__FIX * dxdy) * nsub;
+  r->aetX[i] = (int)floorf(SWNVG__FIX * (e->x0 + dxdy * (startPoint - e->y0)));
+  r->aetEy[i] = e->y1;
+  r->aetDir[i] = e->dir;
+  r->naet++;
+  swnvg__sortActive(r, i);
+  return 1;
 }
 
 static void swnvg__fillScanlineAA(unsigned char* scanline, int len, int x0, int x1, int i, int j)
@@ -331,19 +901,19 @@ static void swnvg__fillScanline(unsigned char* scanline, int len, int x0, int x1
   }
 }
 
-static void swnvg__fillActiveEdges(SWNVGthreadCtx* r, SWNVGactiveEdge* e, int* xmin, int* xmax, int flags)
+static void swnvg__fillActiveEdges(SWNVGthreadCtx* r, int* xmin, int* xmax, int flags)
 {
-  int x0 = 0, w = 0, left = r->x0, right = r->x1;
+  int k, x0 = 0, w = 0, left = r->x0, right = r->x1;
   unsigned char* scanline = r->scanline;
   int len = right - left + 1;
-  while (e != NULL) {
+  for (k = 0; k < r->naet; ++k) {
     if (w == 0) {
       // if we're currently at zero, we need to record the edge start point
-      x0 = e->x;
-      w = (flags & NVG_PATH_EVENODD) ? 1 : w + e->dir;
+      x0 = r->aetX[k];
+      w = (flags & NVG_PATH_EVENODD) ? 1 : w + r->aetDir[k];
     } else {
-      int x1 = e->x;
-      w = (flags & NVG_PATH_EVENODD) ? 0 : w + e->dir;
+      int x1 = r->aetX[k];
+      w = (flags & NVG_PATH_EVENODD) ? 0 : w + r->aetDir[k];
       // if we went to zero, we need to draw
       if (w == 0) {
         int i = x0 >> SWNVG__FIXSHIFT;
@@ -356,7 +926,16 @@ static void swnvg__fillActiveEdges(SWNVGthreadCtx* r, SWNVGactiveEdge* e, int* x
         }
       }
     }
-    e = e->next;
+  }
+  // edges to the right of tile are omitted, so close any open span at right edge of tile
+  if (w != 0) {
+    int i = x0 >> SWNVG__FIXSHIFT;
+    if (i <= right) {
+      if (i < *xmin) *xmin = i;
+      *xmax = right;
+      (flags & NVG_PATH_NO_AA) ? swnvg__fillScanline(scanline, len, x0, (right + 1) << SWNVG__FIXSHIFT, i - left, len)
+          : swnvg__fillScanlineAA(scanline, len, x0, (right + 1) << SWNVG__FIXSHIFT, i - left, len);
+    }
   }
 }
 
@@ -457,7 +1036,8 @@ static unsigned int swnvg__mix8(float fx, float fy, int t00, int t10, int t01, i
   return (unsigned int)(0.5f + t0 + fy*(t1 - t0));
 }
 
-static void swnvg__lerpAndBlend(unsigned char* dst, unsigned char cover, SWNVGtexture* tex, float ijx, float ijy, int linear)
+// bilinear texture fetch
+static rgba32_t swnvg__texLerpRGBA32(SWNVGtexture* tex, float ijx, float ijy)
 {
   ijx = swnvg__maxf(0.0f, ijx);  ijy = swnvg__maxf(0.0f, ijy);
   int ij00x = swnvg__mini((int)ijx, tex->width-1), ij00y = swnvg__mini((int)ijy, tex->height-1);
@@ -468,257 +1048,1724 @@ static void swnvg__lerpAndBlend(unsigned char* dst, unsigned char cover, SWNVGte
   rgba32_t t11 = texelFetchRGBA32(tex, ij11x, ij11y);
   float fx = ijx - (int)ijx, fy = ijy - (int)ijy;
 
-  int c0 = swnvg__mix8(fx, fy, COLOR0(t00), COLOR0(t10), COLOR0(t01), COLOR0(t11));
-  int c1 = swnvg__mix8(fx, fy, COLOR1(t00), COLOR1(t10), COLOR1(t01), COLOR1(t11));
-  int c2 = swnvg__mix8(fx, fy, COLOR2(t00), COLOR2(t10), COLOR2(t01), COLOR2(t11));
-  int c3 = swnvg__mix8(fx, fy, COLOR3(t00), COLOR3(t10), COLOR3(t01), COLOR3(t11));
-  swnvg__blend8888(dst, cover, c0, c1, c2, c3, linear);
+  unsigned int c0 = swnvg__mix8(fx, fy, COLOR0(t00), COLOR0(t10), COLOR0(t01), COLOR0(t11));
+  unsigned int c1 = swnvg__mix8(fx, fy, COLOR1(t00), COLOR1(t10), COLOR1(t01), COLOR1(t11));
+  unsigned int c2 = swnvg__mix8(fx, fy, COLOR2(t00), COLOR2(t10), COLOR2(t01), COLOR2(t11));
+  unsigned int c3 = swnvg__mix8(fx, fy, COLOR3(t00), COLOR3(t10), COLOR3(t01), COLOR3(t11));
+  return c0 | c1 << 8 | c2 << 16 | c3 << 24;
 }
 
-static int swnvg__getBlendFactor(int factor, int srca, int dsta)
+// mip level of texture (level 0 is texture itself)
+static rgba32_t* swnvg__mipLevel(SWNVGtexture* tex, int level, int* w, int* h)
 {
-  switch(factor) {
-    case NVG_ZERO:                return 0;
-    case NVG_ONE:                 return 255;
-    case NVG_SRC_ALPHA:           return srca;
-    case NVG_ONE_MINUS_SRC_ALPHA: return 255 - srca;
-    case NVG_DST_ALPHA:           return dsta;
-    case NVG_ONE_MINUS_DST_ALPHA: return 255 - dsta;
-    default:                      return -255;
-  }
+  *w = swnvg__maxi(tex->width >> level, 1);
+  *h = swnvg__maxi(tex->height >> level, 1);
+  return level > 0 ? tex->mips + tex->mipOffset[level] : (rgba32_t*)tex->data;
 }
 
-static void swnvg__blendWithFunc(NVGcompositeOperationState* op, unsigned char* dst, int cover, rgba32_t rgba, int linear)
+// per channel c0 + (c1 - c0)*t/256
+static rgba32_t swnvg__lerpRGBA32(rgba32_t c0, rgba32_t c1, int t)
 {
-  // TODO: support linear blending
-  int srca = (cover * COLOR3(rgba))/255;
-  int dsta = dst[3];
-  // get blend factors
-  int srcRGB = swnvg__getBlendFactor(op->srcRGB, srca, dsta);
-  int dstRGB = swnvg__getBlendFactor(op->dstRGB, srca, dsta);
-  int srcAlpha = swnvg__getBlendFactor(op->srcAlpha, srca, dsta);
-  int dstAlpha = swnvg__getBlendFactor(op->dstAlpha, srca, dsta);
-  // blend
-  int r = (srcRGB*COLOR0(rgba) + dstRGB*dst[0])/255;
-  int g = (srcRGB*COLOR1(rgba) + dstRGB*dst[1])/255;
-  int b = (srcRGB*COLOR2(rgba) + dstRGB*dst[2])/255;
-  int a = (srcAlpha*srca + dstAlpha*dst[3])/255;
-  // write
-  dst[0] = (unsigned char)r;
-  dst[1] = (unsigned char)g;
-  dst[2] = (unsigned char)b;
-  dst[3] = (unsigned char)a;
+  unsigned int r = (COLOR0(c0)*(256 - t) + COLOR0(c1)*t + 128) >> 8;
+  unsigned int g = (COLOR1(c0)*(256 - t) + COLOR1(c1)*t + 128) >> 8;
+  unsigned int b = (COLOR2(c0)*(256 - t) + COLOR2(c1)*t + 128) >> 8;
+  unsigned int a = (COLOR3(c0)*(256 - t) + COLOR3(c1)*t + 128) >> 8;
+  return r | g << 8 | b << 16 | a << 24;
 }
 
-static void swnvg__scanlineSolid(unsigned char* dst, int count, unsigned char* cover, int x, int y, SWNVGcall* call)
+// bilinear sampling for span of pixels: (qx,qy) is texel coord for first pixel, stepped by (dqx,dqy)
+static void swnvg__texSpanRef(rgba32_t* dst, const rgba32_t* img, int w, int h, float qx, float qy, float dqx, float dqy, int count)
 {
+  SWNVGtexture tex;
   int i;
-  int linear = call->flags & NVG_SRGB ? 1 : 0;
-  if(call->flags & NVG_PATH_SCISSOR) {
-    // apply scissor factor to coverage for non-trivial (i.e. rotated or skewed) scissor
-    float qx, qy, ssx, ssy, sscover;
-    for(i = 0; i < count; ++i) {
-      nvgTransformPoint(&qx, &qy, call->scissorMat, x + i, y);
-      ssx = 0.5f - (fabsf(qx) - call->scissorExt[0])*call->scissorScale[0];
-      ssy = 0.5f - (fabsf(qy) - call->scissorExt[1])*call->scissorScale[1];
-      sscover = swnvg__clampf(ssx, 0.0f, 1.0f) * swnvg__clampf(ssy, 0.0f, 1.0f);
-      cover[i] = (unsigned char)(cover[i] * sscover + 0.5f);
-    }
-  }
-  // note r,g,b may not actually be R,G,B (in particular, R and G could be switched)
-  if (call->type == SWNVG_PAINT_COLOR) {
-    rgba32_t c = call->innerCol;
-    if(call->flags & NVG_PATH_BLENDFUNC) {
-      for(i = 0; i < count; ++i, dst += 4)
-        swnvg__blendWithFunc(&call->blendFunc, dst, *cover++, c, linear);
-    }
-    else if(RGBA32_IS_OPAQUE(c)) {
-      for(i = 0; i < count; ++i, dst += 4)
-        swnvg__blendOpaque(dst, *cover++, c, linear);
-    }
-    else {
-      for(i = 0; i < count; ++i, dst += 4)
-        swnvg__blend(dst, *cover++, COLOR0(c), COLOR1(c), COLOR2(c), COLOR3(c), linear);
-    }
-  } else if (call->type == SWNVG_PAINT_IMAGE) {
-    rgba32_t* img = (rgba32_t*)call->tex->data;
-    float qx, qy;
-    float dqx = call->paintMat[0]*call->tex->width/call->extent[0];
-    float dqy = call->paintMat[1]*call->tex->height/call->extent[1];
-    nvgTransformPoint(&qx, &qy, call->paintMat, x, y);
-    // +/- 0.5 determined by experiment to match nanovg_gl
-    qx = (qx + 0.5f)*call->tex->width/call->extent[0] - 0.5f;
-    qy = (qy + 0.5f)*call->tex->height/call->extent[1] - 0.5f;
-    for (i = 0; i < count; ++i) {
-      int alpha = (*cover++ * COLOR3(call->innerCol))/255;
-      if(call->tex->flags & NVG_IMAGE_NEAREST) {
-        int imgx = swnvg__clampi((int)(0.5f + qx), 0, call->tex->width-1);
-        int imgy = swnvg__clampi((int)(0.5f + qy), 0, call->tex->height-1);
-        rgba32_t c = img[imgy*call->tex->width + imgx];
-        if(RGBA32_IS_OPAQUE(c))
-          swnvg__blendOpaque(dst, alpha, c, linear);
-        else
-          swnvg__blend(dst, alpha, COLOR0(c), COLOR1(c), COLOR2(c), COLOR3(c), linear);
-      }
-      else
-        swnvg__lerpAndBlend(dst, alpha, call->tex, qx, qy, linear);
-      qx += dqx;  // for qx,qy => qx+1,qy
-      qy += dqy;
-      dst += 4;
-    }
-  } else if (call->type == SWNVG_PAINT_GRAD) {
-    float qx, qy;
-    int cr0 = linear ? (int)sRGBToLinear[COLOR0(call->innerCol)] : COLOR0(call->innerCol);
-    int cg0 = linear ? (int)sRGBToLinear[COLOR1(call->innerCol)] : COLOR1(call->innerCol);
-    int cb0 = linear ? (int)sRGBToLinear[COLOR2(call->innerCol)] : COLOR2(call->innerCol);
-    int ca0 = COLOR3(call->innerCol);
-    int cr1 = linear ? (int)sRGBToLinear[COLOR0(call->outerCol)] : COLOR0(call->outerCol);
-    int cg1 = linear ? (int)sRGBToLinear[COLOR1(call->outerCol)] : COLOR1(call->outerCol);
-    int cb1 = linear ? (int)sRGBToLinear[COLOR2(call->outerCol)] : COLOR2(call->outerCol);
-    int ca1 = COLOR3(call->outerCol);
-    for (i = 0; i < count; ++i) {
-      // can't just step qx, qy due to numerical issues w/ linear gradient
-      nvgTransformPoint(&qx, &qy, call->paintMat, x++, y);
-      float dx = fabsf(qx) - (call->extent[0] - call->radius);
-      float dy = fabsf(qy) - (call->extent[1] - call->radius);
-      float d0 = swnvg__minf(swnvg__maxf(dx, dy), 0.0f)
-          + swnvg__lengthf(swnvg__maxf(dx, 0.0f), swnvg__maxf(dy, 0.0f)) - call->radius;
-      float d = (d0 + call->feather*0.5f)/call->feather;
-      if (call->tex) {
-        // texture for gradients with >2 stops
-        swnvg__lerpAndBlend(dst, *cover++, call->tex, d*call->tex->width, 0, linear);
-      } else {
-        d = swnvg__clampf(d, 0.0f, 1.0f);
-        int cr = (int)(0.5f + cr0*(1.0f - d) + cr1*d);
-        int cg = (int)(0.5f + cg0*(1.0f - d) + cg1*d);
-        int cb = (int)(0.5f + cb0*(1.0f - d) + cb1*d);
-        int ca = (int)(0.5f + ca0*(1.0f - d) + ca1*d);
-        if(linear)
-          swnvg__blend8888(dst, *cover++, linearToSRGB[cr], linearToSRGB[cg], linearToSRGB[cb], ca, linear);
-        else
-          swnvg__blend8888(dst, *cover++, cr, cg, cb, ca, linear);
-      }
-      //qx += call->paintMat[0];  // instead of tf*(x+1, y)
-      //qy += call->paintMat[1];
-      dst += 4;
-    }
-  }
+  tex.data = (void*)img;
+  tex.width = w;
+  tex.height = h;
+  for(i = 0; i < count; ++i, qx += dqx, qy += dqy)
+    dst[i] = swnvg__texLerpRGBA32(&tex, qx, qy);
 }
 
-static void swnvg__rasterizeSortedEdges(SWNVGthreadCtx* r, SWNVGcall* call)
+// span blending: scalar reference kernels; SIMD kernels must match these exactly.  Note that source alpha
+//  is always in byte 3 and that blend8888 writes the source color directly if srca == 255 - this matters for
+//  linear blending since linearToSRGB[sRGBToLinear[c]] != c in general
+static void swnvg__blendSpanRef(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
 {
-  SWNVGcontext* gl = r->context;
-  SWNVGactiveEdge *active = NULL;
-  int y, s;
-  int e = call->edgeOffset;
-  int eend = call->edgeOffset + call->edgeCount;
-  int xmin, xmax, xmin1, xmax1;
+  int i;
+  for(i = 0; i < count; ++i, dst += 4)
+    swnvg__blend8888(dst, cover[i], COLOR0(src[i]), COLOR1(src[i]), COLOR2(src[i]), COLOR3(src[i]), linear);
+}
 
-  for (y = swnvg__maxi(r->y0, call->bounds[1]); y <= swnvg__mini(r->y1, call->bounds[3]); y++) {
-    xmin = gl->width;
-    xmax = 0;
-    for (s = 0; s < SWNVG__SUBSAMPLES; ++s) {
-      // we only process one subsample scanline for non-AA
-      if((call->flags & NVG_PATH_NO_AA) && s != SWNVG__SUBSAMPLES/2)
-        continue;
-      // find center of pixel for this scanline
-      float scany = (float)(y*SWNVG__SUBSAMPLES + s) + 0.5f;
-      SWNVGactiveEdge **step = &active;
-
-      // update active edges - remove active edges that terminate before the center of this scanline
-      while (*step) {
-        SWNVGactiveEdge *z = *step;
-        if (z->ey <= scany) {
-          *step = z->next; // delete from list
-          swnvg__freeActive(r, z);
-        } else {
-          z->x += z->dx; // advance to position for current scanline
-          step = &((*step)->next); // advance through list
-        }
-      }
-      // resort the list if needed
-      for (;;) {
-        int changed = 0;
-        step = &active;
-        while (*step && (*step)->next) {
-          if ((*step)->x > (*step)->next->x) {
-            SWNVGactiveEdge* t = *step;
-            SWNVGactiveEdge* q = t->next;
-            t->next = q->next;
-            q->next = t;
-            *step = q;
-            changed = 1;
-          }
-          step = &(*step)->next;
-        }
-        if (!changed) break;
-      }
-      // insert all edges that start before the center of this scanline -- omit ones that also end on this scanline
-      while (e < eend && gl->edges[e].y0 <= scany) {
-        if (gl->edges[e].y1 > scany) {
-          SWNVGactiveEdge* z = swnvg__addActive(r, &gl->edges[e], scany);
-          if (z == NULL) break;
-          if (call->flags & NVG_PATH_NO_AA)
-            z->dx *= SWNVG__SUBSAMPLES;  // AA case uses per-subscanline step
-          // find insertion point
-          if (active == NULL) {
-            active = z;
-          } else if (z->x < active->x) {
-            // insert at front
-            z->next = active;
-            active = z;
-          } else {
-            // find thing to insert AFTER
-            SWNVGactiveEdge* p = active;
-            while (p->next && p->next->x < z->x)
-              p = p->next;
-            // at this point, p->next->x is NOT < z->x
-            z->next = p->next;
-            p->next = z;
-          }
-        }
-        e++;
-      }
-      // now process all active edges in non-zero fashion
-      if (active != NULL)
-        swnvg__fillActiveEdges(r, active, &xmin, &xmax, call->flags);
-    }
-    // clip xmin, xmax for memset
-    xmin = swnvg__maxi(xmin, r->x0);
-    xmax = swnvg__mini(xmax, r->x1);
-    // further clip for possible scissor
-    xmin1 = swnvg__maxi(xmin, call->bounds[0]);
-    xmax1 = swnvg__mini(xmax, call->bounds[2]);
-    if (xmin1 <= xmax1)
-      swnvg__scanlineSolid(&gl->bitmap[y*gl->stride + xmin1*4], xmax1-xmin1+1, &r->scanline[xmin1 - r->x0], xmin1, y, call);
-    // we fill x range clipped to scissor, but we have to clear entire range written by fillActiveEdges
-    if (xmin <= xmax)
-      memset(&r->scanline[xmin - r->x0], 0, xmax-xmin+1);
+static void swnvg__blendSolidRef(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i;
+  if(RGBA32_IS_OPAQUE(c)) {
+    for(i = 0; i < count; ++i, dst += 4)
+      swnvg__blendOpaque(dst, cover[i], c, linear);
+  }
+  else {
+    for(i = 0; i < count; ++i, dst += 4)
+      swnvg__blend(dst, cover[i], COLOR0(c), COLOR1(c), COLOR2(c), COLOR3(c), linear);
   }
 }
 
-static float texFetchF32(SWNVGtexture* tex, int x, int y)
+// premultiplied blending (NVGSW_PREMULTIPLIED) reference kernels: source is scaled by coverage, then each
+//  channel is min(255, (src*fsrc + dst*fdst)/255); pixels w/ zero coverage are left untouched, like fragments
+//  outside a path w/ GL
+static void swnvg__blendPM(unsigned char* dst, int cover, rgba32_t c, const SWNVGblend* b)
 {
-  float* data = (float*)tex->data;
-  return data[x + y*tex->width];
+  int k, s[4], dsta = dst[3];
+  for(k = 0; k < 4; ++k)
+    s[k] = (cover*((c >> 8*k) & 0xff))/255;
+  for(k = 0; k < 4; ++k) {
+    int j = k < 3 ? 0 : 2;  // RGB or alpha factors
+    int fs = b->k0[j] + b->ks[j]*s[3] + b->kd[j]*dsta;
+    int fd = b->k0[j+1] + b->ks[j+1]*s[3] + b->kd[j+1]*dsta;
+    dst[k] = (unsigned char)swnvg__mini((s[k]*fs + dst[k]*fd)/255, 255);
+  }
 }
 
-static float texFetchF32Lerp(SWNVGtexture* tex, float ijx, float ijy, int ijminx, int ijminy, int ijmaxx, int ijmaxy)
+// factor f for channel k w/ (premultiplied) source s and dest d
+static int swnvg__blendFactorPM(int f, int k, const int* s, const int* d)
 {
-  int ij00x = swnvg__clampi((int)ijx, ijminx, ijmaxx), ij00y = swnvg__clampi((int)ijy, ijminy, ijmaxy);
-  int ij11x = swnvg__clampi((int)ijx + 1, ijminx, ijmaxx), ij11y = swnvg__clampi((int)ijy + 1, ijminy, ijmaxy);
-  float t00 = texFetchF32(tex, ij00x, ij00y);
-  float t10 = texFetchF32(tex, ij11x, ij00y);
-  float t01 = texFetchF32(tex, ij00x, ij11y);
-  float t11 = texFetchF32(tex, ij11x, ij11y);
-  float fx = ijx - (int)ijx, fy = ijy - (int)ijy;
-  //return mix(mix(t00, t10, f.x), mix(t01, t11, f.x), f.y);
-  float t0 = t00 + fx*(t10 - t00);
-  float t1 = t01 + fx*(t11 - t01);
-  return t0 + fy*(t1 - t0);
+  switch(f) {
+    case NVG_ONE:                 return 255;
+    case NVG_SRC_COLOR:           return s[k];
+    case NVG_ONE_MINUS_SRC_COLOR: return 255 - s[k];
+    case NVG_DST_COLOR:           return d[k];
+    case NVG_ONE_MINUS_DST_COLOR: return 255 - d[k];
+    case NVG_SRC_ALPHA:           return s[3];
+    case NVG_ONE_MINUS_SRC_ALPHA: return 255 - s[3];
+    case NVG_DST_ALPHA:           return d[3];
+    case NVG_ONE_MINUS_DST_ALPHA: return 255 - d[3];
+    case NVG_SRC_ALPHA_SATURATE:  return k < 3 ? swnvg__mini(s[3], 255 - d[3]) : 255;
+    default:                      return 0;
+  }
 }
 
-// recall that we do clamping instead of just adding a border around each glyph because dx,dy could be large
+// premultiplied blending w/ factors evaluated for each pixel and channel, for composite ops w/ perPixel set
+static void swnvg__blendPMFunc(unsigned char* dst, int cover, rgba32_t c, const NVGcompositeOperationState* op)
+{
+  int k, s[4], d[4];
+  for(k = 0; k < 4; ++k) {
+    s[k] = (cover*((c >> 8*k) & 0xff))/255;
+    d[k] = dst[k];
+  }
+  for(k = 0; k < 4; ++k) {
+    int fs = swnvg__blendFactorPM(k < 3 ? op->srcRGB : op->srcAlpha, k, s, d);
+    int fd = swnvg__blendFactorPM(k < 3 ? op->dstRGB : op->dstAlpha, k, s, d);
+    dst[k] = (unsigned char)swnvg__mini((s[k]*fs + d[k]*fd)/255, 255);
+  }
+}
+
+static void swnvg__blendSpanPMRef(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i;
+  for(i = 0; i < count; ++i, dst += 4) {
+    if(cover[i] != 0)
+      swnvg__blendPM(dst, cover[i], src[i], b);
+  }
+}
+
+static void swnvg__blendSolidPMRef(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i, copy = b->srcOver && RGBA32_IS_OPAQUE(c);
+  for(i = 0; i < count; ++i, dst += 4) {
+    if(cover[i] == 255 && copy)
+      memcpy(dst, &c, 4);
+    else if(cover[i] != 0)
+      swnvg__blendPM(dst, cover[i], c, b);
+  }
+}
+
+// box and radial gradients: signed distance to rounded rect, scaled by feather; paint point is calculated
+//  for each pixel exactly as nvgTransformPoint would so that results don't depend on span start
+static void swnvg__gradBoxRef(float* d, const SWNVGcall* call, int x, int y, int count)
+{
+  const float* m = call->paintMat;
+  float ex = call->extent[0] - call->radius, ey = call->extent[1] - call->radius;
+  float cx = y*m[2], cy = y*m[3];
+  int i;
+  for(i = 0; i < count; ++i) {
+    float dx = fabsf(((x + i)*m[0] + cx) + m[4]) - ex;
+    float dy = fabsf(((x + i)*m[1] + cy) + m[5]) - ey;
+    float d0 = swnvg__minf(swnvg__maxf(dx, dy), 0.0f)
+        + swnvg__lengthf(swnvg__maxf(dx, 0.0f), swnvg__maxf(dy, 0.0f)) - call->radius;
+    d[i] = (d0 + call->feather*0.5f)/call->feather;
+  }
+}
+
+// linear gradient parameter is affine in x, so we can step it; steps start from x at multiples of
+//  SWNVG__GRAD_ANCHOR so that results don't depend on span start
+static void swnvg__gradLinear(float* d, const SWNVGcall* call, int x, int y, int count)
+{
+  const float* g = call->gradLinear;
+  int i = 0, ix, ax = x - x % SWNVG__GRAD_ANCHOR;
+  for(; i < count; ax += SWNVG__GRAD_ANCHOR) {
+    float t = g[0]*ax + g[1]*y + g[2];
+    for(ix = ax; ix < x + i; ++ix)  // only for first anchor if x isn't aligned
+      t += g[0];
+    for(; ix < ax + SWNVG__GRAD_ANCHOR && i < count; ++ix, ++i, t += g[0])
+      d[i] = t;
+  }
+}
+
+// kernels for framebuffer formats other than 32-bit: pixels are expanded to 8888 and blended as for 32-bit (so
+//  RGB565 and A8 output match RGBA8 output reduced to those formats); pixels w/ zero coverage are not touched
+static void swnvg__unpack565(unsigned int p, unsigned char* d)
+{
+  unsigned int r = p >> 11, g = (p >> 5) & 0x3f, b = p & 0x1f;
+  d[0] = (unsigned char)(r << 3 | r >> 2);
+  d[1] = (unsigned char)(g << 2 | g >> 4);
+  d[2] = (unsigned char)(b << 3 | b >> 2);
+  d[3] = 255;
+}
+
+static unsigned short swnvg__pack565(const unsigned char* s)
+{
+  return (unsigned short)(((s[0]*31 + 127)/255) << 11 | ((s[1]*63 + 127)/255) << 5 | (s[2]*31 + 127)/255);
+}
+
+static void swnvg__blendSpan565(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i;
+  unsigned short* d = (unsigned short*)dst;
+  unsigned char px[4];
+  for(i = 0; i < count; ++i) {
+    if(cover[i] == 0) continue;
+    swnvg__unpack565(d[i], px);
+    swnvg__blend8888(px, cover[i], COLOR0(src[i]), COLOR1(src[i]), COLOR2(src[i]), COLOR3(src[i]), linear);
+    d[i] = swnvg__pack565(px);
+  }
+}
+
+static void swnvg__blendSolid565(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i, opaque = RGBA32_IS_OPAQUE(c);
+  unsigned short* d = (unsigned short*)dst;
+  unsigned char px[4] = {COLOR0(c), COLOR1(c), COLOR2(c), 255};
+  unsigned short p = swnvg__pack565(px);
+  for(i = 0; i < count; ++i) {
+    if(cover[i] == 255 && opaque)
+      d[i] = p;
+    else if(cover[i] != 0) {
+      swnvg__unpack565(d[i], px);
+      swnvg__blend(px, cover[i], COLOR0(c), COLOR1(c), COLOR2(c), COLOR3(c), linear);
+      d[i] = swnvg__pack565(px);
+    }
+  }
+}
+
+static void swnvg__load565(rgba32_t* dst, const unsigned char* src, int count, int linear)
+{
+  int i;
+  for(i = 0; i < count; ++i)
+    swnvg__unpack565(((const unsigned short*)src)[i], (unsigned char*)&dst[i]);
+}
+
+static void swnvg__store565(unsigned char* dst, const rgba32_t* src, int count, int linear)
+{
+  int i;
+  for(i = 0; i < count; ++i)
+    ((unsigned short*)dst)[i] = swnvg__pack565((const unsigned char*)&src[i]);
+}
+
+static void swnvg__blendSpanA8(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i;
+  for(i = 0; i < count; ++i) {
+    int srca = (cover[i] * COLOR3(src[i]))/255;
+    dst[i] = (unsigned char)(srca + ((255 - srca)*(unsigned int)dst[i])/255);
+  }
+}
+
+static void swnvg__blendSolidA8(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i, ca = COLOR3(c);
+  for(i = 0; i < count; ++i) {
+    int srca = (cover[i] * ca)/255;
+    dst[i] = (unsigned char)(srca + ((255 - srca)*(unsigned int)dst[i])/255);
+  }
+}
+
+static void swnvg__loadA8(rgba32_t* dst, const unsigned char* src, int count, int linear)
+{
+  int i;
+  for(i = 0; i < count; ++i)
+    dst[i] = (rgba32_t)src[i] << 24;
+}
+
+static void swnvg__storeA8(unsigned char* dst, const rgba32_t* src, int count, int linear)
+{
+  int i;
+  for(i = 0; i < count; ++i)
+    dst[i] = COLOR3(src[i]);
+}
+
+// IEEE half float conversion (round to nearest even)
+static float swnvg__halfToFloat(unsigned short h)
+{
+  unsigned int u = (h & 0x7fffu) << 13, e = u & (0x7c00u << 13);
+  float f;
+  u += (127 - 15) << 23;
+  if(e == 0x7c00u << 13)
+    u += (128 - 16) << 23;  // inf/nan
+  else if(e == 0) {
+    u += 1 << 23;  // zero/subnormal
+    memcpy(&f, &u, 4);
+    f -= 6.103515625e-05f;  // 2^-14
+    memcpy(&u, &f, 4);
+  }
+  u |= (h & 0x8000u) << 16;
+  memcpy(&f, &u, 4);
+  return f;
+}
+
+static unsigned short swnvg__floatToHalf(float f)
+{
+  unsigned int u, sign;
+  memcpy(&u, &f, 4);
+  sign = (u >> 16) & 0x8000u;
+  u &= 0x7fffffffu;
+  if(u >= (127 + 16) << 23)
+    return (unsigned short)(sign | (u > 0x7f800000u ? 0x7e00u : 0x7c00u));  // overflow to inf or nan
+  if(u < (127 - 14) << 23) {
+    // subnormal: adding 0.5 puts half mantissa in low bits of float mantissa, with rounding done by FPU
+    memcpy(&f, &u, 4);
+    f += 0.5f;
+    memcpy(&u, &f, 4);
+    return (unsigned short)(sign | (u - 0x3f000000u));
+  }
+  u += 0xc8000fffu + ((u >> 13) & 1);  // rebias exponent and round mantissa
+  return (unsigned short)(sign | (u >> 13));
+}
+
+// premultiplied source over for one RGBA16F pixel; with linear, color is converted to linear and left that way
+static void swnvg__blend16F(unsigned short* d, int cover, rgba32_t c, int linear)
+{
+  float sa = (cover * COLOR3(c))*(1.0f/(255*255)), ia = 1.0f - sa;
+  float k = linear ? sa/LINEAR_TO_SRGB_DIV : sa/255;
+  float r = (linear ? sRGBToLinear[COLOR0(c)] : COLOR0(c))*k;
+  float g = (linear ? sRGBToLinear[COLOR1(c)] : COLOR1(c))*k;
+  float b = (linear ? sRGBToLinear[COLOR2(c)] : COLOR2(c))*k;
+  d[0] = swnvg__floatToHalf(r + ia*swnvg__halfToFloat(d[0]));
+  d[1] = swnvg__floatToHalf(g + ia*swnvg__halfToFloat(d[1]));
+  d[2] = swnvg__floatToHalf(b + ia*swnvg__halfToFloat(d[2]));
+  d[3] = swnvg__floatToHalf(sa + ia*swnvg__halfToFloat(d[3]));
+}
+
+static void swnvg__blendSpan16F(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i;
+  unsigned short* d = (unsigned short*)dst;
+  for(i = 0; i < count; ++i, d += 4) {
+    if(cover[i] != 0)
+      swnvg__blend16F(d, cover[i], src[i], linear);
+  }
+}
+
+static void swnvg__blendSolid16F(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i, opaque = RGBA32_IS_OPAQUE(c);
+  unsigned short* d = (unsigned short*)dst;
+  unsigned short p[4] = {0, 0, 0, 0};
+  swnvg__blend16F(p, 255, c, linear);
+  for(i = 0; i < count; ++i, d += 4) {
+    if(cover[i] == 255 && opaque)
+      memcpy(d, p, sizeof(p));
+    else if(cover[i] != 0)
+      swnvg__blend16F(d, cover[i], c, linear);
+  }
+}
+
+// for composite operations, which blend 8-bit (sRGB encoded) values
+static void swnvg__load16F(rgba32_t* dst, const unsigned char* src, int count, int linear)
+{
+  int i, j;
+  const unsigned short* s = (const unsigned short*)src;
+  for(i = 0; i < count; ++i, s += 4) {
+    dst[i] = 0;
+    for(j = 0; j < 4; ++j) {
+      float v = swnvg__clampf(swnvg__halfToFloat(s[j]), 0.0f, 1.0f);
+      unsigned int c = linear && j < 3 ? linearToSRGB[(int)(v*LINEAR_TO_SRGB_DIV + 0.5f)] : (unsigned int)(v*255 + 0.5f);
+      dst[i] |= c << 8*j;
+    }
+  }
+}
+
+static void swnvg__store16F(unsigned char* dst, const rgba32_t* src, int count, int linear)
+{
+  int i, j;
+  unsigned short* d = (unsigned short*)dst;
+  for(i = 0; i < count; ++i, d += 4) {
+    for(j = 0; j < 4; ++j) {
+      unsigned int c = (src[i] >> 8*j) & 0xff;
+      d[j] = swnvg__floatToHalf(linear && j < 3 ? sRGBToLinear[c]*(1.0f/LINEAR_TO_SRGB_DIV) : c*(1.0f/255));
+    }
+  }
+}
+
+#ifdef SWNVG__SSE2
+// x/255 for 0 <= x <= 255*255 (exact)
+static __m128i swnvg__div255SSE2(__m128i x)
+{
+  x = _mm_add_epi16(x, _mm_add_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(1)));
+  return _mm_srli_epi16(x, 8);
+}
+
+// blend 2 pixels unpacked to 16 bits per channel; c is coverage broadcast to each channel
+static __m128i swnvg__blend2SSE2(__m128i d, __m128i s, __m128i c)
+{
+  __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+  __m128i srca = swnvg__div255SSE2(_mm_mullo_epi16(c, a));
+  __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), srca);
+  // a = srca + ia*da/255 = (255*srca + ia*da)/255, so just replace source alpha with 255
+  s = _mm_or_si128(s, _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+  return swnvg__div255SSE2(_mm_add_epi16(_mm_mullo_epi16(srca, s), _mm_mullo_epi16(ia, d)));
+}
+
+// blend 4 pixels (non-linear)
+static __m128i swnvg__blend4SSE2(__m128i d, __m128i s, const unsigned char* cover)
+{
+  __m128i z = _mm_setzero_si128();
+  int c4;
+  memcpy(&c4, cover, 4);
+  __m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(c4), z);
+  c = _mm_unpacklo_epi16(c, c);
+  __m128i lo = swnvg__blend2SSE2(_mm_unpacklo_epi8(d, z), _mm_unpacklo_epi8(s, z), _mm_unpacklo_epi32(c, c));
+  __m128i hi = swnvg__blend2SSE2(_mm_unpackhi_epi8(d, z), _mm_unpackhi_epi8(s, z), _mm_unpackhi_epi32(c, c));
+  return _mm_packus_epi16(lo, hi);
+}
+
+// linear blending needs table lookups, so only the arithmetic is vectorized; integer division is done in
+//  float, which is exact for numerators < 2^21
+static __m128 swnvg__div255fSSE2(__m128 x)
+{
+  return _mm_mul_ps(_mm_add_ps(x, _mm_set1_ps(0.5f)), _mm_set1_ps(1.0f/255.0f));
+}
+
+static void swnvg__blendLinear4SSE2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover)
+{
+  int i, k;
+  int out[4][4];
+  float sa[4], ch[2][3][4];
+  for(i = 0; i < 4; ++i) {
+    sa[i] = (float)(cover[i]*COLOR3(src[i]));
+    for(k = 0; k < 3; ++k) {
+      ch[0][k][i] = (float)sRGBToLinear[(src[i] >> 8*k) & 0xff];
+      ch[1][k][i] = (float)sRGBToLinear[dst[4*i + k]];
+    }
+  }
+  __m128 srca = _mm_cvtepi32_ps(_mm_cvttps_epi32(swnvg__div255fSSE2(_mm_loadu_ps(sa))));
+  __m128 ia = _mm_sub_ps(_mm_set1_ps(255.0f), srca);
+  for(k = 0; k < 3; ++k) {
+    __m128 x = _mm_add_ps(_mm_mul_ps(srca, _mm_loadu_ps(ch[0][k])), _mm_mul_ps(ia, _mm_loadu_ps(ch[1][k])));
+    _mm_storeu_si128((__m128i*)out[k], _mm_cvttps_epi32(swnvg__div255fSSE2(x)));
+  }
+  __m128 da = _mm_setr_ps(dst[3], dst[7], dst[11], dst[15]);
+  __m128 a = _mm_add_ps(srca, _mm_cvtepi32_ps(_mm_cvttps_epi32(swnvg__div255fSSE2(_mm_mul_ps(ia, da)))));
+  _mm_storeu_si128((__m128i*)out[3], _mm_cvttps_epi32(a));
+  for(i = 0; i < 4; ++i, dst += 4) {
+    if(cover[i] == 255 && COLOR3(src[i]) == 255)
+      memcpy(dst, &src[i], 4);
+    else {
+      dst[0] = linearToSRGB[out[0][i]];
+      dst[1] = linearToSRGB[out[1][i]];
+      dst[2] = linearToSRGB[out[2][i]];
+      dst[3] = (unsigned char)out[3][i];
+    }
+  }
+}
+
+static void swnvg__blendSpanSSE2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  if(linear) {
+    for(; i + 4 <= count; i += 4)
+      swnvg__blendLinear4SSE2(dst + 4*i, src + i, cover + i);
+  }
+  else {
+    for(; i + 4 <= count; i += 4) {
+      __m128i d = _mm_loadu_si128((__m128i*)(dst + 4*i));
+      __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+      _mm_storeu_si128((__m128i*)(dst + 4*i), swnvg__blend4SSE2(d, s, cover + i));
+    }
+  }
+  swnvg__blendSpanRef(dst + 4*i, src + i, cover + i, count - i, linear);
+}
+
+static void swnvg__blendSolidSSE2(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0, c4;
+  int opaque = RGBA32_IS_OPAQUE(c);
+  rgba32_t src[4] = {c, c, c, c};
+  __m128i s = _mm_set1_epi32((int)c);
+  for(; i + 4 <= count; i += 4) {
+    memcpy(&c4, cover + i, 4);
+    if(opaque && c4 == -1)  // solid runs are common, so skip blending for fully covered pixels
+      _mm_storeu_si128((__m128i*)(dst + 4*i), s);
+    else if(linear)
+      swnvg__blendLinear4SSE2(dst + 4*i, src, cover + i);
+    else
+      _mm_storeu_si128((__m128i*)(dst + 4*i), swnvg__blend4SSE2(_mm_loadu_si128((__m128i*)(dst + 4*i)), s, cover + i));
+  }
+  swnvg__blendSolidRef(dst + 4*i, c, cover + i, count - i, linear);
+}
+
+// x/255 for any 16-bit x (exact)
+static __m128i swnvg__div255wSSE2(__m128i x)
+{
+  return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16((short)0x8081)), 7);
+}
+
+// blend factor k0 +/- srca or dsta w/o multiplies: k[1], k[2] select srca, dsta and k[3] negates
+static __m128i swnvg__blendFactorSSE2(__m128i sa, __m128i da, const __m128i* k)
+{
+  __m128i x = _mm_xor_si128(_mm_or_si128(_mm_and_si128(k[1], sa), _mm_and_si128(k[2], da)), k[3]);
+  return _mm_sub_epi16(_mm_add_epi16(k[0], x), k[3]);
+}
+
+// premultiplied blending of 2 pixels unpacked to 16 bits per channel; c is coverage broadcast to each channel and
+//  k holds masks for src factor then dst factor (see swnvg__blendFactorSSE2) w/ alpha factor in lanes 3 and 7
+static __m128i swnvg__blendPM2SSE2(__m128i d, __m128i s, __m128i c, const __m128i* k)
+{
+  s = swnvg__div255SSE2(_mm_mullo_epi16(s, c));
+  __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+  __m128i da = _mm_shufflehi_epi16(_mm_shufflelo_epi16(d, 0xFF), 0xFF);
+  __m128i fs = swnvg__blendFactorSSE2(sa, da, k);
+  __m128i fd = swnvg__blendFactorSSE2(sa, da, k + 4);
+  // saturating sum still gives result > 255 on overflow
+  __m128i x = swnvg__div255wSSE2(_mm_adds_epu16(_mm_mullo_epi16(s, fs), _mm_mullo_epi16(d, fd)));
+  __m128i skip = _mm_cmpeq_epi16(c, _mm_setzero_si128());
+  return _mm_or_si128(_mm_and_si128(skip, d), _mm_andnot_si128(skip, x));
+}
+
+// source over reduces to s*c + d*(1 - srca) (no masking needed since c == 0 leaves d unchanged)
+static __m128i swnvg__srcOverPM2SSE2(__m128i d, __m128i s, __m128i c)
+{
+  s = swnvg__div255SSE2(_mm_mullo_epi16(s, c));
+  __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF));
+  return _mm_add_epi16(s, swnvg__div255SSE2(_mm_mullo_epi16(d, ia)));
+}
+
+// k == NULL for source over
+static __m128i swnvg__blendPM4SSE2(__m128i d, __m128i s, const unsigned char* cover, const __m128i* k)
+{
+  __m128i z = _mm_setzero_si128();
+  int c4;
+  memcpy(&c4, cover, 4);
+  __m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(c4), z);
+  c = _mm_unpacklo_epi16(c, c);
+  __m128i dlo = _mm_unpacklo_epi8(d, z), dhi = _mm_unpackhi_epi8(d, z);
+  __m128i slo = _mm_unpacklo_epi8(s, z), shi = _mm_unpackhi_epi8(s, z);
+  if(!k)
+    return _mm_packus_epi16(swnvg__srcOverPM2SSE2(dlo, slo, _mm_unpacklo_epi32(c, c)),
+        swnvg__srcOverPM2SSE2(dhi, shi, _mm_unpackhi_epi32(c, c)));
+  __m128i lo = swnvg__blendPM2SSE2(dlo, slo, _mm_unpacklo_epi32(c, c), k);
+  __m128i hi = swnvg__blendPM2SSE2(dhi, shi, _mm_unpackhi_epi32(c, c), k);
+  return _mm_packus_epi16(lo, hi);  // saturates sums > 255
+}
+
+#define SWNVG__FACTOR_LANES(f, a) _mm_set_epi16(f(a+2), f(a), f(a), f(a), f(a+2), f(a), f(a), f(a))
+#define SWNVG__K0(i) b->k0[i]
+#define SWNVG__SMASK(i) -(b->ks[i] != 0)
+#define SWNVG__DMASK(i) -(b->kd[i] != 0)
+#define SWNVG__NEG(i) -(b->ks[i] < 0 || b->kd[i] < 0)
+
+// masks for src (k[0..3]) and dst (k[4..7]) factors; returns NULL for source over, which has a faster path
+static const __m128i* swnvg__blendFactorsSSE2(const SWNVGblend* b, __m128i* k)
+{
+  int i;
+  if(b->srcOver) return NULL;
+  for(i = 0; i < 2; ++i) {
+    k[4*i] = SWNVG__FACTOR_LANES(SWNVG__K0, i);
+    k[4*i+1] = SWNVG__FACTOR_LANES(SWNVG__SMASK, i);
+    k[4*i+2] = SWNVG__FACTOR_LANES(SWNVG__DMASK, i);
+    k[4*i+3] = SWNVG__FACTOR_LANES(SWNVG__NEG, i);
+  }
+  return k;
+}
+
+#undef SWNVG__FACTOR_LANES
+#undef SWNVG__K0
+#undef SWNVG__SMASK
+#undef SWNVG__DMASK
+#undef SWNVG__NEG
+
+static void swnvg__blendSpanPMSSE2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i = 0;
+  __m128i kbuf[8];
+  const __m128i* k = swnvg__blendFactorsSSE2(b, kbuf);
+  for(; i + 4 <= count; i += 4) {
+    __m128i d = _mm_loadu_si128((__m128i*)(dst + 4*i));
+    __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+    _mm_storeu_si128((__m128i*)(dst + 4*i), swnvg__blendPM4SSE2(d, s, cover + i, k));
+  }
+  swnvg__blendSpanPMRef(dst + 4*i, src + i, cover + i, count - i, b);
+}
+
+static void swnvg__blendSolidPMSSE2(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i = 0, c4;
+  int copy = b->srcOver && RGBA32_IS_OPAQUE(c);
+  __m128i s = _mm_set1_epi32((int)c);
+  __m128i kbuf[8];
+  const __m128i* k = swnvg__blendFactorsSSE2(b, kbuf);
+  for(; i + 4 <= count; i += 4) {
+    memcpy(&c4, cover + i, 4);
+    if(c4 == 0) continue;
+    if(copy && c4 == -1)
+      _mm_storeu_si128((__m128i*)(dst + 4*i), s);
+    else
+      _mm_storeu_si128((__m128i*)(dst + 4*i), swnvg__blendPM4SSE2(_mm_loadu_si128((__m128i*)(dst + 4*i)), s, cover + i, k));
+  }
+  swnvg__blendSolidPMRef(dst + 4*i, c, cover + i, count - i, b);
+}
+
+// must match swnvg__gradBoxRef exactly
+static void swnvg__gradBoxSSE2(float* d, const SWNVGcall* call, int x, int y, int count)
+{
+  const float* m = call->paintMat;
+  __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 zero = _mm_setzero_ps();
+  __m128 ex = _mm_set1_ps(call->extent[0] - call->radius), ey = _mm_set1_ps(call->extent[1] - call->radius);
+  __m128 cx = _mm_set1_ps(y*m[2]), cy = _mm_set1_ps(y*m[3]);
+  __m128 tx = _mm_set1_ps(m[4]), ty = _mm_set1_ps(m[5]);
+  __m128 mx = _mm_set1_ps(m[0]), my = _mm_set1_ps(m[1]);
+  __m128 rad = _mm_set1_ps(call->radius);
+  __m128 hf = _mm_set1_ps(call->feather*0.5f), f = _mm_set1_ps(call->feather);
+  int i = 0;
+  for(; i + 4 <= count; i += 4) {
+    __m128 fx = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x + i), _mm_setr_epi32(0, 1, 2, 3)));
+    __m128 dx = _mm_sub_ps(_mm_and_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, mx), cx), tx), absmask), ex);
+    __m128 dy = _mm_sub_ps(_mm_and_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, my), cy), ty), absmask), ey);
+    __m128 px = _mm_max_ps(dx, zero), py = _mm_max_ps(dy, zero);
+    __m128 d0 = _mm_add_ps(_mm_min_ps(_mm_max_ps(dx, dy), zero), _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py))));
+    _mm_storeu_ps(d + i, _mm_div_ps(_mm_add_ps(_mm_sub_ps(d0, rad), hf), f));
+  }
+  swnvg__gradBoxRef(d + i, call, x + i, y, count - i);
+}
+
+// must match swnvg__texSpanRef exactly - all 4 channels of a pixel are interpolated at once
+static void swnvg__texSpanSSE2(rgba32_t* dst, const rgba32_t* img, int w, int h, float qx, float qy, float dqx, float dqy, int count)
+{
+  __m128i z = _mm_setzero_si128();
+  __m128 half = _mm_set1_ps(0.5f);
+  int i;
+  for(i = 0; i < count; ++i, qx += dqx, qy += dqy) {
+    float ijx = swnvg__maxf(0.0f, qx), ijy = swnvg__maxf(0.0f, qy);
+    int x0 = swnvg__mini((int)ijx, w-1), y0 = swnvg__mini((int)ijy, h-1);
+    int x1 = swnvg__mini((int)ijx + 1, w-1), y1 = swnvg__mini((int)ijy + 1, h-1);
+    __m128 fx = _mm_set1_ps(ijx - (int)ijx), fy = _mm_set1_ps(ijy - (int)ijy);
+    __m128i r0 = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128(img[y0*w + x0]), _mm_cvtsi32_si128(img[y0*w + x1])), z);
+    __m128i r1 = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128(img[y1*w + x0]), _mm_cvtsi32_si128(img[y1*w + x1])), z);
+    __m128 t00 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(r0, z)), t10 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(r0, z));
+    __m128 t01 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(r1, z)), t11 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(r1, z));
+    __m128 t0 = _mm_add_ps(t00, _mm_mul_ps(fx, _mm_sub_ps(t10, t00)));
+    __m128 t1 = _mm_add_ps(t01, _mm_mul_ps(fx, _mm_sub_ps(t11, t01)));
+    __m128i c = _mm_cvttps_epi32(_mm_add_ps(_mm_add_ps(half, t0), _mm_mul_ps(fy, _mm_sub_ps(t1, t0))));
+    c = _mm_packs_epi32(c, c);
+    dst[i] = (rgba32_t)_mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+  }
+}
+
+// RGB565 and A8: 8 pixels at a time with channels in separate vectors of 16-bit values (non-linear only)
+static void swnvg__unpack565SSE2(__m128i p, __m128i* ch)
+{
+  __m128i r = _mm_srli_epi16(p, 11);
+  __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), _mm_set1_epi16(0x3f));
+  __m128i b = _mm_and_si128(p, _mm_set1_epi16(0x1f));
+  ch[0] = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+  ch[1] = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+  ch[2] = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+}
+
+static __m128i swnvg__pack565SSE2(const __m128i* ch)
+{
+  __m128i h = _mm_set1_epi16(127);
+  __m128i r = swnvg__div255SSE2(_mm_add_epi16(_mm_mullo_epi16(ch[0], _mm_set1_epi16(31)), h));
+  __m128i g = swnvg__div255SSE2(_mm_add_epi16(_mm_mullo_epi16(ch[1], _mm_set1_epi16(63)), h));
+  __m128i b = swnvg__div255SSE2(_mm_add_epi16(_mm_mullo_epi16(ch[2], _mm_set1_epi16(31)), h));
+  return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+}
+
+// blend 8 RGB565 pixels; s holds source channels and srca source alpha times coverage
+static __m128i swnvg__blend565SSE2(__m128i p, const __m128i* s, __m128i srca)
+{
+  __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), srca);
+  __m128i d[3];
+  int k;
+  swnvg__unpack565SSE2(p, d);
+  for(k = 0; k < 3; ++k)
+    d[k] = swnvg__div255SSE2(_mm_add_epi16(_mm_mullo_epi16(srca, s[k]), _mm_mullo_epi16(ia, d[k])));
+  return swnvg__pack565SSE2(d);
+}
+
+// channels of 8 source pixels as 16-bit values
+static void swnvg__channels8SSE2(const rgba32_t* src, __m128i* ch)
+{
+  __m128i s0 = _mm_loadu_si128((const __m128i*)src), s1 = _mm_loadu_si128((const __m128i*)(src + 4));
+  __m128i m = _mm_set1_epi32(0xff);
+  ch[0] = _mm_packs_epi32(_mm_and_si128(s0, m), _mm_and_si128(s1, m));
+  ch[1] = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 8), m), _mm_and_si128(_mm_srli_epi32(s1, 8), m));
+  ch[2] = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 16), m), _mm_and_si128(_mm_srli_epi32(s1, 16), m));
+  ch[3] = _mm_packs_epi32(_mm_srli_epi32(s0, 24), _mm_srli_epi32(s1, 24));
+}
+
+static __m128i swnvg__cover8SSE2(const unsigned char* cover)
+{
+  return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cover), _mm_setzero_si128());
+}
+
+static void swnvg__blendSpan565SSE2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  unsigned short* d = (unsigned short*)dst;
+  if(!linear) {
+    for(; i + 8 <= count; i += 8) {
+      __m128i s[4];
+      swnvg__channels8SSE2(src + i, s);
+      __m128i srca = swnvg__div255SSE2(_mm_mullo_epi16(swnvg__cover8SSE2(cover + i), s[3]));
+      _mm_storeu_si128((__m128i*)(d + i), swnvg__blend565SSE2(_mm_loadu_si128((__m128i*)(d + i)), s, srca));
+    }
+  }
+  swnvg__blendSpan565(dst + 2*i, src + i, cover + i, count - i, linear);
+}
+
+static void swnvg__blendSolid565SSE2(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  unsigned short* d = (unsigned short*)dst;
+  if(!linear) {
+    unsigned char px[4] = {COLOR0(c), COLOR1(c), COLOR2(c), 255};
+    __m128i p = _mm_set1_epi16((short)swnvg__pack565(px));
+    __m128i s[3], ca = _mm_set1_epi16(COLOR3(c));
+    unsigned long long c8;
+    int opaque = RGBA32_IS_OPAQUE(c);
+    s[0] = _mm_set1_epi16(COLOR0(c));  s[1] = _mm_set1_epi16(COLOR1(c));  s[2] = _mm_set1_epi16(COLOR2(c));
+    for(; i + 8 <= count; i += 8) {
+      memcpy(&c8, cover + i, 8);
+      if(c8 == 0) continue;
+      if(opaque && c8 == ~0ULL)
+        _mm_storeu_si128((__m128i*)(d + i), p);
+      else {
+        __m128i srca = swnvg__div255SSE2(_mm_mullo_epi16(swnvg__cover8SSE2(cover + i), ca));
+        _mm_storeu_si128((__m128i*)(d + i), swnvg__blend565SSE2(_mm_loadu_si128((__m128i*)(d + i)), s, srca));
+      }
+    }
+  }
+  swnvg__blendSolid565(dst + 2*i, c, cover + i, count - i, linear);
+}
+
+// a = srca + (255 - srca)*a/255 for 8 A8 pixels
+static void swnvg__blendA8SSE2(unsigned char* dst, __m128i srca)
+{
+  __m128i z = _mm_setzero_si128();
+  __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)dst), z);
+  a = _mm_add_epi16(srca, swnvg__div255SSE2(_mm_mullo_epi16(_mm_sub_epi16(_mm_set1_epi16(255), srca), a)));
+  _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(a, z));
+}
+
+static void swnvg__blendSpanA8SSE2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  for(; i + 8 <= count; i += 8) {
+    __m128i s0 = _mm_loadu_si128((const __m128i*)(src + i)), s1 = _mm_loadu_si128((const __m128i*)(src + i + 4));
+    __m128i a = _mm_packs_epi32(_mm_srli_epi32(s0, 24), _mm_srli_epi32(s1, 24));
+    swnvg__blendA8SSE2(dst + i, swnvg__div255SSE2(_mm_mullo_epi16(swnvg__cover8SSE2(cover + i), a)));
+  }
+  swnvg__blendSpanA8(dst + i, src + i, cover + i, count - i, linear);
+}
+
+static void swnvg__blendSolidA8SSE2(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  __m128i ca = _mm_set1_epi16(COLOR3(c));
+  for(; i + 8 <= count; i += 8)
+    swnvg__blendA8SSE2(dst + i, swnvg__div255SSE2(_mm_mullo_epi16(swnvg__cover8SSE2(cover + i), ca)));
+  swnvg__blendSolidA8(dst + i, c, cover + i, count - i, linear);
+}
+#endif
+
+#ifdef SWNVG__AVX2
+SWNVG__TARGET_AVX2 static __m256i swnvg__div255AVX2(__m256i x)
+{
+  x = _mm256_add_epi16(x, _mm256_add_epi16(_mm256_srli_epi16(x, 8), _mm256_set1_epi16(1)));
+  return _mm256_srli_epi16(x, 8);
+}
+
+SWNVG__TARGET_AVX2 static __m256i swnvg__blend4AVX2(__m256i d, __m256i s, __m256i c)
+{
+  __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+  __m256i srca = swnvg__div255AVX2(_mm256_mullo_epi16(c, a));
+  __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), srca);
+  s = _mm256_or_si256(s, _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0));
+  return swnvg__div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(srca, s), _mm256_mullo_epi16(ia, d)));
+}
+
+// blend 8 pixels (non-linear); unpacking is within 128-bit lanes, so coverage is arranged to match
+SWNVG__TARGET_AVX2 static __m256i swnvg__blend8AVX2(__m256i d, __m256i s, const unsigned char* cover)
+{
+  __m256i z = _mm256_setzero_si256();
+  __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)cover));
+  c = _mm256_or_si256(c, _mm256_slli_epi32(c, 16));
+  __m256i lo = swnvg__blend4AVX2(_mm256_unpacklo_epi8(d, z), _mm256_unpacklo_epi8(s, z), _mm256_unpacklo_epi32(c, c));
+  __m256i hi = swnvg__blend4AVX2(_mm256_unpackhi_epi8(d, z), _mm256_unpackhi_epi8(s, z), _mm256_unpackhi_epi32(c, c));
+  return _mm256_packus_epi16(lo, hi);
+}
+
+SWNVG__TARGET_AVX2 static __m256 swnvg__div255fAVX2(__m256 x)
+{
+  return _mm256_mul_ps(_mm256_add_ps(x, _mm256_set1_ps(0.5f)), _mm256_set1_ps(1.0f/255.0f));
+}
+
+// 8 pixels w/ linear blending, using gathers for table lookups
+SWNVG__TARGET_AVX2 static __m256i swnvg__blendLinear8AVX2(__m256i d, __m256i s, const unsigned char* cover)
+{
+  int k;
+  __m256i ff = _mm256_set1_epi32(0xff);
+  __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)cover));
+  __m256i sa = _mm256_srli_epi32(s, 24);
+  __m256 srca = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(swnvg__div255fAVX2(_mm256_cvtepi32_ps(_mm256_mullo_epi32(c, sa)))));
+  __m256 ia = _mm256_sub_ps(_mm256_set1_ps(255.0f), srca);
+  __m256i res = _mm256_setzero_si256();
+  for(k = 0; k < 3; ++k) {
+    __m256i si = _mm256_and_si256(_mm256_srli_epi32(s, 8*k), ff);
+    __m256i di = _mm256_and_si256(_mm256_srli_epi32(d, 8*k), ff);
+    __m256 ls = _mm256_cvtepi32_ps(_mm256_i32gather_epi32((const int*)sRGBToLinear, si, 4));
+    __m256 ld = _mm256_cvtepi32_ps(_mm256_i32gather_epi32((const int*)sRGBToLinear, di, 4));
+    __m256i x = _mm256_cvttps_epi32(swnvg__div255fAVX2(_mm256_add_ps(_mm256_mul_ps(srca, ls), _mm256_mul_ps(ia, ld))));
+    __m256i out = _mm256_and_si256(_mm256_i32gather_epi32((const int*)linearToSRGB, x, 1), ff);
+    res = _mm256_or_si256(res, _mm256_slli_epi32(out, 8*k));
+  }
+  __m256 da = _mm256_cvtepi32_ps(_mm256_srli_epi32(d, 24));
+  __m256i a = _mm256_cvttps_epi32(_mm256_add_ps(srca, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(swnvg__div255fAVX2(_mm256_mul_ps(ia, da))))));
+  res = _mm256_or_si256(res, _mm256_slli_epi32(a, 24));
+  // write source color directly where srca == 255
+  __m256i full = _mm256_cmpeq_epi32(_mm256_cvttps_epi32(srca), ff);
+  return _mm256_blendv_epi8(res, s, full);
+}
+
+SWNVG__TARGET_AVX2 static void swnvg__blendSpanAVX2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  for(; i + 8 <= count; i += 8) {
+    __m256i d = _mm256_loadu_si256((__m256i*)(dst + 4*i));
+    __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+    d = linear ? swnvg__blendLinear8AVX2(d, s, cover + i) : swnvg__blend8AVX2(d, s, cover + i);
+    _mm256_storeu_si256((__m256i*)(dst + 4*i), d);
+  }
+  _mm256_zeroupper();  // avoid AVX-SSE transition penalty in scalar code
+  swnvg__blendSpanRef(dst + 4*i, src + i, cover + i, count - i, linear);
+}
+
+SWNVG__TARGET_AVX2 static void swnvg__blendSolidAVX2(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  long long c8;
+  int opaque = RGBA32_IS_OPAQUE(c);
+  __m256i s = _mm256_set1_epi32((int)c);
+  for(; i + 8 <= count; i += 8) {
+    memcpy(&c8, cover + i, 8);
+    if(opaque && c8 == -1) {
+      _mm256_storeu_si256((__m256i*)(dst + 4*i), s);
+      continue;
+    }
+    __m256i d = _mm256_loadu_si256((__m256i*)(dst + 4*i));
+    d = linear ? swnvg__blendLinear8AVX2(d, s, cover + i) : swnvg__blend8AVX2(d, s, cover + i);
+    _mm256_storeu_si256((__m256i*)(dst + 4*i), d);
+  }
+  _mm256_zeroupper();
+  swnvg__blendSolidRef(dst + 4*i, c, cover + i, count - i, linear);
+}
+
+// premultiplied blending of 4 pixels unpacked to 16 bits per channel (see swnvg__blendPM2SSE2)
+SWNVG__TARGET_AVX2 static __m256i swnvg__blendPM4AVX2(__m256i d, __m256i s, __m256i c, const __m256i* k)
+{
+  s = swnvg__div255AVX2(_mm256_mullo_epi16(s, c));
+  __m256i sa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+  if(!k) {
+    __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), sa);
+    return _mm256_add_epi16(s, swnvg__div255AVX2(_mm256_mullo_epi16(d, ia)));
+  }
+  __m256i da = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(d, 0xFF), 0xFF);
+  __m256i fs = _mm256_or_si256(_mm256_and_si256(k[1], sa), _mm256_and_si256(k[2], da));
+  __m256i fd = _mm256_or_si256(_mm256_and_si256(k[5], sa), _mm256_and_si256(k[6], da));
+  fs = _mm256_sub_epi16(_mm256_add_epi16(k[0], _mm256_xor_si256(fs, k[3])), k[3]);
+  fd = _mm256_sub_epi16(_mm256_add_epi16(k[4], _mm256_xor_si256(fd, k[7])), k[7]);
+  __m256i x = _mm256_adds_epu16(_mm256_mullo_epi16(s, fs), _mm256_mullo_epi16(d, fd));
+  x = _mm256_srli_epi16(_mm256_mulhi_epu16(x, _mm256_set1_epi16((short)0x8081)), 7);
+  return _mm256_blendv_epi8(x, d, _mm256_cmpeq_epi16(c, _mm256_setzero_si256()));
+}
+
+SWNVG__TARGET_AVX2 static __m256i swnvg__blendPM8AVX2(__m256i d, __m256i s, const unsigned char* cover, const __m256i* k)
+{
+  __m256i z = _mm256_setzero_si256();
+  __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)cover));
+  c = _mm256_or_si256(c, _mm256_slli_epi32(c, 16));
+  __m256i lo = swnvg__blendPM4AVX2(_mm256_unpacklo_epi8(d, z), _mm256_unpacklo_epi8(s, z), _mm256_unpacklo_epi32(c, c), k);
+  __m256i hi = swnvg__blendPM4AVX2(_mm256_unpackhi_epi8(d, z), _mm256_unpackhi_epi8(s, z), _mm256_unpackhi_epi32(c, c), k);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+SWNVG__TARGET_AVX2 static const __m256i* swnvg__blendFactorsAVX2(const SWNVGblend* b, __m256i* k)
+{
+  int i;
+  __m128i k4[8];
+  if(!swnvg__blendFactorsSSE2(b, k4)) return NULL;
+  for(i = 0; i < 8; ++i)
+    k[i] = _mm256_broadcastsi128_si256(k4[i]);
+  return k;
+}
+
+SWNVG__TARGET_AVX2 static void swnvg__blendSpanPMAVX2(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i = 0;
+  __m256i kbuf[8];
+  const __m256i* k = swnvg__blendFactorsAVX2(b, kbuf);
+  for(; i + 8 <= count; i += 8) {
+    __m256i d = _mm256_loadu_si256((__m256i*)(dst + 4*i));
+    __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+    _mm256_storeu_si256((__m256i*)(dst + 4*i), swnvg__blendPM8AVX2(d, s, cover + i, k));
+  }
+  _mm256_zeroupper();
+  swnvg__blendSpanPMRef(dst + 4*i, src + i, cover + i, count - i, b);
+}
+
+SWNVG__TARGET_AVX2 static void swnvg__blendSolidPMAVX2(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i = 0;
+  long long c8;
+  int copy = b->srcOver && RGBA32_IS_OPAQUE(c);
+  __m256i s = _mm256_set1_epi32((int)c);
+  __m256i kbuf[8];
+  const __m256i* k = swnvg__blendFactorsAVX2(b, kbuf);
+  for(; i + 8 <= count; i += 8) {
+    memcpy(&c8, cover + i, 8);
+    if(c8 == 0) continue;
+    if(copy && c8 == -1)
+      _mm256_storeu_si256((__m256i*)(dst + 4*i), s);
+    else
+      _mm256_storeu_si256((__m256i*)(dst + 4*i), swnvg__blendPM8AVX2(_mm256_loadu_si256((__m256i*)(dst + 4*i)), s, cover + i, k));
+  }
+  _mm256_zeroupper();
+  swnvg__blendSolidPMRef(dst + 4*i, c, cover + i, count - i, b);
+}
+
+static int swnvg__cpuHasAVX2(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  if(!(info[2] & (1<<27)) || (_xgetbv(0) & 6) != 6) return 0;  // OS must save YMM registers
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1<<5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef SWNVG__NEON
+// x/255 for 0 <= x <= 255*255 (exact)
+static uint16x8_t swnvg__div255NEON(uint16x8_t x)
+{
+  return vshrq_n_u16(vaddq_u16(x, vaddq_u16(vshrq_n_u16(x, 8), vdupq_n_u16(1))), 8);
+}
+
+// blend 8 pixels (non-linear), deinterleaved into channels
+static uint8x8x4_t swnvg__blend8NEON(uint8x8x4_t d, uint8x8x4_t s, uint8x8_t c)
+{
+  uint8x8_t srca = vmovn_u16(swnvg__div255NEON(vmull_u8(c, s.val[3])));
+  uint8x8_t ia = vsub_u8(vdup_n_u8(255), srca);
+  int k;
+  for(k = 0; k < 3; ++k)
+    d.val[k] = vmovn_u16(swnvg__div255NEON(vmlal_u8(vmull_u8(srca, s.val[k]), ia, d.val[k])));
+  d.val[3] = vadd_u8(srca, vmovn_u16(swnvg__div255NEON(vmull_u8(ia, d.val[3]))));
+  return d;
+}
+
+// linear blending is left to the scalar kernel since NEON has no gather
+static void swnvg__blendSpanNEON(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  if(!linear) {
+    for(; i + 8 <= count; i += 8) {
+      uint8x8x4_t d = vld4_u8(dst + 4*i);
+      uint8x8x4_t s = vld4_u8((const unsigned char*)(src + i));
+      vst4_u8(dst + 4*i, swnvg__blend8NEON(d, s, vld1_u8(cover + i)));
+    }
+  }
+  swnvg__blendSpanRef(dst + 4*i, src + i, cover + i, count - i, linear);
+}
+
+static void swnvg__blendSolidNEON(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  if(!linear) {
+    uint8x8x4_t s;
+    s.val[0] = vdup_n_u8(COLOR0(c));  s.val[1] = vdup_n_u8(COLOR1(c));
+    s.val[2] = vdup_n_u8(COLOR2(c));  s.val[3] = vdup_n_u8(COLOR3(c));
+    for(; i + 8 <= count; i += 8) {
+      uint8x8x4_t d = vld4_u8(dst + 4*i);
+      vst4_u8(dst + 4*i, swnvg__blend8NEON(d, s, vld1_u8(cover + i)));
+    }
+  }
+  swnvg__blendSolidRef(dst + 4*i, c, cover + i, count - i, linear);
+}
+
+// premultiplied blending of 8 pixels, deinterleaved into channels (see swnvg__blendPM)
+static uint8x8x4_t swnvg__blendPM8NEON(uint8x8x4_t d, uint8x8x4_t s, uint8x8_t c, const SWNVGblend* b)
+{
+  uint16x8_t sa = swnvg__div255NEON(vmull_u8(c, s.val[3]));
+  uint16x8_t da = vmovl_u8(d.val[3]);
+  uint8x8_t skip = vceq_u8(c, vdup_n_u8(0));
+  uint8x8x4_t out;
+  int k;
+  for(k = 0; k < 4; ++k) {
+    int j = k < 3 ? 0 : 2;
+    uint16x8_t fs = vaddq_u16(vdupq_n_u16((uint16_t)b->k0[j]),
+        vaddq_u16(vmulq_n_u16(sa, (uint16_t)b->ks[j]), vmulq_n_u16(da, (uint16_t)b->kd[j])));
+    uint16x8_t fd = vaddq_u16(vdupq_n_u16((uint16_t)b->k0[j+1]),
+        vaddq_u16(vmulq_n_u16(sa, (uint16_t)b->ks[j+1]), vmulq_n_u16(da, (uint16_t)b->kd[j+1])));
+    uint16x8_t sk = k < 3 ? swnvg__div255NEON(vmull_u8(c, s.val[k])) : sa;
+    // clamping saturated sum to 255*255 keeps x/255 exact
+    uint16x8_t x = vqaddq_u16(vmulq_u16(sk, fs), vmulq_u16(vmovl_u8(d.val[k]), fd));
+    x = swnvg__div255NEON(vminq_u16(x, vdupq_n_u16(255*255)));
+    out.val[k] = vbsl_u8(skip, d.val[k], vqmovn_u16(x));
+  }
+  return out;
+}
+
+static void swnvg__blendSpanPMNEON(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i = 0;
+  for(; i + 8 <= count; i += 8) {
+    uint8x8x4_t d = vld4_u8(dst + 4*i);
+    uint8x8x4_t s = vld4_u8((const unsigned char*)(src + i));
+    vst4_u8(dst + 4*i, swnvg__blendPM8NEON(d, s, vld1_u8(cover + i), b));
+  }
+  swnvg__blendSpanPMRef(dst + 4*i, src + i, cover + i, count - i, b);
+}
+
+static void swnvg__blendSolidPMNEON(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, const SWNVGblend* b)
+{
+  int i = 0;
+  uint8x8x4_t s;
+  s.val[0] = vdup_n_u8(COLOR0(c));  s.val[1] = vdup_n_u8(COLOR1(c));
+  s.val[2] = vdup_n_u8(COLOR2(c));  s.val[3] = vdup_n_u8(COLOR3(c));
+  for(; i + 8 <= count; i += 8) {
+    uint8x8x4_t d = vld4_u8(dst + 4*i);
+    vst4_u8(dst + 4*i, swnvg__blendPM8NEON(d, s, vld1_u8(cover + i), b));
+  }
+  swnvg__blendSolidPMRef(dst + 4*i, c, cover + i, count - i, b);
+}
+
+// RGB565 and A8 (non-linear only); s holds 16-bit source channels and srca source alpha times coverage
+static uint16x8_t swnvg__blend565NEON(uint16x8_t p, const uint16x8_t* s, uint16x8_t srca)
+{
+  uint16x8_t ia = vsubq_u16(vdupq_n_u16(255), srca);
+  uint16x8_t r = vshrq_n_u16(p, 11);
+  uint16x8_t g = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3f));
+  uint16x8_t b = vandq_u16(p, vdupq_n_u16(0x1f));
+  uint16x8_t h = vdupq_n_u16(127);
+  r = swnvg__div255NEON(vmlaq_u16(vmulq_u16(srca, s[0]), ia, vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2))));
+  g = swnvg__div255NEON(vmlaq_u16(vmulq_u16(srca, s[1]), ia, vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4))));
+  b = swnvg__div255NEON(vmlaq_u16(vmulq_u16(srca, s[2]), ia, vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2))));
+  r = swnvg__div255NEON(vmlaq_n_u16(h, r, 31));
+  g = swnvg__div255NEON(vmlaq_n_u16(h, g, 63));
+  b = swnvg__div255NEON(vmlaq_n_u16(h, b, 31));
+  return vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b);
+}
+
+static void swnvg__blendSpan565NEON(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  unsigned short* d = (unsigned short*)dst;
+  if(!linear) {
+    for(; i + 8 <= count; i += 8) {
+      uint8x8x4_t sv = vld4_u8((const unsigned char*)(src + i));
+      uint16x8_t s[3];
+      s[0] = vmovl_u8(sv.val[0]);  s[1] = vmovl_u8(sv.val[1]);  s[2] = vmovl_u8(sv.val[2]);
+      uint16x8_t srca = swnvg__div255NEON(vmull_u8(vld1_u8(cover + i), sv.val[3]));
+      vst1q_u16(d + i, swnvg__blend565NEON(vld1q_u16(d + i), s, srca));
+    }
+  }
+  swnvg__blendSpan565(dst + 2*i, src + i, cover + i, count - i, linear);
+}
+
+static void swnvg__blendSolid565NEON(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  unsigned short* d = (unsigned short*)dst;
+  if(!linear) {
+    uint16x8_t s[3];
+    uint8x8_t ca = vdup_n_u8(COLOR3(c));
+    s[0] = vdupq_n_u16(COLOR0(c));  s[1] = vdupq_n_u16(COLOR1(c));  s[2] = vdupq_n_u16(COLOR2(c));
+    for(; i + 8 <= count; i += 8) {
+      uint16x8_t srca = swnvg__div255NEON(vmull_u8(vld1_u8(cover + i), ca));
+      vst1q_u16(d + i, swnvg__blend565NEON(vld1q_u16(d + i), s, srca));
+    }
+  }
+  swnvg__blendSolid565(dst + 2*i, c, cover + i, count - i, linear);
+}
+
+static void swnvg__blendA8NEON(unsigned char* dst, uint8x8_t srca)
+{
+  uint8x8_t ia = vsub_u8(vdup_n_u8(255), srca);
+  vst1_u8(dst, vadd_u8(srca, vmovn_u16(swnvg__div255NEON(vmull_u8(ia, vld1_u8(dst))))));
+}
+
+static void swnvg__blendSpanA8NEON(unsigned char* dst, const rgba32_t* src, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  for(; i + 8 <= count; i += 8) {
+    uint8x8x4_t sv = vld4_u8((const unsigned char*)(src + i));
+    swnvg__blendA8NEON(dst + i, vmovn_u16(swnvg__div255NEON(vmull_u8(vld1_u8(cover + i), sv.val[3]))));
+  }
+  swnvg__blendSpanA8(dst + i, src + i, cover + i, count - i, linear);
+}
+
+static void swnvg__blendSolidA8NEON(unsigned char* dst, rgba32_t c, const unsigned char* cover, int count, int linear)
+{
+  int i = 0;
+  uint8x8_t ca = vdup_n_u8(COLOR3(c));
+  for(; i + 8 <= count; i += 8)
+    swnvg__blendA8NEON(dst + i, vmovn_u16(swnvg__div255NEON(vmull_u8(vld1_u8(cover + i), ca))));
+  swnvg__blendSolidA8(dst + i, c, cover + i, count - i, linear);
+}
+#endif
+
+// select span blending kernels based on CPU features
+static void swnvg__initKernels(SWNVGcontext* gl)
+{
+  gl->blendSpan = swnvg__blendSpanRef;
+  gl->blendSolid = swnvg__blendSolidRef;
+  gl->gradBox = swnvg__gradBoxRef;
+  gl->texSpan = swnvg__texSpanRef;
+  gl->blendSpanPM = swnvg__blendSpanPMRef;
+  gl->blendSolidPM = swnvg__blendSolidPMRef;
+  gl->kernelName = "scalar";
+  if(gl->flags & NVGSW_NO_SIMD) return;
+#ifdef SWNVG__SSE2
+  gl->blendSpan = swnvg__blendSpanSSE2;
+  gl->blendSolid = swnvg__blendSolidSSE2;
+  gl->gradBox = swnvg__gradBoxSSE2;
+  gl->texSpan = swnvg__texSpanSSE2;
+  gl->blendSpanPM = swnvg__blendSpanPMSSE2;
+  gl->blendSolidPM = swnvg__blendSolidPMSSE2;
+  gl->kernelName = "SSE2";
+#ifdef SWNVG__AVX2
+  if(swnvg__cpuHasAVX2()) {
+    gl->blendSpan = swnvg__blendSpanAVX2;
+    gl->blendSolid = swnvg__blendSolidAVX2;
+    gl->blendSpanPM = swnvg__blendSpanPMAVX2;
+    gl->blendSolidPM = swnvg__blendSolidPMAVX2;
+    gl->kernelName = "AVX2";
+  }
+#endif
+#endif
+#ifdef SWNVG__NEON
+  gl->blendSpan = swnvg__blendSpanNEON;
+  gl->blendSolid = swnvg__blendSolidNEON;
+  gl->blendSpanPM = swnvg__blendSpanPMNEON;
+  gl->blendSolidPM = swnvg__blendSolidPMNEON;
+  gl->kernelName = "NEON";
+#endif
+}
+
+// select kernels for framebuffer format; RGBA16F only has scalar kernels
+static void swnvg__initFormat(SWNVGcontext* gl, int format)
+{
+  swnvg__initKernels(gl);
+  gl->format = format;
+  gl->bpp = 4;
+  gl->loadSpan = NULL;
+  gl->storeSpan = NULL;
+  if(format == NVGSW_RGB565) {
+    gl->bpp = 2;
+    gl->blendSpan = swnvg__blendSpan565;
+    gl->blendSolid = swnvg__blendSolid565;
+    gl->loadSpan = swnvg__load565;
+    gl->storeSpan = swnvg__store565;
+    if(gl->flags & NVGSW_NO_SIMD) return;
+#ifdef SWNVG__SSE2
+    gl->blendSpan = swnvg__blendSpan565SSE2;
+    gl->blendSolid = swnvg__blendSolid565SSE2;
+#endif
+#ifdef SWNVG__NEON
+    gl->blendSpan = swnvg__blendSpan565NEON;
+    gl->blendSolid = swnvg__blendSolid565NEON;
+#endif
+  }
+  else if(format == NVGSW_A8) {
+    gl->bpp = 1;
+    gl->blendSpan = swnvg__blendSpanA8;
+    gl->blendSolid = swnvg__blendSolidA8;
+    gl->loadSpan = swnvg__loadA8;
+    gl->storeSpan = swnvg__storeA8;
+    if(gl->flags & NVGSW_NO_SIMD) return;
+#ifdef SWNVG__SSE2
+    gl->blendSpan = swnvg__blendSpanA8SSE2;
+    gl->blendSolid = swnvg__blendSolidA8SSE2;
+#endif
+#ifdef SWNVG__NEON
+    gl->blendSpan = swnvg__blendSpanA8NEON;
+    gl->blendSolid = swnvg__blendSolidA8NEON;
+#endif
+  }
+  else if(format == NVGSW_RGBA16F) {
+    gl->bpp = 8;
+    gl->blendSpan = swnvg__blendSpan16F;
+    gl->blendSolid = swnvg__blendSolid16F;
+    gl->loadSpan = swnvg__load16F;
+    gl->storeSpan = swnvg__store16F;
+  }
+}
+
+static int swnvg__getBlendFactor(int factor, int srca, int dsta)
+{
+  switch(factor) {
+    case NVG_ZERO:                return 0;
+    case NVG_ONE:                 return 255;
+    case NVG_SRC_ALPHA:           return srca;
+    case NVG_ONE_MINUS_SRC_ALPHA: return 255 - srca;
+    case NVG_DST_ALPHA:           return dsta;
+    case NVG_ONE_MINUS_DST_ALPHA: return 255 - dsta;
+    default:                      return -255;
+  }
+}
+
+static void swnvg__blendWithFunc(NVGcompositeOperationState* op, unsigned char* dst, int cover, rgba32_t rgba, int linear)
+{
+  // TODO: support linear blending
+  int srca = (cover * COLOR3(rgba))/255;
+  int dsta = dst[3];
+  // get blend factors
+  int srcRGB = swnvg__getBlendFactor(op->srcRGB, srca, dsta);
+  int dstRGB = swnvg__getBlendFactor(op->dstRGB, srca, dsta);
+  int srcAlpha = swnvg__getBlendFactor(op->srcAlpha, srca, dsta);
+  int dstAlpha = swnvg__getBlendFactor(op->dstAlpha, srca, dsta);
+  // blend
+  int r = (srcRGB*COLOR0(rgba) + dstRGB*dst[0])/255;
+  int g = (srcRGB*COLOR1(rgba) + dstRGB*dst[1])/255;
+  int b = (srcRGB*COLOR2(rgba) + dstRGB*dst[2])/255;
+  int a = (srcAlpha*srca + dstAlpha*dst[3])/255;
+  // write
+  dst[0] = (unsigned char)r;
+  dst[1] = (unsigned char)g;
+  dst[2] = (unsigned char)b;
+  dst[3] = (unsigned char)a;
+}
+
+// sample image for span of pixels from mip level
+static void swnvg__imageSpan(SWNVGcontext* gl, rgba32_t* src, SWNVGcall* call, int level, int x, int y, int count)
+{
+  int i, w, h;
+  rgba32_t* img = swnvg__mipLevel(call->tex, level, &w, &h);
+  float qx, qy;
+  float dqx = call->paintMat[0]*w/call->extent[0];
+  float dqy = call->paintMat[1]*h/call->extent[1];
+  nvgTransformPoint(&qx, &qy, call->paintMat, x, y);
+  // +/- 0.5 determined by experiment to match nanovg_gl
+  qx = (qx + 0.5f)*w/call->extent[0] - 0.5f;
+  qy = (qy + 0.5f)*h/call->extent[1] - 0.5f;
+  if(call->tex->flags & NVG_IMAGE_NEAREST) {
+    for (i = 0; i < count; ++i) {
+      int imgx = swnvg__clampi((int)(0.5f + qx), 0, w-1);
+      int imgy = swnvg__clampi((int)(0.5f + qy), 0, h-1);
+      src[i] = img[imgy*w + imgx];
+      qx += dqx;  // for qx,qy => qx+1,qy
+      qy += dqy;
+    }
+  }
+  else
+    gl->texSpan(src, img, w, h, qx, qy, dqx, dqy, count);
+}
+
+static unsigned char swnvg__scissorCover(const SWNVGcall* call, int x, int y, int cover)
+{
+  float qx, qy, ssx, ssy;
+  nvgTransformPoint(&qx, &qy, call->scissorMat, x, y);
+  ssx = 0.5f - (fabsf(qx) - call->scissorExt[0])*call->scissorScale[0];
+  ssy = 0.5f - (fabsf(qy) - call->scissorExt[1])*call->scissorScale[1];
+  return (unsigned char)(cover * (swnvg__clampf(ssx, 0.0f, 1.0f) * swnvg__clampf(ssy, 0.0f, 1.0f)) + 0.5f);
+}
+
+// range [i0, i1) of i in [0, count) for which |a + i*d| <= c; range is widened (pad > 0) or narrowed
+//  (pad < 0) by a margin covering rounding error in per-pixel evaluation
+static void swnvg__absRange(double a, double d, double c, int count, int pad, int* i0, int* i1)
+{
+  double t0, t1;
+  c += pad*(1e-5*(fabs(a) + fabs(d)*count + fabs(c)) + 1e-6);
+  if (c < 0 || (d == 0 && fabs(a) > c)) {
+    *i0 = *i1 = 0;
+    return;
+  }
+  if (d == 0) {
+    *i0 = 0;
+    *i1 = count;
+    return;
+  }
+  t0 = (-c - a)/d;
+  t1 = (c - a)/d;
+  if (t0 > t1) { double t = t0; t0 = t1; t1 = t; }
+  *i0 = (int)swnvg__clampf((float)ceil(t0) - pad, 0, count);
+  *i1 = (int)swnvg__clampf((float)floor(t1) + 1 + pad, 0, count);
+  if (*i1 < *i0) *i1 = *i0;
+}
+
+// intersect span with rotated scissor: pixels outside [i0, i1) have zero scissor factor and pixels in
+//  [n0, n1) have factor 1, so only [i0, n0) and [n1, i1) need per-pixel evaluation
+static void swnvg__scissorSpan(const SWNVGcall* call, int x, int y, int count, int* i0, int* i1, int* n0, int* n1)
+{
+  const float* m = call->scissorMat;
+  double ax = (double)m[0]*x + (double)m[2]*y + m[4];
+  double ay = (double)m[1]*x + (double)m[3]*y + m[5];
+  int ox0, ox1, oy0, oy1, ix0, ix1, iy0, iy1;
+  swnvg__absRange(ax, m[0], call->scissorOut[0], count, 1, &ox0, &ox1);
+  swnvg__absRange(ay, m[1], call->scissorOut[1], count, 1, &oy0, &oy1);
+  swnvg__absRange(ax, m[0], call->scissorIn[0], count, -1, &ix0, &ix1);
+  swnvg__absRange(ay, m[1], call->scissorIn[1], count, -1, &iy0, &iy1);
+  *i0 = swnvg__maxi(ox0, oy0);
+  *i1 = swnvg__maxi(*i0, swnvg__mini(ox1, oy1));
+  *n0 = swnvg__clampi(swnvg__maxi(ix0, iy0), *i0, *i1);
+  *n1 = swnvg__clampi(swnvg__mini(ix1, iy1), *n0, *i1);
+}
+
+#ifdef NVG_FRAME_STATS
+static void swnvg__countPixels(SWNVGthreadCtx* r, const unsigned char* cover, int count)
+{
+  int i;
+  r->statBlended += count;
+  for(i = 0; i < count; ++i)
+    r->statCovered += cover[i] != 0;
+}
+#endif
+
+// blend span of solid color c (src == NULL) or colors src for call; w/ NVGSW_PREMULTIPLIED, call's composite op is
+//  applied by premultiplied kernels, which work on 8888 pixels, so other formats are converted
+static void swnvg__blendCall(SWNVGthreadCtx* r, const SWNVGcall* call, unsigned char* dst, const rgba32_t* src,
+    rgba32_t c, const unsigned char* cover, int count)
+{
+  SWNVGcontext* gl = r->context;
+  int linear = call->flags & NVG_SRGB ? 1 : 0;
+  unsigned char* d = dst;
+  NVG_STAT(swnvg__countPixels(r, cover, count));
+  if(!(gl->flags & NVGSW_PREMULTIPLIED)) {
+    if(src)
+      gl->blendSpan(dst, src, cover, count, linear);
+    else
+      gl->blendSolid(dst, c, cover, count, linear);
+    return;
+  }
+  if(gl->loadSpan) {
+    d = (unsigned char*)r->mipColors;
+    gl->loadSpan(r->mipColors, dst, count, 0);
+  }
+  if(call->blend.perPixel) {
+    int i;
+    for(i = 0; i < count; ++i) {
+      if(cover[i] != 0)
+        swnvg__blendPMFunc(d + 4*i, cover[i], src ? src[i] : c, &call->blendFunc);
+    }
+  }
+  else if(src)
+    gl->blendSpanPM(d, src, cover, count, &call->blend);
+  else
+    gl->blendSolidPM(d, c, cover, count, &call->blend);
+  if(gl->storeSpan)
+    gl->storeSpan(dst, r->mipColors, count, 0);
+}
+
+static void swnvg__scanlineSolid(SWNVGthreadCtx* r, unsigned char* dst, int count, unsigned char* cover, int x, int y, SWNVGcall* call)
+{
+  int i;
+  SWNVGcontext* gl = r->context;
+  rgba32_t* src = r->spanColors;
+  int linear = call->flags & NVG_SRGB ? 1 : 0;
+  if(count <= 0) return;
+  if(call->flags & NVG_PATH_SCISSOR) {
+    // apply scissor factor to coverage for non-trivial (i.e. rotated or skewed) scissor - only pixels near
+    //  scissor edges need per-pixel factor; span is clipped to pixels with nonzero factor
+    int i0, i1, n0, n1;
+    swnvg__scissorSpan(call, x, y, count, &i0, &i1, &n0, &n1);
+    for(i = i0; i < n0; ++i)
+      cover[i] = swnvg__scissorCover(call, x + i, y, cover[i]);
+    for(i = n1; i < i1; ++i)
+      cover[i] = swnvg__scissorCover(call, x + i, y, cover[i]);
+    int blendfunc = (call->flags & NVG_PATH_BLENDFUNC) && !(gl->flags & NVGSW_PREMULTIPLIED);
+    if(linear || blendfunc || call->type != SWNVG_PAINT_COLOR) {
+      // blending with zero coverage may still modify dst in these modes, and gradient and image paint
+      //  are stepped from start of span, so changing start could change rounding
+      memset(cover, 0, i0);
+      memset(cover + i1, 0, count - i1);
+    }
+    else {
+      if(i1 <= i0) return;
+      dst += gl->bpp*i0;
+      cover += i0;
+      x += i0;
+      count = i1 - i0;
+    }
+  }
+  // note r,g,b may not actually be R,G,B (in particular, R and G could be switched)
+  if (call->type == SWNVG_PAINT_COLOR) {
+    rgba32_t c = call->innerCol;
+    if((call->flags & NVG_PATH_BLENDFUNC) && !(gl->flags & NVGSW_PREMULTIPLIED)) {
+      // formats other than 32-bit are converted to 8888 for blending
+      unsigned char* d = gl->loadSpan ? (unsigned char*)r->mipColors : dst;
+      if(gl->loadSpan)
+        gl->loadSpan(r->mipColors, dst, count, linear);
+      NVG_STAT(swnvg__countPixels(r, cover, count));
+      for(i = 0; i < count; ++i)
+        swnvg__blendWithFunc(&call->blendFunc, d + 4*i, cover[i], c, linear);
+      if(gl->storeSpan)
+        gl->storeSpan(dst, r->mipColors, count, linear);
+    }
+    else
+      swnvg__blendCall(r, call, dst, NULL, c, cover, count);
+  } else if (call->type == SWNVG_PAINT_IMAGE) {
+    SWNVGtexture* tex = call->tex;
+    int level = 0, t = 0;
+    if (call->lod > 0 && tex->mipsValid && tex->nmips > 0) {
+      // trilinear filtering between two nearest levels, or nearest level for NVG_IMAGE_NEAREST
+      if (tex->flags & NVG_IMAGE_NEAREST)
+        level = swnvg__mini((int)(call->lod + 0.5f), tex->nmips);
+      else {
+        level = swnvg__mini((int)call->lod, tex->nmips);
+        t = level < tex->nmips ? (int)((call->lod - level)*256 + 0.5f) : 0;
+      }
+    }
+    for (i = 0; i < count; ++i)
+      cover[i] = (cover[i] * COLOR3(call->innerCol))/255;
+    swnvg__imageSpan(gl, src, call, level, x, y, count);
+    if (t > 0) {
+      swnvg__imageSpan(gl, r->mipColors, call, level + 1, x, y, count);
+      for (i = 0; i < count; ++i)
+        src[i] = swnvg__lerpRGBA32(src[i], r->mipColors[i], t);
+    }
+    swnvg__blendCall(r, call, dst, src, 0, cover, count);
+  } else if (call->type == SWNVG_PAINT_GRAD) {
+    float* dist = r->spanDist;
+    int cr0 = linear ? (int)sRGBToLinear[COLOR0(call->innerCol)] : COLOR0(call->innerCol);
+    int cg0 = linear ? (int)sRGBToLinear[COLOR1(call->innerCol)] : COLOR1(call->innerCol);
+    int cb0 = linear ? (int)sRGBToLinear[COLOR2(call->innerCol)] : COLOR2(call->innerCol);
+    int ca0 = COLOR3(call->innerCol);
+    int cr1 = linear ? (int)sRGBToLinear[COLOR0(call->outerCol)] : COLOR0(call->outerCol);
+    int cg1 = linear ? (int)sRGBToLinear[COLOR1(call->outerCol)] : COLOR1(call->outerCol);
+    int cb1 = linear ? (int)sRGBToLinear[COLOR2(call->outerCol)] : COLOR2(call->outerCol);
+    int ca1 = COLOR3(call->outerCol);
+    if (call->gradType == SWNVG_GRAD_LINEAR)
+      swnvg__gradLinear(dist, call, x, y, count);
+    else
+      gl->gradBox(dist, call, x, y, count);
+    for (i = 0; i < count; ++i) {
+      float d = dist[i];
+      if (call->tex) {
+        // texture for gradients with >2 stops
+        src[i] = swnvg__texLerpRGBA32(call->tex, d*call->tex->width, 0);
+      } else if (call->rampOffset >= 0) {
+        src[i] = gl->ramps[call->rampOffset + swnvg__clampi((int)(d*(SWNVG__RAMP_SIZE-1) + 0.5f), 0, SWNVG__RAMP_SIZE-1)];
+      } else {
+        d = swnvg__clampf(d, 0.0f, 1.0f);
+        unsigned int cr = (int)(0.5f + cr0*(1.0f - d) + cr1*d);
+        unsigned int cg = (int)(0.5f + cg0*(1.0f - d) + cg1*d);
+        unsigned int cb = (int)(0.5f + cb0*(1.0f - d) + cb1*d);
+        unsigned int ca = (int)(0.5f + ca0*(1.0f - d) + ca1*d);
+        if(linear)
+          src[i] = linearToSRGB[cr] | linearToSRGB[cg] << 8 | linearToSRGB[cb] << 16 | ca << 24;
+        else
+          src[i] = cr | cg << 8 | cb << 16 | ca << 24;
+      }
+    }
+    swnvg__blendCall(r, call, dst, src, 0, cover, count);
+  }
+}
+
+static void swnvg__rasterizeSortedEdges(SWNVGthreadCtx* r, SWNVGcall* call)
+{
+  SWNVGcontext* gl = r->context;
+  int y, s;
+  int e = call->edgeOffset;
+  int eend = call->edgeOffset + call->edgeCount;
+  int xmin, xmax, xmin1, xmax1;
+
+  for (y = swnvg__maxi(r->y0, call->bounds[1]); y <= swnvg__mini(r->y1, call->bounds[3]); y++) {
+    xmin = gl->width;
+    xmax = 0;
+    for (s = 0; s < SWNVG__SUBSAMPLES; ++s) {
+      // we only process one subsample scanline for non-AA
+      if((call->flags & NVG_PATH_NO_AA) && s != SWNVG__SUBSAMPLES/2)
+        continue;
+      // find center of pixel for this scanline
+      float scany = (float)(y*SWNVG__SUBSAMPLES + s) + 0.5f;
+      int i, n = 0;
+
+      // update active edges - remove active edges that terminate before the center of this scanline, compacting
+      //  table in place, and advance the rest to position for current scanline; edges rarely cross, so
+      //  incremental insertion sort is ~O(n)
+      for (i = 0; i < r->naet; ++i) {
+        if (r->aetEy[i] > scany) {
+          r->aetX[n] = r->aetX[i] + r->aetDx[i];
+          r->aetDx[n] = r->aetDx[i];
+          r->aetEy[n] = r->aetEy[i];
+          r->aetDir[n] = r->aetDir[i];
+          swnvg__sortActive(r, n);
+          ++n;
+        }
+      }
+      r->naet = n;
+      // insert all edges that start before the center of this scanline -- omit ones that also end on this scanline
+      //  or lie entirely to the right of this tile (see swnvg__fillActiveEdges)
+      while (e < eend && gl->edges[e].y0 <= scany) {
+        if (gl->edges[e].y1 > scany && swnvg__minf(gl->edges[e].x0, gl->edges[e].x1) < r->x1 + 1) {
+          // AA case uses per-subscanline step
+          if (!swnvg__addActive(r, &gl->edges[e], scany, (call->flags & NVG_PATH_NO_AA) ? SWNVG__SUBSAMPLES : 1))
+            break;
+        }
+        e++;
+      }
+      // now process all active edges in non-zero fashion
+      if (r->naet > 0)
+        swnvg__fillActiveEdges(r, &xmin, &xmax, call->flags);
+    }
+    // clip xmin, xmax for memset
+    xmin = swnvg__maxi(xmin, r->x0);
+    xmax = swnvg__mini(xmax, r->x1);
+    // further clip for possible scissor
+    xmin1 = swnvg__maxi(xmin, call->bounds[0]);
+    xmax1 = swnvg__mini(xmax, call->bounds[2]);
+    if (xmin1 <= xmax1)
+      swnvg__scanlineSolid(r, &gl->bitmap[y*gl->stride + xmin1*gl->bpp], xmax1-xmin1+1, &r->scanline[xmin1 - r->x0], xmin1, y, call);
+    // we fill x range clipped to scissor, but we have to clear entire range written by fillActiveEdges
+    if (xmin <= xmax)
+      memset(&r->scanline[xmin - r->x0], 0, xmax-xmin+1);
+  }
+}
+
+// integral of sqrt(r^2 - u^2) from 0 to t
+static double swnvg__circleIntegral(double t, double r)
+{
+  double r2 = r*r;
+  return 0.5*(t*sqrt(swnvg__maxf(0, r2 - t*t)) + r2*asin(t < r ? t/r : 1.0));
+}
+
+// area of [u0,u1] x [v0,v1] inside circle of radius r at origin, for 0 <= u0 <= u1 <= r and 0 <= v0 <= v1: box is
+//  full height for u < ua, where circle crosses v1, and empty for u > ub, where it crosses v0
+static double swnvg__circleBoxArea(double u0, double u1, double v0, double v1, double r)
+{
+  double r2 = r*r, ua, ub;
+  if (u0*u0 + v0*v0 >= r2) return 0;
+  if (u1*u1 + v1*v1 <= r2) return (u1 - u0)*(v1 - v0);
+  ua = v1 < r ? sqrt(r2 - v1*v1) : 0;
+  ub = sqrt(r2 - v0*v0);
+  ua = ua < u0 ? u0 : (ua > u1 ? u1 : ua);
+  ub = ub < u0 ? u0 : (ub > u1 ? u1 : ub);
+  return (ua - u0)*(v1 - v0) + swnvg__circleIntegral(ub, r) - swnvg__circleIntegral(ua, r) - v0*(ub - ua);
+}
+
+// area of box (already clipped to rect) inside rounded rect s: box area less area outside arc in each corner square
+static float swnvg__roundRectArea(const float* s, float bx0, float bx1, float by0, float by1)
+{
+  double rad = s[4], area = (double)(bx1 - bx0)*(by1 - by0);
+  int k;
+  for (k = 0; k < 4; ++k) {
+    // distances from arc center, away from rect interior
+    double cx = k & 1 ? s[2] - rad : s[0] + rad, cy = k & 2 ? s[3] - rad : s[1] + rad;
+    double u0 = k & 1 ? bx0 - cx : cx - bx1, u1 = k & 1 ? bx1 - cx : cx - bx0;
+    double v0 = k & 2 ? by0 - cy : cy - by1, v1 = k & 2 ? by1 - cy : cy - by0;
+    u0 = u0 > 0 ? u0 : 0;  u1 = u1 < rad ? u1 : rad;
+    v0 = v0 > 0 ? v0 : 0;  v1 = v1 < rad ? v1 : rad;
+    if (u0 < u1 && v0 < v1)
+      area -= (u1 - u0)*(v1 - v0) - swnvg__circleBoxArea(u0, u1, v0, v1, rad);
+  }
+  return (float)area;
+}
+
+// exact coverage for rect calls: pixel area inside rect, w/ corner pixels from closed form circle integral; fully
+//  covered runs of opaque solid color are stored directly
+static void swnvg__rasterizeRect(SWNVGthreadCtx* r, SWNVGcall* call)
+{
+  SWNVGcontext* gl = r->context;
+  const float* s = call->shape;
+  float rad = s[4];
+  int x, y, xa = swnvg__maxi(call->bounds[0], r->x0), xb = swnvg__mini(call->bounds[2], r->x1), n = xb - xa + 1;
+  // pixels in [ix0, ix1] are inside rect horizontally, pixels in [cx0, cx1] are between corner squares
+  int ix0 = swnvg__clampi((int)ceilf(s[0]), xa, xb + 1), ix1 = swnvg__clampi((int)floorf(s[2]) - 1, ix0 - 1, xb);
+  int cx0 = swnvg__clampi((int)ceilf(s[0] + rad), ix0, ix1 + 1), cx1 = swnvg__clampi((int)floorf(s[2] - rad) - 1, cx0 - 1, ix1);
+  int solid = call->type == SWNVG_PAINT_COLOR && RGBA32_IS_OPAQUE(call->innerCol) && gl->bpp == 4
+      && !(call->flags & (NVG_PATH_BLENDFUNC | NVG_PATH_SCISSOR));
+  unsigned char* cover = &r->scanline[xa - r->x0];
+  if (n <= 0) return;
+  for (y = swnvg__maxi(r->y0, call->bounds[1]); y <= swnvg__mini(r->y1, call->bounds[3]); y++) {
+    float by0 = swnvg__maxf((float)y, s[1]), by1 = swnvg__minf((float)(y + 1), s[3]), cy = by1 - by0;
+    int corner = rad > 0 && (by0 < s[1] + rad || by1 > s[3] - rad);
+    int mx0 = corner ? cx0 : ix0, mx1 = corner ? cx1 : ix1;  // run w/ vertical coverage only
+    unsigned char* dst = &gl->bitmap[y*gl->stride + xa*gl->bpp];
+    if (cy <= 0) continue;
+    memset(&cover[mx0 - xa], (int)(cy*255 + 0.5f), mx1 - mx0 + 1);
+    for (x = xa; x <= xb; ++x) {
+      float bx0, bx1;
+      if (x == mx0) x = mx1 + 1;
+      if (x > xb) break;
+      bx0 = swnvg__maxf((float)x, s[0]);
+      bx1 = swnvg__minf((float)(x + 1), s[2]);
+      if (bx1 <= bx0)
+        cover[x - xa] = 0;
+      else if (corner)
+        cover[x - xa] = (unsigned char)(swnvg__clampf(swnvg__roundRectArea(s, bx0, bx1, by0, by1), 0, 1)*255 + 0.5f);
+      else
+        cover[x - xa] = (unsigned char)((bx1 - bx0)*cy*255 + 0.5f);
+    }
+    if (solid && !corner && cy >= 1 && ix0 <= ix1) {
+      rgba32_t* d = (rgba32_t*)&dst[(ix0 - xa)*4];
+      swnvg__scanlineSolid(r, dst, ix0 - xa, cover, xa, y, call);
+      for (x = 0; x <= ix1 - ix0; ++x)
+        d[x] = call->innerCol;
+      NVG_STAT(r->statBlended += ix1 - ix0 + 1);
+      NVG_STAT(r->statCovered += ix1 - ix0 + 1);
+      swnvg__scanlineSolid(r, &dst[(ix1 + 1 - xa)*4], xb - ix1, &cover[ix1 + 1 - xa], ix1 + 1, y, call);
+    }
+    else
+      swnvg__scanlineSolid(r, dst, n, cover, xa, y, call);
+    memset(cover, 0, n);  // other rasterizers expect clear scanline
+  }
+}
+
+// thin strokes: segments are stored in edges in chunks, each preceded by an entry w/ bounding box of chunk's
+//  segments (x0,y0 - x1,y1) and number of segments (dir); dir of a segment has flags for butt ends
+#define SWNVG__LINE_CHUNK 32
+#define SWNVG__BUTT_START 1
+#define SWNVG__BUTT_END 2
+
+// fraction of pixel (unit square centered at origin) w/ n.p < x, for unit vector n w/ components of magnitude a
+//  and b, a >= b
+static float swnvg__pixelCdf(float x, float a, float b)
+{
+  float h = 0.5f*(a + b), m = 0.5f*(a - b);
+  if (x <= -h) return 0;
+  if (x >= h) return 1;
+  if (x < -m) return (x + h)*(x + h)/(2*a*b);
+  if (x > m) return 1 - (h - x)*(h - x)/(2*a*b);
+  return 0.5f + x/a;
+}
+
+// coverage of pixels by segment: exact area of pixel inside stripe of stroke width along segment, cut off at butt
+//  ends, and w/ distance to endpoint in place of distance to line at round ends and joints; max coverage is kept
+static void swnvg__lineSegment(SWNVGthreadCtx* r, const SWNVGedge* e, float hw, const int* clip)
+{
+  SWNVGcontext* gl = r->context;
+  float dx = e->x1 - e->x0, dy = e->y1 - e->y0, len = sqrtf(dx*dx + dy*dy);
+  float tx = len > 0 ? dx/len : 1.0f, ty = len > 0 ? dy/len : 0.0f;
+  float a = swnvg__maxf(swnvg__absf(tx), swnvg__absf(ty)), b = swnvg__minf(swnvg__absf(tx), swnvg__absf(ty));
+  // pixels w/ centers further than reach from segment are not covered
+  float ext = 0.5f*(a + b), reach = hw + ext;
+  float s0 = e->dir & SWNVG__BUTT_START ? -ext : -reach, s1 = len + (e->dir & SWNVG__BUTT_END ? ext : reach);
+  int ix, iy, iy0 = swnvg__maxi((int)floorf(swnvg__minf(e->y0, e->y1) - reach), clip[1]);
+  int iy1 = swnvg__mini((int)floorf(swnvg__maxf(e->y0, e->y1) + reach), clip[3]);
+  for (iy = iy0; iy <= iy1; ++iy) {
+    // pixel centers p (relative to start) must have |q| <= reach and s0 <= s <= s1, q = t x p, s = t.p
+    float py = iy + 0.5f - e->y0, pxmin = clip[0] - e->x0, pxmax = clip[2] + 1 - e->x0;
+    unsigned char* cov = &r->lineCov[(iy - r->y0)*gl->tileW - r->x0];
+    int* lims = &r->lineRows[2*(iy - r->y0)];
+    int ixa, ixb;
+    if (ty != 0) {
+      float u = (tx*py - reach)/ty, v = (tx*py + reach)/ty;
+      pxmin = swnvg__maxf(pxmin, swnvg__minf(u, v));
+      pxmax = swnvg__minf(pxmax, swnvg__maxf(u, v));
+    }
+    else if (swnvg__absf(py) > reach)
+      continue;
+    if (tx != 0) {
+      float u = (s0 - ty*py)/tx, v = (s1 - ty*py)/tx;
+      pxmin = swnvg__maxf(pxmin, swnvg__minf(u, v));
+      pxmax = swnvg__minf(pxmax, swnvg__maxf(u, v));
+    }
+    else if (ty*py < s0 || ty*py > s1)
+      continue;
+    if (pxmin > pxmax) continue;
+    ixa = swnvg__maxi((int)ceilf(pxmin + e->x0 - 0.5f), clip[0]);
+    ixb = swnvg__mini((int)floorf(pxmax + e->x0 - 0.5f), clip[2]);
+    for (ix = ixa; ix <= ixb; ++ix) {
+      float px = ix + 0.5f - e->x0, s = tx*px + ty*py, q = tx*py - ty*px, c;
+      int ci;
+      if ((s < 0 && !(e->dir & SWNVG__BUTT_START)) || (s > len && !(e->dir & SWNVG__BUTT_END))) {
+        float ds = s < 0 ? s : s - len, d = sqrtf(ds*ds + q*q);
+        c = swnvg__pixelCdf(hw - d, a, b) - swnvg__pixelCdf(-hw - d, a, b);
+      }
+      else {
+        c = swnvg__pixelCdf(hw - q, a, b) - swnvg__pixelCdf(-hw - q, a, b);
+        if (e->dir & SWNVG__BUTT_START) c *= swnvg__pixelCdf(s, a, b);
+        if (e->dir & SWNVG__BUTT_END) c *= swnvg__pixelCdf(len - s, a, b);
+      }
+      ci = (int)(c*255 + 0.5f);
+      if (ci > cov[ix]) cov[ix] = (unsigned char)ci;
+    }
+    if (ixa <= ixb) {
+      lims[0] = swnvg__mini(lims[0], ixa);
+      lims[1] = swnvg__maxi(lims[1], ixb);
+    }
+  }
+}
+
+static void swnvg__rasterizeLines(SWNVGthreadCtx* r, SWNVGcall* call)
+{
+  SWNVGcontext* gl = r->context;
+  SWNVGedge* chunk = &gl->edges[call->edgeOffset];
+  SWNVGedge* end = chunk + call->edgeCount;
+  float hw = 0.5f*call->lineWidth, pad = hw + 1.0f;
+  int k, y, clip[4] = { swnvg__maxi(call->bounds[0], r->x0), swnvg__maxi(call->bounds[1], r->y0),
+                        swnvg__mini(call->bounds[2], r->x1), swnvg__mini(call->bounds[3], r->y1) };
+  if (clip[0] > clip[2] || clip[1] > clip[3]) return;
+  if (!r->lineCov) {
+    r->lineCov = (unsigned char*)calloc(gl->tileW*gl->tileH, 1);
+    r->lineRows = (int*)malloc(2*gl->tileH*sizeof(int));
+    if (!r->lineCov || !r->lineRows) return;
+  }
+  for (y = clip[1]; y <= clip[3]; ++y) {
+    r->lineRows[2*(y - r->y0)] = clip[2] + 1;
+    r->lineRows[2*(y - r->y0) + 1] = clip[0] - 1;
+  }
+  for (; chunk < end; chunk += chunk->dir + 1) {
+    if (chunk->x0 - pad > clip[2] + 1 || chunk->x1 + pad < clip[0] || chunk->y0 - pad > clip[3] + 1
+        || chunk->y1 + pad < clip[1])
+      continue;
+    for (k = 1; k <= chunk->dir; ++k)
+      swnvg__lineSegment(r, &chunk[k], hw, clip);
+  }
+  for (y = clip[1]; y <= clip[3]; ++y) {
+    int x0 = r->lineRows[2*(y - r->y0)], n = r->lineRows[2*(y - r->y0) + 1] - x0 + 1;
+    unsigned char* cov = &r->lineCov[(y - r->y0)*gl->tileW + x0 - r->x0];
+    if (n <= 0) continue;
+    swnvg__scanlineSolid(r, &gl->bitmap[y*gl->stride + x0*gl->bpp], n, cov, x0, y, call);
+    memset(cov, 0, n);
+  }
+}
+
+static float texFetchF32(SWNVGtexture* tex, int x, int y)
+{
+  float* data = (float*)tex->data;
+  return data[x + y*tex->width];
+}
+
+static float texFetchF32Lerp(SWNVGtexture* tex, float ijx, float ijy, int ijminx, int ijminy, int ijmaxx, int ijmaxy)
+{
+  int ij00x = swnvg__clampi((int)ijx, ijminx, ijmaxx), ij00y = swnvg__clampi((int)ijy, ijminy, ijmaxy);
+  int ij11x = swnvg__clampi((int)ijx + 1, ijminx, ijmaxx), ij11y = swnvg__clampi((int)ijy + 1, ijminy, ijmaxy);
+  float t00 = texFetchF32(tex, ij00x, ij00y);
+  float t10 = texFetchF32(tex, ij11x, ij00y);
+  float t01 = texFetchF32(tex, ij00x, ij11y);
+  float t11 = texFetchF32(tex, ij11x, ij11y);
+  float fx = ijx - (int)ijx, fy = ijy - (int)ijy;
+  //return mix(mix(t00, t10, f.x), mix(t01, t11, f.x), f.y);
+  float t0 = t00 + fx*(t10 - t00);
+  float t1 = t01 + fx*(t11 - t01);
+  return t0 + fy*(t1 - t0);
+}
+
+// recall that we do clamping instead of just adding a border around each glyph because dx,dy could be large
 //  at small font sizes
 static float summedTextCov(SWNVGtexture* tex, float ijx, float ijy, float dx, float dy, int ijminx, int ijminy, int ijmaxx, int ijmaxy)
 {
@@ -779,57 +2826,527 @@ static float superSDF(SWNVGtexture* tex, float s, float dr, float ijx, float ijy
   return 0.25f*(sdfCov(d11, s, dr) + sdfCov(d10, s, dr) + sdfCov(d01, s, dr) + sdfCov(d00, s, dr));
 }
 
-static void swnvg__rasterizeQuad(SWNVGthreadCtx* r, SWNVGcall* call, NVGvertex* v00, NVGvertex* v11)
+typedef struct SWNVGquad {
+  float s00, t00, ds, dt;
+  float sdfoffset, invsdfscale;
+  int ijminx, ijminy, ijmaxx, ijmaxy;  // atlas rect
+  float s11, t11;  // texcoords of opposite corner, for rotated quads
+} SWNVGquad;
+
+static int swnvg__setupQuad(SWNVGcontext* gl, SWNVGcall* call, NVGvertex* v00, SWNVGquad* q)
 {
-  SWNVGcontext* gl = r->context;
-  int x, y;
-  float s00 = call->tex->width * v00->x1;
-  float t00 = call->tex->height * v00->y1;
-  float ds = call->paintMat[0]/2;
-  float dt = call->paintMat[3]/2;
-  float sdfoffset = 0, invsdfscale = 0;  // init to suppress warning
+  int extentx = (int)call->extent[0], extenty = (int)call->extent[1];
+  q->s00 = call->tex->width * v00->x1;
+  q->t00 = call->tex->height * v00->y1;
+  q->ds = call->paintMat[0]/2;
+  q->dt = call->paintMat[3]/2;
+  q->sdfoffset = 0;
+  q->invsdfscale = 0;
   if(gl->flags & NVG_SDF_TEXT) {
-    sdfoffset = call->radius + 0.5f;
-    invsdfscale = 1/(0.5f * 32.0f*call->paintMat[0]);  // 0.5 - we're sampling 4 0.5x0.5 subpixels
+    q->sdfoffset = call->radius + 0.5f;
+    q->invsdfscale = 1/(0.5f * 32.0f*call->paintMat[0]);  // 0.5 - we're sampling 4 0.5x0.5 subpixels
   }
-
-  int linear = call->flags & NVG_SRGB;
-  int cr = COLOR0(call->innerCol);
-  int cg = COLOR1(call->innerCol);
-  int cb = COLOR2(call->innerCol);
-  int ca = COLOR3(call->innerCol);
-
-  int extentx = (int)call->extent[0], extenty = (int)call->extent[1];
   // use texcoord center to figure out which atlas rect we are reading from
   //int ijminx = ((int)(0.5f*(v00->x1 + v11->x1)*tex->width/extentx + 0.5f))*extentx;
   //int ijminy = ((int)(0.5f*(v00->y1 + v11->y1)*tex->height/extenty + 0.5f))*extenty;
-  int ijminx = ((int)(s00/extentx + 0.5f))*extentx, ijminy = ((int)(t00/extenty + 0.5f))*extenty;
-  int ijmaxx = ijminx + extentx - 1, ijmaxy = ijminy + extenty - 1;
-  if(ijminx < 0 || ijminy < 0) return;  // something went wrong
+  q->ijminx = ((int)(q->s00/extentx + 0.5f))*extentx;
+  q->ijminy = ((int)(q->t00/extenty + 0.5f))*extenty;
+  q->ijmaxx = q->ijminx + extentx - 1;
+  q->ijmaxy = q->ijminy + extenty - 1;
+  return q->ijminx >= 0 && q->ijminy >= 0;  // something went wrong if < 0
+}
+
+// coverage for n pixels of row of atlas quad, starting at texcoord s, t
+static void swnvg__quadCoverRow(SWNVGcontext* gl, SWNVGcall* call, const SWNVGquad* q, unsigned char* sl, int n, float s, float t)
+{
+  int x;
+  float cover;
+  for(x = 0; x < n; ++x) {
+    if(gl->flags & NVG_SDF_TEXT)
+      cover = superSDF(call->tex, q->invsdfscale, q->sdfoffset, s, t, q->ds/2, q->dt/2);
+    else
+      cover = summedTextCov(call->tex, s, t, q->ds, q->dt, q->ijminx, q->ijminy, q->ijmaxx, q->ijmaxy);
+    sl[x] = (unsigned char)(255.0f*cover + 0.5f);
+    s += 2*q->ds;
+  }
+}
+
+static void swnvg__rasterizeQuad(SWNVGthreadCtx* r, SWNVGcall* call, NVGvertex* v00, NVGvertex* v11, int glyph)
+{
+  SWNVGcontext* gl = r->context;
+  int y;
+  SWNVGquad q;
+  if(glyph >= 0) {
+    // blit cached coverage
+    SWNVGglyph* g = &gl->glyphs[glyph];
+    int x0 = (int)floorf(v00->x0 - g->fx + 0.5f), y0 = (int)floorf(v00->y0 - g->fy + 0.5f);
+    int xmin = swnvg__maxi(swnvg__maxi(call->bounds[0], r->x0), x0);
+    int ymin = swnvg__maxi(swnvg__maxi(call->bounds[1], r->y0), y0);
+    int xmax = swnvg__mini(swnvg__mini(call->bounds[2], r->x1), x0 + g->w - 1);
+    int ymax = swnvg__mini(swnvg__mini(call->bounds[3], r->y1), y0 + g->h - 1);
+    if(xmin > xmax) return;  // glyph's quad overlaps tile, but its cached coverage doesn't
+    for(y = ymin; y <= ymax; ++y) {
+      const unsigned char* cover = &g->cover[(y - y0)*g->w + xmin - x0];
+      swnvg__blendCall(r, call, &gl->bitmap[y*gl->stride + xmin*gl->bpp], NULL, call->innerCol, cover, xmax - xmin + 1);
+    }
+    return;
+  }
+  if(!swnvg__setupQuad(gl, call, v00, &q)) return;
 
   int xmin = swnvg__maxi(swnvg__maxi(call->bounds[0], r->x0), (int)v00->x0);
   int ymin = swnvg__maxi(swnvg__maxi(call->bounds[1], r->y0), (int)v00->y0);
   int xmax = swnvg__mini(swnvg__mini(call->bounds[2], r->x1), (int)(ceilf(v11->x0)));
   int ymax = swnvg__mini(swnvg__mini(call->bounds[3], r->y1), (int)(ceilf(v11->y0)));
   if(ymin > ymax || xmin > xmax) return;
-  float s0 = s00 - 2*ds*(v00->x0 - xmin - 0.25f);  // not sure why we need ds/2 shift to get correct pos
-  float t = t00 - 2*dt*(v00->y0 - ymin - 0.25f);
+  float s0 = q.s00 - 2*q.ds*(v00->x0 - xmin - 0.25f);  // not sure why we need ds/2 shift to get correct pos
+  float t = q.t00 - 2*q.dt*(v00->y0 - ymin - 0.25f);
+  unsigned char* sl = r->scanline;
+  for(y = ymin; y <= ymax; ++y) {
+    swnvg__quadCoverRow(gl, call, &q, sl, xmax - xmin + 1, s0, t);
+    swnvg__blendCall(r, call, &gl->bitmap[y*gl->stride + xmin*gl->bpp], NULL, call->innerCol, sl, xmax - xmin + 1);
+    t += 2*q.dt;
+  }
+  memset(sl, 0, xmax - xmin + 1);  // scanline must be left cleared
+}
+
+// setup for rotated or skewed atlas quad; cx, cy get quad corners (s0,t0), (s1,t0), (s1,t1), (s0,t1) rebuilt
+//  from inverse of call->quadMat
+static int swnvg__setupAffineQuad(SWNVGcontext* gl, SWNVGcall* call, NVGvertex* v00, NVGvertex* v11,
+    SWNVGquad* q, float* cx, float* cy)
+{
+  const float* m = call->quadMat;
+  float det = m[0]*m[3] - m[1]*m[2];
+  float es = (v11->x1 - v00->x1)*call->tex->width, et = (v11->y1 - v00->y1)*call->tex->height;
+  if(det == 0 || !swnvg__setupQuad(gl, call, v00, q)) return 0;
+  // pixel footprint in atlas; using lengths keeps box filter area correct under rotation
+  q->ds = 0.5f*swnvg__lengthf(m[0], m[1]);
+  q->dt = 0.5f*swnvg__lengthf(m[2], m[3]);
+  if(gl->flags & NVG_SDF_TEXT)
+    q->invsdfscale = 1/(0.5f * 32.0f*2*q->ds);
+  q->s11 = q->s00 + es;
+  q->t11 = q->t00 + et;
+  cx[0] = v00->x0;  cy[0] = v00->y0;
+  cx[1] = cx[0] + m[3]*es/det;  cy[1] = cy[0] - m[2]*es/det;
+  cx[2] = v11->x0;  cy[2] = v11->y0;
+  cx[3] = cx[0] - m[1]*et/det;  cy[3] = cy[0] + m[0]*et/det;
+  return 1;
+}
+
+// x extent [*x0, *x1) of pixels touched by quad in row y to y+1, found by clipping edges to row
+static int swnvg__quadRowSpan(const float* cx, const float* cy, float y, int* x0, int* x1)
+{
+  int i;
+  float xlo = 1E6f, xhi = -1E6f;
+  for(i = 0; i < 4; ++i) {
+    float ax = cx[i], ay = cy[i], bx = cx[(i+1)%4], by = cy[(i+1)%4];
+    float ylo = swnvg__maxf(swnvg__minf(ay, by), y), yhi = swnvg__minf(swnvg__maxf(ay, by), y + 1);
+    if(ylo > yhi) continue;
+    if(ay != by) {
+      float xa = ax + (ylo - ay)*(bx - ax)/(by - ay), xb = ax + (yhi - ay)*(bx - ax)/(by - ay);
+      ax = xa;  bx = xb;
+    }
+    xlo = swnvg__minf(xlo, swnvg__minf(ax, bx));
+    xhi = swnvg__maxf(xhi, swnvg__maxf(ax, bx));
+  }
+  *x0 = (int)floorf(xlo);
+  *x1 = (int)ceilf(xhi);
+  return xlo <= xhi;
+}
+
+// coverage for n pixels of row of rotated or skewed atlas quad, starting from pixel (x, y)
+static void swnvg__affineCoverRow(SWNVGcontext* gl, SWNVGcall* call, const SWNVGquad* q, const float* cx,
+    const float* cy, unsigned char* sl, int n, float x, float y)
+{
+  const float* m = call->quadMat;
+  // same 0.25 pixel shift as axis-aligned case, applied in atlas space
+  float s = q->s00 + m[0]*(x - cx[0]) + m[1]*(y - cy[0]) + 0.5f*q->ds;
+  float t = q->t00 + m[2]*(x - cx[0]) + m[3]*(y - cy[0]) + 0.5f*q->dt;
   float cover;
+  int i;
+  for(i = 0; i < n; ++i) {
+    // pixels on quad edge can map outside quad (which has empty padding), and superSDF doesn't clamp
+    if(s < q->s00 || t < q->t00 || s >= q->s11 || t >= q->t11)
+      cover = 0;
+    else if(gl->flags & NVG_SDF_TEXT)
+      cover = superSDF(call->tex, q->invsdfscale, q->sdfoffset, s, t, q->ds/2, q->dt/2);
+    else
+      cover = summedTextCov(call->tex, s, t, q->ds, q->dt, q->ijminx, q->ijminy, q->ijmaxx, q->ijmaxy);
+    sl[i] = (unsigned char)(255.0f*cover + 0.5f);
+    s += m[0];
+    t += m[2];
+  }
+}
+
+// only pixels touching quad are sampled, at texcoords obtained by mapping pixel back to atlas
+static void swnvg__rasterizeAffineQuad(SWNVGthreadCtx* r, SWNVGcall* call, NVGvertex* v00, NVGvertex* v11)
+{
+  SWNVGcontext* gl = r->context;
+  int y, ymin, ymax, xmin, xmax;
+  float cx[4], cy[4];
+  unsigned char* sl = r->scanline;
+  SWNVGquad q;
+  if(!swnvg__setupAffineQuad(gl, call, v00, v11, &q, cx, cy)) return;
+  ymin = swnvg__maxi(swnvg__maxi(call->bounds[1], r->y0),
+      (int)floorf(swnvg__minf(swnvg__minf(cy[0], cy[1]), swnvg__minf(cy[2], cy[3]))));
+  ymax = swnvg__mini(swnvg__mini(call->bounds[3], r->y1),
+      (int)ceilf(swnvg__maxf(swnvg__maxf(cy[0], cy[1]), swnvg__maxf(cy[2], cy[3]))));
   for(y = ymin; y <= ymax; ++y) {
-    unsigned char* dst = &gl->bitmap[y*gl->stride + xmin*4];
-    float s = s0;
-    for(x = xmin; x <= xmax; ++x) {
-      if(gl->flags & NVG_SDF_TEXT)
-        cover = superSDF(call->tex, invsdfscale, sdfoffset, s, t, ds/2, dt/2);
-      else
-        cover = summedTextCov(call->tex, s, t, ds, dt, ijminx, ijminy, ijmaxx, ijmaxy);
-      swnvg__blend8888(dst, (int)(255.0f*cover + 0.5f), cr, cg, cb, ca, linear);
-      s += 2*ds;
-      dst += 4;
+    if(!swnvg__quadRowSpan(cx, cy, (float)y, &xmin, &xmax)) continue;
+    xmin = swnvg__maxi(swnvg__maxi(call->bounds[0], r->x0), xmin);
+    xmax = swnvg__mini(swnvg__mini(call->bounds[2], r->x1), xmax - 1);
+    if(xmin > xmax) continue;
+    swnvg__affineCoverRow(gl, call, &q, cx, cy, sl, xmax - xmin + 1, (float)xmin, (float)y);
+    swnvg__blendCall(r, call, &gl->bitmap[y*gl->stride + xmin*gl->bpp], NULL, call->innerCol, sl, xmax - xmin + 1);
+    memset(sl, 0, xmax - xmin + 1);  // scanline must be left cleared
+  }
+}
+
+// FNV-1a, one 32-bit word at a time
+static unsigned long long swnvg__hashWords(unsigned long long h, const void* data, size_t nbytes)
+{
+  size_t i;
+  const unsigned int* w = (const unsigned int*)data;
+  for (i = 0; i < nbytes/4; ++i)
+    h = (h ^ w[i]) * 0x100000001B3ULL;
+  return h;
+}
+
+// glyph coverage cache
+#define SWNVG__GLYPH_SUBPIX 4  // subpixel x positions per pixel
+
+static unsigned int swnvg__floatBits(float f)
+{
+  unsigned int u;
+  memcpy(&u, &f, 4);
+  return u;
+}
+
+static unsigned int swnvg__glyphBucket(SWNVGcontext* gl, const unsigned int* key)
+{
+  return (unsigned int)swnvg__hashWords(0xCBF29CE484222325ULL, key, 4*SWNVG__GLYPH_KEYLEN) & (gl->nglyphHash - 1);
+}
+
+static void swnvg__lruRemove(SWNVGcontext* gl, int i)
+{
+  SWNVGglyph* g = &gl->glyphs[i];
+  if (g->lruPrev >= 0) gl->glyphs[g->lruPrev].lruNext = g->lruNext; else gl->lruHead = g->lruNext;
+  if (g->lruNext >= 0) gl->glyphs[g->lruNext].lruPrev = g->lruPrev; else gl->lruTail = g->lruPrev;
+}
+
+static void swnvg__lruPush(SWNVGcontext* gl, int i)
+{
+  SWNVGglyph* g = &gl->glyphs[i];
+  g->lruPrev = -1;
+  g->lruNext = gl->lruHead;
+  if (gl->lruHead >= 0) gl->glyphs[gl->lruHead].lruPrev = i; else gl->lruTail = i;
+  gl->lruHead = i;
+}
+
+static void swnvg__removeGlyph(SWNVGcontext* gl, int i)
+{
+  SWNVGglyph* g = &gl->glyphs[i];
+  int* link = &gl->glyphHash[swnvg__glyphBucket(gl, g->key)];
+  while (*link != i)
+    link = &gl->glyphs[*link].next;
+  *link = g->next;
+  swnvg__lruRemove(gl, i);
+  gl->glyphBytes -= g->w*g->h + sizeof(SWNVGglyph);
+  free(g->cover);
+  memset(g, 0, sizeof(SWNVGglyph));  // key[0] = 0 (texture id) marks free entry
+  g->next = gl->freeGlyph;
+  gl->freeGlyph = i;
+}
+
+// remove glyphs reading rows y0 to y1 of texture, e.g., after texture update
+static void swnvg__invalidateGlyphs(SWNVGcontext* gl, int texId, int y0, int y1)
+{
+  int i;
+  for (i = 0; i < gl->nglyphs; ++i) {
+    SWNVGglyph* g = &gl->glyphs[i];
+    if ((int)g->key[0] == texId && texId != 0 && g->texRows[0] <= y1 && g->texRows[1] >= y0)
+      swnvg__removeGlyph(gl, i);
+  }
+}
+
+static int swnvg__resizeGlyphHash(SWNVGcontext* gl, int n)
+{
+  int i;
+  int* hash = (int*)realloc(gl->glyphHash, n*sizeof(int));
+  if (!hash) return 0;
+  gl->glyphHash = hash;
+  gl->nglyphHash = n;
+  for (i = 0; i < n; ++i)
+    hash[i] = -1;
+  for (i = 0; i < gl->nglyphs; ++i) {
+    SWNVGglyph* g = &gl->glyphs[i];
+    if (g->key[0] == 0) continue;
+    g->next = hash[swnvg__glyphBucket(gl, g->key)];
+    hash[swnvg__glyphBucket(gl, g->key)] = i;
+  }
+  return 1;
+}
+
+static int swnvg__allocGlyph(SWNVGcontext* gl)
+{
+  int i;
+  if (gl->freeGlyph >= 0) {
+    i = gl->freeGlyph;
+    gl->freeGlyph = gl->glyphs[i].next;
+    return i;
+  }
+  if (gl->nglyphs+1 > gl->cglyphs) {
+    int cglyphs = swnvg__maxi(gl->nglyphs+1, 256) + gl->cglyphs/2; // 1.5x Overallocate
+    SWNVGglyph* glyphs = (SWNVGglyph*)realloc(gl->glyphs, sizeof(SWNVGglyph)*cglyphs);
+    if (glyphs == NULL) return -1;
+    gl->glyphs = glyphs;
+    gl->cglyphs = cglyphs;
+  }
+  // keep load factor <= 1
+  if (gl->nglyphs+1 > gl->nglyphHash && !swnvg__resizeGlyphHash(gl, swnvg__maxi(2*gl->nglyphHash, 256)))
+    return -1;
+  memset(&gl->glyphs[gl->nglyphs], 0, sizeof(SWNVGglyph));
+  return gl->nglyphs++;
+}
+
+// find or create cache entry for atlas quad; coverage for new entries is filled in by swnvg__renderGlyph
+static int swnvg__cacheGlyph(SWNVGcontext* gl, SWNVGcall* call, NVGvertex* v00, NVGvertex* v11)
+{
+  unsigned int key[SWNVG__GLYPH_KEYLEN];
+  float fx = v00->x0 - floorf(v00->x0), fy = v00->y0 - floorf(v00->y0);
+  int subpix = (int)(fx*SWNVG__GLYPH_SUBPIX + 0.5f) % SWNVG__GLYPH_SUBPIX;
+  int i, w, h;
+  size_t bytes;
+  unsigned int bucket;
+  SWNVGquad q;
+  SWNVGglyph* g;
+  if (!call->tex) return -1;
+  key[0] = call->tex->id;
+  key[1] = swnvg__floatBits(v00->x1);
+  key[2] = swnvg__floatBits(v00->y1);
+  key[3] = swnvg__floatBits(v11->x1);
+  key[4] = swnvg__floatBits(v11->y1);
+  key[5] = swnvg__floatBits(call->paintMat[0]);
+  key[6] = swnvg__floatBits(call->paintMat[3]);
+  key[7] = swnvg__floatBits(call->radius);
+  key[8] = subpix;
+  key[9] = swnvg__floatBits(fy);
+  key[10] = call->affineQuads;
+  key[11] = key[12] = 0;
+  if (call->affineQuads) {
+    // rotated text isn't on integer baseline, so quantize y offset too
+    fy = (float)((int)(fy*SWNVG__GLYPH_SUBPIX + 0.5f) % SWNVG__GLYPH_SUBPIX)/SWNVG__GLYPH_SUBPIX;
+    key[5] = swnvg__floatBits(call->quadMat[0]);
+    key[6] = swnvg__floatBits(call->quadMat[3]);
+    key[9] = swnvg__floatBits(fy);
+    key[11] = swnvg__floatBits(call->quadMat[1]);
+    key[12] = swnvg__floatBits(call->quadMat[2]);
+  }
+  if (gl->nglyphHash > 0) {
+    for (i = gl->glyphHash[swnvg__glyphBucket(gl, key)]; i >= 0; i = gl->glyphs[i].next) {
+      if (memcmp(gl->glyphs[i].key, key, sizeof(key)) == 0) {
+        swnvg__lruRemove(gl, i);
+        swnvg__lruPush(gl, i);
+        gl->glyphs[i].frame = gl->frame;
+        return i;
+      }
+    }
+  }
+  fx = (float)subpix/SWNVG__GLYPH_SUBPIX;
+  if (call->affineQuads) {
+    // place quad origin so that all corners have non-negative coords in glyph bitmap
+    float cx[4], cy[4], xmin, ymin;
+    if (!swnvg__setupAffineQuad(gl, call, v00, v11, &q, cx, cy)) return -1;
+    xmin = swnvg__minf(swnvg__minf(cx[0], cx[1]), swnvg__minf(cx[2], cx[3])) - cx[0];
+    ymin = swnvg__minf(swnvg__minf(cy[0], cy[1]), swnvg__minf(cy[2], cy[3])) - cy[0];
+    fx += ceilf(-xmin - fx);
+    fy += ceilf(-ymin - fy);
+    w = (int)ceilf(fx + swnvg__maxf(swnvg__maxf(cx[0], cx[1]), swnvg__maxf(cx[2], cx[3])) - cx[0]) + 1;
+    h = (int)ceilf(fy + swnvg__maxf(swnvg__maxf(cy[0], cy[1]), swnvg__maxf(cy[2], cy[3])) - cy[0]) + 1;
+  }
+  else {
+    if (!swnvg__setupQuad(gl, call, v00, &q)) return -1;
+    w = (int)ceilf(fx + v11->x0 - v00->x0) + 1;
+    h = (int)ceilf(fy + v11->y0 - v00->y0) + 1;
+  }
+  bytes = w*h + sizeof(SWNVGglyph);
+  if (bytes > gl->maxGlyphBytes/16) return -1;  // don't let a few large glyphs flush cache
+  // evict least recently used glyphs not drawn in this frame
+  while (gl->glyphBytes + bytes > gl->maxGlyphBytes && gl->lruTail >= 0 && gl->glyphs[gl->lruTail].frame != gl->frame)
+    swnvg__removeGlyph(gl, gl->lruTail);
+  if (gl->glyphBytes + bytes > gl->maxGlyphBytes) return -1;
+  if (gl->nnewGlyphs+1 > gl->cnewGlyphs) {
+    int cnew = swnvg__maxi(gl->nnewGlyphs+1, 64) + gl->cnewGlyphs/2;
+    int* newGlyphs = (int*)realloc(gl->newGlyphs, sizeof(int)*cnew);
+    if (!newGlyphs) return -1;
+    gl->newGlyphs = newGlyphs;
+    gl->cnewGlyphs = cnew;
+  }
+  i = swnvg__allocGlyph(gl);
+  if (i < 0) return -1;
+  g = &gl->glyphs[i];
+  g->cover = (unsigned char*)malloc(w*h);
+  if (!g->cover) {
+    g->next = gl->freeGlyph;
+    gl->freeGlyph = i;
+    return -1;
+  }
+  memcpy(g->key, key, sizeof(key));
+  g->w = w;
+  g->h = h;
+  g->fx = fx;
+  g->fy = fy;
+  g->texRows[0] = q.ijminy;
+  g->texRows[1] = q.ijmaxy;
+  g->frame = gl->frame;
+  g->call = call;
+  g->v00 = v00;
+  g->v11 = v11;
+  bucket = swnvg__glyphBucket(gl, key);
+  g->next = gl->glyphHash[bucket];
+  gl->glyphHash[bucket] = i;
+  swnvg__lruPush(gl, i);
+  gl->glyphBytes += bytes;
+  gl->newGlyphs[gl->nnewGlyphs++] = i;
+  return i;
+}
+
+static void swnvg__renderGlyph(SWNVGcontext* gl, SWNVGglyph* g)
+{
+  int y;
+  SWNVGquad q;
+  if (g->call->affineQuads) {
+    // corners relative to glyph bitmap
+    int x0, x1, i;
+    float cx[4], cy[4];
+    memset(g->cover, 0, g->w*g->h);
+    swnvg__setupAffineQuad(gl, g->call, g->v00, g->v11, &q, cx, cy);
+    for (i = 3; i >= 0; --i) {
+      cx[i] += g->fx - cx[0];
+      cy[i] += g->fy - cy[0];
+    }
+    for (y = 0; y < g->h; ++y) {
+      if (!swnvg__quadRowSpan(cx, cy, (float)y, &x0, &x1)) continue;
+      x0 = swnvg__maxi(x0, 0);
+      x1 = swnvg__mini(x1, g->w);
+      if (x0 < x1)
+        swnvg__affineCoverRow(gl, g->call, &q, cx, cy, &g->cover[y*g->w + x0], x1 - x0, (float)x0, (float)y);
+    }
+    return;
+  }
+  swnvg__setupQuad(gl, g->call, g->v00, &q);
+  float s0 = q.s00 - 2*q.ds*(g->fx - 0.25f);
+  float t = q.t00 - 2*q.dt*(g->fy - 0.25f);
+  for(y = 0; y < g->h; ++y) {
+    swnvg__quadCoverRow(gl, g->call, &q, &g->cover[y*g->w], g->w, s0, t);
+    t += 2*q.dt;
+  }
+}
+
+typedef struct SWNVGglyphTask {
+  SWNVGcontext* gl;
+  int start, end;
+} SWNVGglyphTask;
+
+static void swnvg__glyphTask(void* arg)
+{
+  SWNVGglyphTask* task = (SWNVGglyphTask*)arg;
+  int i;
+  NVG_TRACE_BEGIN("renderGlyphs", task->end - task->start);
+  for (i = task->start; i < task->end; ++i)
+    swnvg__renderGlyph(task->gl, &task->gl->glyphs[task->gl->newGlyphs[i]]);
+  NVG_TRACE_END("renderGlyphs");
+}
+
+// look up cached coverage for all atlas quads in frame, then render coverage for new glyphs
+static void swnvg__updateGlyphs(SWNVGcontext* gl)
+{
+  int i, j, k = 0, nquads = 0, nthreads = swnvg__mini(gl->xthreads*gl->ythreads, 64);
+  gl->frame++;
+  gl->nnewGlyphs = 0;
+  if (gl->maxGlyphBytes == 0 || (gl->flags & NVGSW_SDFGEN)) return;
+  for (i = 0; i < gl->ncalls; ++i) {
+    if (gl->calls[i].type == SWNVG_PAINT_ATLAS)
+      nquads += gl->calls[i].triangleCount/2;
+  }
+  if (nquads > gl->cquadGlyphs) {
+    int* quadGlyphs = (int*)realloc(gl->quadGlyphs, sizeof(int)*(nquads + gl->cquadGlyphs/2));
+    if (!quadGlyphs) return;
+    gl->quadGlyphs = quadGlyphs;
+    gl->cquadGlyphs = nquads + gl->cquadGlyphs/2;
+  }
+  for (i = 0; i < gl->ncalls; ++i) {
+    SWNVGcall* call = &gl->calls[i];
+    NVGvertex* verts = &gl->verts[call->triangleOffset];
+    if (call->type != SWNVG_PAINT_ATLAS) continue;
+    call->glyphOffset = k;
+    for (j = 0; j < call->triangleCount; j += 2)
+      gl->quadGlyphs[k++] = swnvg__cacheGlyph(gl, call, &verts[j], &verts[j+1]);
+  }
+  if (nthreads > 1 && gl->nnewGlyphs >= 4*nthreads) {
+    SWNVGglyphTask tasks[64];
+    for (i = 0; i < nthreads; ++i) {
+      tasks[i].gl = gl;
+      tasks[i].start = (i*gl->nnewGlyphs)/nthreads;
+      tasks[i].end = ((i+1)*gl->nnewGlyphs)/nthreads;
+      swnvg__submit(gl, swnvg__glyphTask, &tasks[i]);
     }
-    t += 2*dt;
+    swnvg__wait(gl);
+  }
+  else {
+    for (i = 0; i < gl->nnewGlyphs; ++i)
+      swnvg__renderGlyph(gl, &gl->glyphs[gl->newGlyphs[i]]);
+  }
+}
+
+static void swnvg__freeTexture(SWNVGcontext* gl, SWNVGtexture* tex)
+{
+  if(!(tex->flags & NVG_IMAGE_NOCOPY))
+    free(tex->data);
+  free(tex->mips);
+  swnvg__invalidateGlyphs(gl, tex->id, 0, tex->height);
+  memset(tex, 0, sizeof(SWNVGtexture));
+}
+
+static void swnvg__releaseTextures(SWNVGcontext* gl)
+{
+  int i;
+  for (i = 0; i < gl->ntextures; i++) {
+    if (gl->textures[i].release)
+      swnvg__freeTexture(gl, &gl->textures[i]);
+  }
+}
+
+#ifdef NVG_FRAME_STATS
+static void swnvg__threadStats(SWNVGcontext* gl)
+{
+  int i, nthreads = gl->xthreads*gl->ythreads;
+  gl->stats.nthreads = swnvg__mini(nthreads, NVG_STATS_MAX_THREADS);
+  for (i = 0; i < nthreads; ++i) {
+    SWNVGthreadCtx* r = &gl->threads[i];
+    gl->stats.pixelsCovered += r->statCovered;
+    gl->stats.pixelsBlended += r->statBlended;
+    gl->stats.sortMs += r->statSortMs;
+    if (i < NVG_STATS_MAX_THREADS)
+      gl->stats.rasterizeMs[i] = r->statRasterMs;
   }
 }
+#endif
+
+// wait for frame submitted with NVGSW_ASYNC
+static void swnvg__finishFrame(SWNVGcontext* gl)
+{
+  int i, nthreads = gl->xthreads*gl->ythreads;
+  if (!gl->inFlight) return;
+  swnvg__wait(gl);
+  gl->inFlight = 0;
+  for (i = 0; i < nthreads; ++i) {
+    gl->threads[i].context = gl;
+    gl->culledCalls += gl->threads[i].culledCalls;
+    gl->culledPixels += gl->threads[i].culledPixels;
+  }
+  NVG_STAT(swnvg__threadStats(gl));
+  swnvg__releaseTextures(gl);
+}
 
 static SWNVGtexture* swnvg__allocTexture(SWNVGcontext* gl)
 {
@@ -846,6 +3363,7 @@ static SWNVGtexture* swnvg__allocTexture(SWNVGcontext* gl)
     if (gl->ntextures+1 > gl->ctextures) {
       SWNVGtexture* textures;
       int ctextures = swnvg__maxi(gl->ntextures+1, 4) +  gl->ctextures/2; // 1.5x Overallocate
+      swnvg__finishFrame(gl);  // calls in flight point into textures
       textures = (SWNVGtexture*)realloc(gl->textures, sizeof(SWNVGtexture)*ctextures);
       if (textures == NULL) return NULL;
       gl->textures = textures;
@@ -864,7 +3382,7 @@ static SWNVGtexture* swnvg__findTexture(SWNVGcontext* gl, int id)
   int i;
   if (!id) return NULL;
   for (i = 0; i < gl->ntextures; i++)
-    if (gl->textures[i].id == id)
+    if (gl->textures[i].id == id && !gl->textures[i].release)
       return &gl->textures[i];
   return NULL;
 }
@@ -874,7 +3392,7 @@ static int swnvg__renderCreate(void* uptr)
   static int staticInited = 0;
 #ifndef NVGSW_QUIET_FRAME
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
-  NVG_LOG("nvg2: software renderer%s\n", gl->flags & NVGSW_PATHS_XC ? " (XC)" : "");
+  NVG_LOG("nvg2: software renderer (%s%s)\n", gl->kernelName, gl->flags & NVGSW_PATHS_XC ? ", XC" : "");
 #endif
   if(!staticInited) {
     swnvg__sRGBLUTCalc();
@@ -889,7 +3407,17 @@ static void swnvg__copyRGBAData(SWNVGcontext* gl, SWNVGtexture* tex, const void*
   int npix = tex->width*tex->height;
   rgba32_t* dest = (rgba32_t*)tex->data;
   rgba32_t* src = (rgba32_t*)data;
-  if(tex->flags & NVG_IMAGE_PREMULTIPLIED) {
+  int premul = gl->flags & NVGSW_PREMULTIPLIED;
+  if(premul && !(tex->flags & NVG_IMAGE_PREMULTIPLIED)) {
+    for(ii = 0; ii < npix; ++ii, ++dest, ++src) {
+      int a = COLOR3(*src);
+      int r = (COLOR0(*src)*a + 127)/255;
+      int g = (COLOR1(*src)*a + 127)/255;
+      int b = (COLOR2(*src)*a + 127)/255;
+      *dest = (r << gl->rshift | g << gl->gshift | b << gl->bshift | a << gl->ashift);
+    }
+  }
+  else if(!premul && (tex->flags & NVG_IMAGE_PREMULTIPLIED)) {
     // undo premultiplication
     for(ii = 0; ii < npix; ++ii, ++dest, ++src) {
       int r = COLOR0(*src);
@@ -913,6 +3441,15 @@ static void swnvg__copyRGBAData(SWNVGcontext* gl, SWNVGtexture* tex, const void*
   }
 }
 
+static int swnvg__isOpaque(const rgba32_t* data, int npix)
+{
+  int i;
+  for(i = 0; i < npix; ++i) {
+    if(!RGBA32_IS_OPAQUE(data[i])) return 0;
+  }
+  return 1;
+}
+
 static int swnvg__renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const void* data)
 {
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
@@ -922,13 +3459,16 @@ static int swnvg__renderCreateTexture(void* uptr, int type, int w, int h, int im
     tex->data = (void*)data;
   else {
     size_t nbytes = tex->type == NVG_TEXTURE_ALPHA ? w*h : w*h*4;
-    tex->data = malloc(nbytes);
+    // cleared if no data, as rows never updated (e.g., in font atlas) can still be sampled by filtering
+    tex->data = data ? malloc(nbytes) : calloc(nbytes, 1);
     if(!data) {}
     else if(tex->type == NVG_TEXTURE_RGBA)
       swnvg__copyRGBAData(gl, tex, data);
     else
       memcpy(tex->data, data, nbytes);
   }
+  if(data && type == NVG_TEXTURE_RGBA)
+    tex->opaque = swnvg__isOpaque((rgba32_t*)tex->data, w*h);
   return tex->id;
 }
 
@@ -937,9 +3477,10 @@ static int swnvg__renderDeleteTexture(void* uptr, int image)
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
   SWNVGtexture* tex = swnvg__findTexture(gl, image);
   if(!tex) return 0;
-  if(!(tex->flags & NVG_IMAGE_NOCOPY))
-    free(tex->data);
-  memset(tex, 0, sizeof(SWNVGtexture));
+  if(gl->inFlight)
+    tex->release = 1;
+  else
+    swnvg__freeTexture(gl, tex);
   return 1;
 }
 
@@ -948,13 +3489,19 @@ static int swnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
   SWNVGtexture* tex = swnvg__findTexture(gl, image);
   if(!tex) return 0;
-  if(tex->type == NVG_TEXTURE_RGBA)
+  swnvg__finishFrame(gl);
+  if(tex->type == NVG_TEXTURE_RGBA) {
     swnvg__copyRGBAData(gl, tex, data);  // only full update for now
+    tex->opaque = swnvg__isOpaque((rgba32_t*)tex->data, tex->width*tex->height);
+  }
   else {
     int nb = tex->type == NVG_TEXTURE_FLOAT ? 4 : 1;
     int dy = y*tex->width*nb;
     memcpy((char*)tex->data + dy, (const char*)data + dy, tex->width*h*nb);  // no support for partial width
   }
+  tex->generation++;
+  tex->mipsValid = 0;
+  swnvg__invalidateGlyphs(gl, tex->id, y, y + h - 1);
   return 1;
 }
 
@@ -976,6 +3523,7 @@ static void swnvg__renderCancel(void* uptr)
   gl->nverts = 0;
   gl->nedges = 0;
   gl->ncalls = 0;
+  gl->nramps = 0;
 }
 
 // exact coverage rasterization based on GPU renderer (nanovg_gl.h)
@@ -983,7 +3531,7 @@ static void swnvg__renderCancel(void* uptr)
 //  recalculate integer coverage for every pixel of solid runs.  With this change, performance matches non-XC
 //  for big paths and beats non-XC for small paths.
 
-static void swnvg__addEdgeXC(SWNVGcontext* r, NVGvertex* vtx, float xmax)
+static void swnvg__addEdgeXC(SWNVGcontext* r, NVGvertex* vtx)
 {
   SWNVGedge* e;
   // Skip horizontal edges
@@ -999,7 +3547,7 @@ static void swnvg__addEdgeXC(SWNVGcontext* r, NVGvertex* vtx, float xmax)
   e->y0 = vtx->y0;
   e->x1 = vtx->x1;
   e->y1 = vtx->y1;
-  e->dir = ceilf(xmax);
+  e->dir = 0;  // unused, but edges are hashed for damage tracking
 }
 
 // unfortunately, the signs in coversCenter() and areaEdge() are all messed up vs. GLSL version
@@ -1033,6 +3581,15 @@ static float areaEdge(float v0x, float v0y, float v1x, float v1y, float slope)
   return area * width;
 }
 
+// round coverage to a multiple of 2^-12 so that float sums of differences are exact, making result independent
+//  of order of accumulation and thus of tile origin (tile width depends on thread count)
+static float swnvg__quantCov(float c)
+{
+  return (int)(c*4096.0f + (c < 0 ? -0.5f : 0.5f))*(1.0f/4096.0f);
+}
+
+#define SWNVG__SDF_FAR 1E30f  // initial squared distance for SDF generation
+
 static float distToEdge2(float dx, float dy, float invl2, float px, float py)
 {
   // Consider the line extending the segment, parameterized as start + t*(end - start).
@@ -1047,6 +3604,42 @@ static float distToEdge2(float dx, float dy, float invl2, float px, float py)
   return qx*qx + qy*qy;
 }
 
+// update squared distance to edge (dx, dy from edge start x0) for pixels ix0 - ix1 of row at py from edge start
+static void swnvg__sdfRow(float* dist, int ix0, int ix1, float py, float x0, float dx, float dy, float invl2)
+{
+  int ix = ix0;
+#if defined(SWNVG__SSE2)
+  __m128 vdx = _mm_set1_ps(dx), vdy = _mm_set1_ps(dy), vinvl2 = _mm_set1_ps(invl2), vx0 = _mm_set1_ps(x0);
+  __m128 vpy = _mm_set1_ps(py), pydy = _mm_set1_ps(py*dy), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+  __m128 cx = _mm_add_ps(_mm_set1_ps(0.5f), _mm_cvtepi32_ps(_mm_setr_epi32(ix, ix+1, ix+2, ix+3)));
+  for(; ix + 3 <= ix1; ix += 4, dist += 4) {
+    __m128 px = _mm_sub_ps(cx, vx0);
+    __m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(px, vdx), pydy), vinvl2);
+    t = _mm_min_ps(_mm_max_ps(t, zero), one);
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(t, vdx), px), qy = _mm_sub_ps(_mm_mul_ps(t, vdy), vpy);
+    __m128 d2 = _mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy));
+    _mm_storeu_ps(dist, _mm_min_ps(_mm_loadu_ps(dist), d2));
+    cx = _mm_add_ps(cx, _mm_set1_ps(4.f));
+  }
+#elif defined(SWNVG__NEON)
+  float32x4_t vdx = vdupq_n_f32(dx), vdy = vdupq_n_f32(dy), vinvl2 = vdupq_n_f32(invl2), vx0 = vdupq_n_f32(x0);
+  float32x4_t vpy = vdupq_n_f32(py), pydy = vdupq_n_f32(py*dy), zero = vdupq_n_f32(0.f), one = vdupq_n_f32(1.f);
+  int32x4_t lane = {0, 1, 2, 3};
+  float32x4_t cx = vaddq_f32(vdupq_n_f32(0.5f), vcvtq_f32_s32(vaddq_s32(vdupq_n_s32(ix), lane)));
+  for(; ix + 3 <= ix1; ix += 4, dist += 4) {
+    float32x4_t px = vsubq_f32(cx, vx0);
+    float32x4_t t = vmulq_f32(vaddq_f32(vmulq_f32(px, vdx), pydy), vinvl2);
+    t = vminq_f32(vmaxq_f32(t, zero), one);
+    float32x4_t qx = vsubq_f32(vmulq_f32(t, vdx), px), qy = vsubq_f32(vmulq_f32(t, vdy), vpy);
+    float32x4_t d2 = vaddq_f32(vmulq_f32(qx, qx), vmulq_f32(qy, qy));
+    vst1q_f32(dist, vminq_f32(vld1q_f32(dist), d2));
+    cx = vaddq_f32(cx, vdupq_n_f32(4.f));
+  }
+#endif
+  for(; ix <= ix1; ++ix, ++dist)
+    *dist = swnvg__minf(*dist, distToEdge2(dx, dy, invl2, 0.5f + ix - x0, py));
+}
+
 static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
 {
   int i, ix, iy;  //, ix0, iy0, iy1, ix1;
@@ -1059,7 +3652,6 @@ static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
   SWNVGedge* edge = &gl->edges[call->edgeOffset];
   for(i = 0; i < call->edgeCount; ++i, ++edge) {
     if(edge->y0 == edge->y1) continue;  // skip horizontal edges (still needed for SDF generation)
-    int xedge = swnvg__mini(edge->dir, xb1);
     int dir = edge->y0 > edge->y1 ? -1 : 1;
     float ymin = swnvg__minf(edge->y0, edge->y1);
     float ymax = swnvg__maxf(edge->y0, edge->y1);
@@ -1080,7 +3672,7 @@ static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
     for(iy = iymin; iy <= iymax; ++iy) {
       int ixmin = swnvg__maxi((int)xmin, ixleft);
       int ixmax = swnvg__mini((int)xmax, ixright);
-      float* dst = &gl->covtex[iy*gl->width + ixmin];
+      float* dst = &r->covtex[(iy - r->y0)*gl->tileW + ixmin - r->x0];
       float cov = 0;
       float v0y = edge->y0 - iy - 0.5f, v1y = edge->y1 - iy - 0.5f;
       if(call->flags & NVG_PATH_NO_AA) {  // || gl->flags & NVGSW_SDFGEN) {
@@ -1091,19 +3683,21 @@ static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
           cov = c;
         }
         // coverage for remaining pixels
-        if(ix <= xedge)
+        if(ix <= xb1)
           *dst += dir*(ymax > iy+0.5f && ymin <= iy+0.5f ? 1.0f : 0.0f) - cov;
       }
       else {
         for(ix = ixmin; ix <= ixmax; ++ix) {
           float v0x = edge->x0 - ix - 0.5f, v1x = edge->x1 - ix - 0.5f;
-          float c = areaEdge(v0y, v0x, v1y, v1x, invslope);
+          float c = swnvg__quantCov(areaEdge(v0y, v0x, v1y, v1x, invslope));
           *dst++ += c - cov;
           cov = c;
         }
-        // coverage for remaining pixels
-        if(ix <= xedge)
-          *dst += dir*(swnvg__minf(ymax, iy+1) - swnvg__maxf(ymin, iy)) - cov;
+        // coverage for remaining pixels; rounding ends, which are shared w/ adjacent edges, makes sum over
+        //  closed path exactly zero, so no coverage leaks past the path to be cut off at tile boundaries
+        if(ix <= xb1)
+          *dst += swnvg__quantCov(swnvg__clampf(edge->y1 - iy, 0, 1))
+              - swnvg__quantCov(swnvg__clampf(edge->y0 - iy, 0, 1)) - cov;
       }
       // scanline x limits
       if(ixmin < lims[0])
@@ -1117,32 +3711,40 @@ static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
   }
 
   if (gl->flags & NVGSW_SDFGEN) {
-    // this is about 10x faster than stbtt_GetGlyphSDF (in valgrind) and supports OTF; if we needed even better
-    //  performance, we could add edges to r-tree or other spatial index to quickly find edge nearest pixel
-    int sdf_radius = gl->rshift;  // temporary (ha!) hack
+    // call bounds include sdfRadius (and are limited to scissor); for each row within radius of an edge, only
+    //  pixels within radius of the part of edge near the row are visited, so cost is proportional to length of
+    //  edge times radius instead of area of expanded bounding box of edge
+    float rad = gl->sdfRadius, rad2 = rad*rad;
+    int tileW = gl->tileW;
     edge = &gl->edges[call->edgeOffset];
     for(i = 0; i < call->edgeCount; ++i, ++edge) {
-      float xmin = swnvg__minf(edge->x0, edge->x1);
-      float xmax = swnvg__maxf(edge->x0, edge->x1);
-      float ymin = swnvg__minf(edge->y0, edge->y1);
-      float ymax = swnvg__maxf(edge->y0, edge->y1);
-
-      int ixmin = swnvg__maxi((int)xmin - sdf_radius, r->x0);
-      int ixmax = swnvg__mini((int)xmax + 1 + sdf_radius, r->x1);
-      int iymin = swnvg__maxi((int)ymin - sdf_radius, r->y0);
-      int iymax = swnvg__mini((int)ymax + 1 + sdf_radius, r->y1);
-
       float edgedx = edge->x1 - edge->x0, edgedy = edge->y1 - edge->y0;
       float l2 = edgedx*edgedx + edgedy*edgedy;
       if(l2 == 0.f) continue;  // should never happen
       float invl2 = 1.f/l2;
-      // iterate over every pixel within sdf_radius of edge (within box, actually)
+      float invdy = edgedy != 0 ? 1.f/edgedy : 0;
+      float xmin = swnvg__minf(edge->x0, edge->x1);
+      float xmax = swnvg__maxf(edge->x0, edge->x1);
+      float ymin = swnvg__minf(edge->y0, edge->y1);
+      float ymax = swnvg__maxf(edge->y0, edge->y1);
+      int iymin = swnvg__maxi((int)ceilf(ymin - rad - 0.5f), yb0);
+      int iymax = swnvg__mini((int)floorf(ymax + rad - 0.5f), yb1);
       for(iy = iymin; iy <= iymax; ++iy) {
-        float* fdst = (float*)(&gl->bitmap[iy*gl->stride]);
-        for(ix = ixmin; ix <= ixmax; ++ix) {
-          float px = 0.5f + ix - edge->x0, py = 0.5f + iy - edge->y0;
-          fdst[ix] = swnvg__minf(fdst[ix], distToEdge2(edgedx, edgedy, invl2, px, py));
+        float yc = iy + 0.5f, xa = xmin, xb = xmax;
+        float dy = yc < ymin ? ymin - yc : (yc > ymax ? yc - ymax : 0);
+        float w = sqrtf(swnvg__maxf(rad2 - dy*dy, 0));
+        if(edgedy != 0) {
+          // part of edge within rad of row
+          float t0 = swnvg__clampf((yc - rad - edge->y0)*invdy, 0.f, 1.f);
+          float t1 = swnvg__clampf((yc + rad - edge->y0)*invdy, 0.f, 1.f);
+          xa = swnvg__minf(edge->x0 + t0*edgedx, edge->x0 + t1*edgedx);
+          xb = swnvg__maxf(edge->x0 + t0*edgedx, edge->x0 + t1*edgedx);
         }
+        int ixmin = swnvg__maxi((int)ceilf(xa - w - 0.5f), xb0);
+        int ixmax = swnvg__mini((int)floorf(xb + w - 0.5f), xb1);
+        if(ixmin <= ixmax)
+          swnvg__sdfRow(&r->sdfDist[(iy - r->y0)*tileW + ixmin - r->x0], ixmin, ixmax, yc - edge->y0,
+              edge->x0, edgedx, edgedy, invl2);
       }
     }
 
@@ -1150,75 +3752,64 @@ static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
     int* lims = &r->lineLimits[2*(yb0 - r->y0)];
     for(iy = yb0; iy <= yb1; ++iy, lims +=2) { lims[0] = gl->width; lims[1] = 0; }
 
-    int ixmin = swnvg__maxi(call->bounds[0] - sdf_radius, r->x0);
-    int iymin = swnvg__maxi(call->bounds[1] - sdf_radius, r->y0);
-    int ixmax = swnvg__mini(call->bounds[2] + sdf_radius, r->x1);
-    int iymax = swnvg__mini(call->bounds[3] + sdf_radius, r->y1);
     // resolve coverage (to get sign for distance) and write final signed distance for each pixel
-    for(iy = iymin; iy <= iymax; ++iy) {
+    for(iy = yb0; iy <= yb1; ++iy) {
       float cover = 0;
-      float* fdst = (float*)(&gl->bitmap[iy*gl->stride + ixmin*4]);
-      float* dcover = &gl->covtex[iy*gl->width + ixmin];
-      for(ix = ixmin; ix <= ixmax; ++ix, ++dcover, ++fdst) {
+      float* dist = &r->sdfDist[(iy - r->y0)*tileW + xb0 - r->x0];
+      float* dcover = &r->covtex[(iy - r->y0)*tileW + xb0 - r->x0];
+      unsigned char* dst = &gl->bitmap[iy*gl->stride + xb0*gl->bpp];
+      for(ix = xb0; ix <= xb1; ++ix, ++dcover, ++dist, dst += gl->bpp) {
         if(*dcover != 0) {
           cover += *dcover;
           *dcover = 0;
         }
-        *fdst = sqrtf(*fdst) * (fabsf(cover) >= 0.5f ? -1.f : 1.f);
+        float sd = sqrtf(swnvg__minf(*dist, rad2)) * (fabsf(cover) >= 0.5f ? -1.f : 1.f);
+        *dist = SWNVG__SDF_FAR;
+        if(gl->format == NVGSW_A8)
+          *dst = (unsigned char)swnvg__clampf(sd*gl->sdfScale + gl->sdfOffset + 0.5f, 0.f, 255.f);
+        else
+          *(float*)dst = sd;
       }
     }
   }
   else {
     // fill
     int* lims = &r->lineLimits[2*(yb0 - r->y0)];
-    int linear = call->flags & NVG_SRGB ? 1 : 0;
-    int complex = call->type != SWNVG_PAINT_COLOR || call->flags & NVG_PATH_SCISSOR || call->flags & NVG_PATH_BLENDFUNC;
+    // premultiplied kernels leave pixels w/o coverage untouched for all composite ops
+    int blendfunc = (call->flags & NVG_PATH_BLENDFUNC) && !(gl->flags & NVGSW_PREMULTIPLIED);
+    int complex = call->type != SWNVG_PAINT_COLOR || call->flags & NVG_PATH_SCISSOR || blendfunc;
     rgba32_t c = call->innerCol;
     for(iy = yb0; iy <= yb1; ++iy) {
       float cover = 0;
       int icover = 0;
       int count = swnvg__mini(lims[1], xb1) - lims[0] + 1;
-      unsigned char* dst = &gl->bitmap[iy*gl->stride + lims[0]*4];
-      float* dcover = &gl->covtex[iy*gl->width + lims[0]];
+      unsigned char* dst = &gl->bitmap[iy*gl->stride + lims[0]*gl->bpp];
+      float* dcover = &r->covtex[(iy - r->y0)*gl->tileW + lims[0] - r->x0];
 
-      if (!complex) {
-        // handle solid color directly for better performance
-        if(RGBA32_IS_OPAQUE(c)) {
-          for(i = 0; i < count; ++i, ++dcover, dst += 4) {
-            if(*dcover != 0) {
-              cover += *dcover;
-              icover = swnvg__mini(fabsf(cover)*255 + 0.5f, 255);
-              *dcover = 0;
-            }
-            if(icover > 0)
-              swnvg__blendOpaque(dst, icover, c, linear);
-          }
-        }
-        else {
-          for(i = 0; i < count; ++i, ++dcover, dst += 4) {
-            if(*dcover != 0) {
-              cover += *dcover;
-              icover = swnvg__mini(fabsf(cover)*255 + 0.5f, 255);
-              *dcover = 0;
-            }
-            if(icover > 0)
-              swnvg__blend(dst, icover, COLOR0(c), COLOR1(c), COLOR2(c), COLOR3(c), linear);
-          }
+      unsigned char* sl = r->scanline;
+      for(i = 0; i < count; ++i, ++dcover, ++sl) {
+        if(*dcover != 0) {
+          cover += *dcover;
+          icover = swnvg__mini(fabsf(cover)*255 + 0.5f, 255);
+          *dcover = 0;
         }
+        *sl = icover;
       }
-      else {
-        // images and gradients
-        unsigned char* sl = r->scanline;
-        for(i = 0; i < count; ++i, ++dcover, ++sl) {
-          if(*dcover != 0) {
-            cover += *dcover;
-            icover = swnvg__mini(fabsf(cover)*255 + 0.5f, 255);
-            *dcover = 0;
-          }
-          *sl = icover;
+      if (!complex) {
+        // solid color: blend runs of nonzero coverage (pixels w/o coverage are not touched)
+        sl = r->scanline;
+        for(i = 0; i < count;) {
+          int i0;
+          while(i < count && sl[i] == 0) ++i;
+          for(i0 = i; i < count && sl[i] != 0; ++i) {}
+          if(i > i0)
+            swnvg__blendCall(r, call, dst + gl->bpp*i0, NULL, c, sl + i0, i - i0);
         }
-        swnvg__scanlineSolid(dst, count, r->scanline, lims[0], iy, call);
       }
+      else  // images and gradients
+        swnvg__scanlineSolid(r, dst, count, r->scanline, lims[0], iy, call);
+      if (count > 0)
+        memset(r->scanline, 0, count);  // sub-scanline rasterizer expects a cleared scanline
 
       lims[0] = gl->width; lims[1] = 0;  // reset limits for this scanline
       lims += 2;
@@ -1227,7 +3818,8 @@ static void swnvg__rasterizeXC(SWNVGthreadCtx* r, SWNVGcall* call)
 }
 
 
-// cut and paste from stbtt; this benchmarks much faster than qsort() and a bit faster than a naive quicksort
+// cut and paste from stbtt; this benchmarks much faster than qsort() and a bit faster than a naive quicksort; used
+//  for calls with few edges
 #define SWNVG__COMPARE(a,b) ((a)->y0 < (b)->y0)
 
 static void swnvg__insSortEdges(SWNVGedge* p, int n)
@@ -1310,94 +3902,608 @@ static void swnvg__quickSortEdges(SWNVGedge* p, int n)
   }
 }
 
-static void swnvg__sortCallEdges(SWNVGedge* p, int n)
-{
-  swnvg__quickSortEdges(p, n);
-  swnvg__insSortEdges(p, n);
-}
-
-static void swnvg__sortEdges(void* arg)
+#define SWNVG__MIN_COUNT_SORT 64  // quicksort is faster for fewer edges
+
+// edges are sorted by the subsample scanline on which they are added to the active edge table (see
+//  swnvg__rasterizeSortedEdges), which is all the ordering the rasterizer needs; edges starting above the
+//  call's bounds go in the first row
+static void swnvg__sortRows(SWNVGcall* call, float* y0, int* nrows)
+{
+  *y0 = (float)(call->bounds[1]*SWNVG__SUBSAMPLES);
+  *nrows = swnvg__maxi(call->bounds[3] - call->bounds[1] + 1, 0)*SWNVG__SUBSAMPLES + 1;
+}
+
+static int swnvg__edgeRow(const SWNVGedge* e, float y0, int nrows)
+{
+  return (int)swnvg__clampf(ceilf(e->y0 - 0.5f) - y0, 0, (float)(nrows - 1));
+}
+
+static int swnvg__reserveSort(SWNVGedge** edges, int* cedges, int** counts, int* ccounts, int n, int ncounts)
+{
+  if (n > *cedges) {
+    SWNVGedge* e = (SWNVGedge*)realloc(*edges, sizeof(SWNVGedge)*(n + *cedges/2));
+    if (!e) return 0;
+    *edges = e;
+    *cedges = n + *cedges/2;
+  }
+  if (ncounts > *ccounts) {
+    int* c = (int*)realloc(*counts, sizeof(int)*(ncounts + *ccounts/2));
+    if (!c) return 0;
+    *counts = c;
+    *ccounts = ncounts + *ccounts/2;
+  }
+  return 1;
+}
+
+// stable counting sort by starting row, falling back to quicksort for small calls
+static void swnvg__sortCallEdges(SWNVGthreadCtx* r, SWNVGcall* call)
+{
+  SWNVGedge* p = &r->context->edges[call->edgeOffset];
+  int i, c, nrows, sum = 0, n = call->edgeCount;
+  float y0;
+  swnvg__sortRows(call, &y0, &nrows);
+  if (n < SWNVG__MIN_COUNT_SORT
+      || !swnvg__reserveSort(&r->sortEdges, &r->csortEdges, &r->sortCounts, &r->csortCounts, n, nrows)) {
+    swnvg__quickSortEdges(p, n);
+    swnvg__insSortEdges(p, n);
+    return;
+  }
+  memset(r->sortCounts, 0, nrows*sizeof(int));
+  for (i = 0; i < n; ++i)
+    r->sortCounts[swnvg__edgeRow(&p[i], y0, nrows)]++;
+  for (i = 0; i < nrows; ++i) {
+    c = r->sortCounts[i];
+    r->sortCounts[i] = sum;
+    sum += c;
+  }
+  for (i = 0; i < n; ++i)
+    r->sortEdges[r->sortCounts[swnvg__edgeRow(&p[i], y0, nrows)]++] = p[i];
+  memcpy(p, r->sortEdges, n*sizeof(SWNVGedge));
+}
+
+// edges for each path are sorted by the first thread to rasterize a tile containing the path, so no separate
+//  sorting pass (and barrier) is needed
+static void swnvg__ensureSorted(SWNVGthreadCtx* r, SWNVGcall* call)
+{
+  if (swnvg__atomicLoad(&call->sortState) == 2) return;
+  if (swnvg__atomicCAS(&call->sortState, 0, 1)) {
+    NVG_STAT(double t0 = nvgStatsTime());
+    swnvg__sortCallEdges(r, call);
+    NVG_STAT(r->statSortMs += nvgStatsTime() - t0);
+    swnvg__atomicStore(&call->sortState, 2);
+  }
+  else {
+    while (swnvg__atomicLoad(&call->sortState) != 2)
+      swnvg__yield();
+  }
+}
+
+#define SWNVG__MAX_OCCLUDERS 8
+
+// occlusion culling: walk calls for tile back to front, keeping interiors of opaque calls; calls hidden by a
+//  later interior are skipped and, for XC paths, rects and quads, rows hidden by an interior spanning call's width are
+//  clipped; clipping x would change XC accumulation order, so we only clip rows
+static int swnvg__cullTile(SWNVGthreadCtx* r, int tile)
+{
+  SWNVGcontext* gl = r->context;
+  int occ[SWNVG__MAX_OCCLUDERS][4];
+  int i, k, nocc = 0, start = gl->tileCallStart[tile], ncalls = gl->tileCallStart[tile+1] - start;
+  if (2*ncalls > r->cclipRows) {
+    int* clipRows = (int*)realloc(r->clipRows, sizeof(int)*(2*ncalls + r->cclipRows/2));
+    if (!clipRows) return 0;
+    r->clipRows = clipRows;
+    r->cclipRows = 2*ncalls + r->cclipRows/2;
+  }
+  for (i = ncalls - 1; i >= 0; --i) {
+    SWNVGcall* call = &gl->calls[gl->tileCalls[start + i]];
+    int x0 = swnvg__maxi(call->bounds[0], r->x0), x1 = swnvg__mini(call->bounds[2], r->x1);
+    int y0 = swnvg__maxi(call->bounds[1], r->y0), y1 = swnvg__mini(call->bounds[3], r->y1);
+    int w = x1 - x0 + 1, h = y1 - y0 + 1, by0 = y0, by1 = y1, changed = 1;
+    if (w > 0 && h > 0 && !(gl->flags & NVGSW_SDFGEN)) {
+      while (changed && y0 <= y1) {
+        changed = 0;
+        for (k = 0; k < nocc && y0 <= y1; ++k) {
+          if (occ[k][0] > x0 || occ[k][2] < x1) continue;
+          if (occ[k][1] <= y0 && occ[k][3] >= y0) { y0 = occ[k][3] + 1;  changed = 1; }
+          if (occ[k][1] <= y1 && occ[k][3] >= y1) { y1 = occ[k][1] - 1;  changed = 1; }
+        }
+      }
+      if (y0 > y1) {
+        r->culledCalls++;
+        r->culledPixels += w*h;
+      }
+      else if (call->type != SWNVG_PAINT_ATLAS && !(call->flags & NVG_PATH_XC) && !call->rect && !call->lines) {
+        // sub-scanline rasterizer steps edges from first row, so changing first row could change result
+        y0 = by0;
+        y1 = by1;
+      }
+      else
+        r->culledPixels += w*(h - (y1 - y0 + 1));
+    }
+    // rasterizers clip to bounds, so rows only need to be changed if clipped by occluders
+    r->clipRows[2*i] = y0 > by0 ? y0 : r->y0;
+    r->clipRows[2*i+1] = y1 < by1 ? y1 : r->y1;
+    if (call->occluder && y0 <= y1) {
+      int o[4] = { swnvg__maxi(call->interior[0], r->x0), swnvg__maxi(call->interior[1], r->y0),
+                   swnvg__mini(call->interior[2], r->x1), swnvg__mini(call->interior[3], r->y1) };
+      int area = (o[2] - o[0] + 1)*(o[3] - o[1] + 1), kmin = nocc;
+      if (o[0] > o[2] || o[1] > o[3]) continue;
+      if (nocc == SWNVG__MAX_OCCLUDERS) {
+        // replace smallest occluder if new one is larger
+        int amin = area;
+        for (k = 0; k < nocc; ++k) {
+          int a = (occ[k][2] - occ[k][0] + 1)*(occ[k][3] - occ[k][1] + 1);
+          if (a < amin) { amin = a;  kmin = k; }
+        }
+        if (kmin == nocc) continue;
+      }
+      else
+        ++nocc;
+      memcpy(occ[kmin], o, sizeof(o));
+    }
+  }
+  return 1;
+}
+
+static void swnvg__rasterizeTile(SWNVGthreadCtx* r, int tile)
+{
+  int i, j;
+  SWNVGcontext* gl = r->context;
+  int tx = tile % gl->xtiles, ty = tile / gl->xtiles;
+  r->x0 = tx*gl->tileW;
+  r->y0 = ty*gl->tileH;
+  r->x1 = swnvg__mini(gl->width, r->x0 + gl->tileW) - 1;
+  r->y1 = swnvg__mini(gl->height, r->y0 + gl->tileH) - 1;
+  if (gl->flags & NVGSW_DAMAGE) {
+    for (j = r->y0; j <= r->y1; ++j)
+      memset(&gl->bitmap[j*gl->stride + r->x0*gl->bpp], 0, (r->x1 - r->x0 + 1)*gl->bpp);
+  }
+  if (!swnvg__cullTile(r, tile)) return;
+  for (i = gl->tileCallStart[tile]; i < gl->tileCallStart[tile+1]; i++) {
+    SWNVGcall* call = &gl->calls[gl->tileCalls[i]];
+    int* rows = &r->clipRows[2*(i - gl->tileCallStart[tile])];
+    if(rows[0] > rows[1]) continue;
+    r->y0 = rows[0];
+    r->y1 = rows[1];
+    NVG_TRACING(double tc = ++r->traceSample % NVGSW_TRACE_SAMPLE == 0 ? nvgStatsTime() : 0);
+    if(call->type == SWNVG_PAINT_ATLAS) {
+      NVGvertex* verts = &gl->verts[call->triangleOffset];
+      for(j = 0; j < call->triangleCount; j += 2) {
+        int glyph = call->glyphOffset >= 0 ? gl->quadGlyphs[call->glyphOffset + j/2] : -1;
+        if(call->affineQuads && glyph < 0)
+          swnvg__rasterizeAffineQuad(r, call, &verts[j], &verts[j+1]);
+        else
+          swnvg__rasterizeQuad(r, call, &verts[j], &verts[j+1], glyph);
+      }
+    } else if(call->rect) {
+      swnvg__rasterizeRect(r, call);
+    } else if(call->lines) {
+      swnvg__rasterizeLines(r, call);
+    } else {
+      if(call->flags & NVG_PATH_XC)
+        swnvg__rasterizeXC(r, call);
+      else {
+        swnvg__ensureSorted(r, call);
+        r->naet = 0;
+        swnvg__rasterizeSortedEdges(r, call);
+      }
+    }
+    NVG_TRACING(if(tc > 0) {
+      double t1 = nvgStatsTime();
+      if(t1 - tc >= NVGSW_TRACE_MIN_MS)
+        NVG_TRACE_COMPLETE("drawCall", tc, t1, gl->tileCalls[i]);
+    })
+  }
+  r->y0 = ty*gl->tileH;
+  r->y1 = swnvg__mini(gl->height, r->y0 + gl->tileH) - 1;
+}
+
+// each thread starts with a contiguous range of tiles, then steals tiles from the other threads' ranges
+static int swnvg__nextTile(SWNVGthreadCtx* r)
 {
-  int i, nthreads;
-  SWNVGthreadCtx* r = (SWNVGthreadCtx*)arg;
   SWNVGcontext* gl = r->context;
-  nthreads = gl->xthreads*gl->ythreads;
-  for (i = r->threadnum; i < gl->ncalls; i += nthreads) {
-    SWNVGcall* call = &gl->calls[i];
-    if(!(call->flags & NVG_PATH_XC))
-      swnvg__sortCallEdges(&gl->edges[call->edgeOffset], call->edgeCount);
+  int i, tile, nthreads = gl->xthreads*gl->ythreads;
+  for (i = 0; i < nthreads; ++i) {
+    SWNVGthreadCtx* victim = &gl->threads[(r->threadnum + i) % nthreads];
+    if (swnvg__atomicLoad(&victim->nextTile) >= victim->endTile) continue;
+    tile = swnvg__atomicAdd(&victim->nextTile, 1);
+    if (tile < victim->endTile) return tile;
   }
+  return -1;
 }
 
 static void swnvg__rasterize(void* arg)
 {
-  int i, j;
+  int tile;
   SWNVGthreadCtx* r = (SWNVGthreadCtx*)arg;
   SWNVGcontext* gl = r->context;
-  // setup - lineLimits array for XC rendering
-  if(gl->covtex && !r->lineLimits) {
-    int k, nlims = 2*(r->y1 - r->y0 + 1);
+  NVG_STAT(double t0 = nvgStatsTime());
+  NVG_TRACE_BEGIN("rasterize", r->threadnum);
+  // setup - coverage buffer and lineLimits array for XC rendering
+  if((gl->flags & NVGSW_PATHS_XC) && !r->covtex) {
+    int k, nlims = 2*gl->tileH;
+    r->covtex = (float*)calloc(gl->tileW*gl->tileH, sizeof(float));
     r->lineLimits = (int*)malloc(nlims*sizeof(int));
-    if (!r->lineLimits) return;
+    if (!r->covtex || !r->lineLimits) return;
     for(k = 0; k < nlims; k += 2) {
       r->lineLimits[k] = gl->width;
       r->lineLimits[k+1] = 0;
     }
   }
-  // render
+  if((gl->flags & NVGSW_SDFGEN) && !r->sdfDist) {
+    int k, npix = gl->tileW*gl->tileH;
+    r->sdfDist = (float*)malloc(npix*sizeof(float));
+    if (!r->sdfDist) return;
+    for(k = 0; k < npix; ++k)
+      r->sdfDist[k] = SWNVG__SDF_FAR;
+  }
+  while ((tile = swnvg__nextTile(r)) >= 0)
+    swnvg__rasterizeTile(r, gl->flags & NVGSW_DAMAGE ? gl->damageTiles[tile] : tile);
+  NVG_STAT(r->statRasterMs = nvgStatsTime() - t0);
+  NVG_TRACE_END("rasterize");
+}
+
+// range of tiles (inclusive) touched by call with given bounds
+static void swnvg__tileRange(SWNVGcontext* gl, const int* bounds, int* t)
+{
+  t[0] = bounds[0]/gl->tileW;
+  t[1] = bounds[1]/gl->tileH;
+  t[2] = bounds[2]/gl->tileW;
+  t[3] = bounds[3]/gl->tileH;
+}
+
+// build list of calls for each tile
+static int swnvg__binCalls(SWNVGcontext* gl)
+{
+  int i, tx, ty, t[4], total = 0, ntiles = gl->xtiles*gl->ytiles;
+  int* start = gl->tileCallStart;
+  memset(start, 0, (ntiles+1)*sizeof(int));
   for (i = 0; i < gl->ncalls; i++) {
     SWNVGcall* call = &gl->calls[i];
-    if(call->bounds[0] <= r->x1 && call->bounds[1] <= r->y1 && call->bounds[2] >= r->x0 && call->bounds[3] >= r->y0) {
-      call->tex = swnvg__findTexture(gl, call->image);
-      if(call->type == SWNVG_PAINT_ATLAS) {
-        NVGvertex* verts = &gl->verts[call->triangleOffset];
-        for(j = 0; j < call->triangleCount; j += 2) {
-          swnvg__rasterizeQuad(r, call, &verts[j], &verts[j+1]);
-        }
-      } else {
-        if(call->flags & NVG_PATH_XC)
-          swnvg__rasterizeXC(r, call);
-        else {
-          swnvg__resetPool(r);
-          r->freelist = NULL;
-          swnvg__rasterizeSortedEdges(r, call);
+    swnvg__tileRange(gl, call->bounds, t);
+    call->tex = swnvg__findTexture(gl, call->image);
+    for (ty = t[1]; ty <= t[3]; ++ty) {
+      for (tx = t[0]; tx <= t[2]; ++tx)
+        start[ty*gl->xtiles + tx + 1]++;
+    }
+    total += (t[2] - t[0] + 1)*(t[3] - t[1] + 1);
+  }
+  if (total > gl->ctileCalls) {
+    int* tileCalls = (int*)realloc(gl->tileCalls, sizeof(int)*(total + gl->ctileCalls/2));
+    if (tileCalls == NULL) return 0;
+    gl->tileCalls = tileCalls;
+    gl->ctileCalls = total + gl->ctileCalls/2;
+  }
+  for (i = 0; i < ntiles; ++i)
+    start[i+1] += start[i];
+  // after this pass, start[i] will be the end of tile i
+  for (i = 0; i < gl->ncalls; i++) {
+    swnvg__tileRange(gl, gl->calls[i].bounds, t);
+    for (ty = t[1]; ty <= t[3]; ++ty) {
+      for (tx = t[0]; tx <= t[2]; ++tx)
+        gl->tileCalls[start[ty*gl->xtiles + tx]++] = i;
+    }
+  }
+  memmove(start + 1, start, ntiles*sizeof(int));
+  start[0] = 0;
+  return 1;
+}
+
+static unsigned long long swnvg__hashCall(SWNVGcontext* gl, SWNVGcall* call)
+{
+  unsigned long long h = 0xCBF29CE484222325ULL;
+  SWNVGtexture* tex = swnvg__findTexture(gl, call->image);
+  int info[4] = { call->type, call->flags, tex ? tex->id : 0, tex ? tex->generation : 0 };
+  h = swnvg__hashWords(h, info, sizeof(info));
+  h = swnvg__hashWords(h, call->bounds, sizeof(call->bounds));
+  h = swnvg__hashWords(h, &call->blendFunc, sizeof(call->blendFunc));
+  h = swnvg__hashWords(h, call->scissorMat, offsetof(SWNVGcall, sortState) - offsetof(SWNVGcall, scissorMat));
+  if (call->type == SWNVG_PAINT_ATLAS)
+    return swnvg__hashWords(h, &gl->verts[call->triangleOffset], call->triangleCount*sizeof(NVGvertex));
+  return swnvg__hashWords(h, &gl->edges[call->edgeOffset], call->edgeCount*sizeof(SWNVGedge));
+}
+
+static void swnvg__markDamage(SWNVGcontext* gl, const int* bounds)
+{
+  int tx, ty, t[4];
+  swnvg__tileRange(gl, bounds, t);
+  for (ty = t[1]; ty <= t[3]; ++ty) {
+    for (tx = t[0]; tx <= t[2]; ++tx)
+      gl->dirtyTiles[ty*gl->xtiles + tx] = 1;
+  }
+}
+
+// Calls are matched in order against the previous frame's calls (so the matched calls have the same relative
+//  order in both frames); tiles touched by any unmatched call, old or new, are redrawn
+static int swnvg__calcDamage(SWNVGcontext* gl)
+{
+  int i, j = 0, k, tx, ty, ntiles = gl->xtiles*gl->ytiles;
+  SWNVGcallRecord* prev = gl->prevCalls;
+  SWNVGcallRecord* cur;
+  if (gl->ncalls > gl->ccurCalls) {
+    int ccalls = gl->ncalls + gl->ccurCalls/2;
+    cur = (SWNVGcallRecord*)realloc(gl->curCalls, sizeof(SWNVGcallRecord) * ccalls);
+    if (cur == NULL) return 0;
+    gl->curCalls = cur;
+    gl->ccurCalls = ccalls;
+  }
+  cur = gl->curCalls;
+  memset(gl->dirtyTiles, !gl->damageValid, ntiles);
+  for (i = 0; i < gl->ncalls; ++i) {
+    cur[i].hash = swnvg__hashCall(gl, &gl->calls[i]);
+    memcpy(cur[i].bounds, gl->calls[i].bounds, sizeof(cur[i].bounds));
+    if (!gl->damageValid) continue;
+    for (k = j; k < gl->nprevCalls && k < j + SWNVG__DAMAGE_LOOKAHEAD; ++k) {
+      if (prev[k].hash == cur[i].hash) break;
+    }
+    if (k < gl->nprevCalls && k < j + SWNVG__DAMAGE_LOOKAHEAD) {
+      for (; j < k; ++j)
+        swnvg__markDamage(gl, prev[j].bounds);
+      ++j;
+    }
+    else
+      swnvg__markDamage(gl, cur[i].bounds);
+  }
+  if (gl->damageValid) {
+    for (; j < gl->nprevCalls; ++j)
+      swnvg__markDamage(gl, prev[j].bounds);
+  }
+  // current calls become previous calls for next frame
+  gl->curCalls = prev;
+  gl->prevCalls = cur;
+  k = gl->ccurCalls;
+  gl->ccurCalls = gl->cprevCalls;
+  gl->cprevCalls = k;
+  gl->nprevCalls = gl->ncalls;
+  gl->damageValid = 1;
+
+  // list of tiles to draw, and rects for caller - each row of tiles is split into runs of dirty tiles, which
+  //  are merged with identical runs from previous row
+  gl->ndamageTiles = 0;
+  gl->ndamageRects = 0;
+  for (ty = 0; ty < gl->ytiles; ++ty) {
+    for (tx = 0; tx < gl->xtiles; ++tx) {
+      int x, w, y = ty*gl->tileH, h = swnvg__mini(gl->height - y, gl->tileH);
+      int* rect = NULL;
+      if (!gl->dirtyTiles[ty*gl->xtiles + tx]) continue;
+      for (k = tx; k < gl->xtiles && gl->dirtyTiles[ty*gl->xtiles + k]; ++k)
+        gl->damageTiles[gl->ndamageTiles++] = ty*gl->xtiles + k;
+      x = tx*gl->tileW;
+      w = swnvg__mini(gl->width, k*gl->tileW) - x;
+      for (i = 0; i < gl->ndamageRects && !rect; ++i) {
+        int* r = &gl->damageRects[4*i];
+        if (r[0] == x && r[2] == w && r[1] + r[3] == y) rect = r;
+      }
+      if (rect)
+        rect[3] += h;
+      else {
+        rect = &gl->damageRects[4*gl->ndamageRects++];
+        rect[0] = x;  rect[1] = y;  rect[2] = w;  rect[3] = h;
+      }
+      tx = k;
+    }
+  }
+  return 1;
+}
+
+// mipmap generation: 2x2 box filter weighted by alpha (texture is not premultiplied)
+typedef struct SWNVGmipTask {
+  SWNVGtexture* tex;
+  int level, y0, y1;
+} SWNVGmipTask;
+
+static void swnvg__mipRows(SWNVGtexture* tex, int level, int y0, int y1)
+{
+  int sw, sh, dw, dh, x, y, k;
+  const rgba32_t* src = swnvg__mipLevel(tex, level - 1, &sw, &sh);
+  rgba32_t* dst = swnvg__mipLevel(tex, level, &dw, &dh);
+  for (y = y0; y < y1; ++y) {
+    const rgba32_t* row0 = src + swnvg__mini(2*y, sh-1)*sw;
+    const rgba32_t* row1 = src + swnvg__mini(2*y+1, sh-1)*sw;
+    for (x = 0; x < dw; ++x) {
+      int x0 = swnvg__mini(2*x, sw-1), x1 = swnvg__mini(2*x+1, sw-1);
+      rgba32_t p[4] = {row0[x0], row0[x1], row1[x0], row1[x1]};
+      unsigned int c0 = 0, c1 = 0, c2 = 0, a = 0;
+      for (k = 0; k < 4; ++k) {
+        unsigned int pa = COLOR3(p[k]);
+        c0 += COLOR0(p[k])*pa;  c1 += COLOR1(p[k])*pa;  c2 += COLOR2(p[k])*pa;  a += pa;
+      }
+      if (a > 0) {
+        c0 = (c0 + a/2)/a;  c1 = (c1 + a/2)/a;  c2 = (c2 + a/2)/a;
+      }
+      else {
+        c0 = c1 = c2 = 0;
+        for (k = 0; k < 4; ++k) {
+          c0 += COLOR0(p[k]);  c1 += COLOR1(p[k]);  c2 += COLOR2(p[k]);
         }
+        c0 = (c0 + 2)/4;  c1 = (c1 + 2)/4;  c2 = (c2 + 2)/4;
+      }
+      dst[y*dw + x] = c0 | c1 << 8 | c2 << 16 | ((a + 2)/4) << 24;
+    }
+  }
+}
+
+static void swnvg__mipTask(void* arg)
+{
+  SWNVGmipTask* task = (SWNVGmipTask*)arg;
+  NVG_TRACE_BEGIN("buildMips", task->level);
+  swnvg__mipRows(task->tex, task->level, task->y0, task->y1);
+  NVG_TRACE_END("buildMips");
+}
+
+static int swnvg__buildMips(SWNVGcontext* gl, SWNVGtexture* tex)
+{
+  SWNVGmipTask tasks[64];
+  int nthreads = swnvg__mini(gl->xthreads*gl->ythreads, 64);
+  int level, w, h, npix = 0;
+  for (level = 1; level <= SWNVG__MAX_MIPS; ++level) {
+    if ((tex->width >> (level-1)) <= 1 && (tex->height >> (level-1)) <= 1) break;
+    tex->mipOffset[level] = npix;
+    npix += swnvg__maxi(tex->width >> level, 1)*swnvg__maxi(tex->height >> level, 1);
+  }
+  tex->nmips = level - 1;
+  if (tex->nmips < 1) return 0;
+  if (!tex->mips) {
+    tex->mips = (rgba32_t*)malloc(npix*sizeof(rgba32_t));
+    if (!tex->mips) return 0;
+  }
+  for (level = 1; level <= tex->nmips; ++level) {
+    swnvg__mipLevel(tex, level, &w, &h);
+    // each level depends on the previous one, so only split rows of large levels across threads
+    if (nthreads > 1 && w*h >= 64*64) {
+      int ii;
+      for (ii = 0; ii < nthreads; ++ii) {
+        tasks[ii].tex = tex;
+        tasks[ii].level = level;
+        tasks[ii].y0 = (ii*h)/nthreads;
+        tasks[ii].y1 = ((ii+1)*h)/nthreads;
+        swnvg__submit(gl, swnvg__mipTask, &tasks[ii]);
       }
+      swnvg__wait(gl);
     }
+    else
+      swnvg__mipRows(tex, level, 0, h);
+  }
+  return 1;
+}
+
+// build mipmaps for images drawn minified this frame
+static void swnvg__updateMips(SWNVGcontext* gl)
+{
+  int i;
+  for (i = 0; i < gl->ncalls; ++i) {
+    SWNVGtexture* tex = gl->calls[i].tex;
+    if (gl->calls[i].type == SWNVG_PAINT_IMAGE && gl->calls[i].lod > 0 && tex && !tex->mipsValid)
+      tex->mipsValid = swnvg__buildMips(gl, tex);
+  }
+}
+
+#define SWNVG__SWAP(T, a, b) do { T tmp_ = a; a = b; b = tmp_; } while (0)
+
+// start rasterization of frame on pool threads from copy of context, then swap in spare per frame buffers so next
+//  frame can be recorded; returns 0 if frame must be rendered synchronously
+static int swnvg__submitFrame(SWNVGcontext* gl)
+{
+  int i, nthreads = gl->xthreads*gl->ythreads;
+  if (!gl->flight)
+    gl->flight = (SWNVGcontext*)malloc(sizeof(SWNVGcontext));
+  if (!gl->flight) return 0;
+  memcpy(gl->flight, gl, sizeof(SWNVGcontext));
+  for (i = 0; i < gl->ntextures; i++) {
+    if (gl->textures[i].flags & NVG_IMAGE_DISCARD)
+      gl->textures[i].release = 1;
   }
+  for (i = 0; i < nthreads; ++i) {
+    gl->threads[i].context = gl->flight;
+    swnvg__submit(gl, swnvg__rasterize, &gl->threads[i]);
+  }
+  gl->inFlight = 1;
+  SWNVG__SWAP(SWNVGcall*, gl->calls, gl->spareCalls);
+  SWNVG__SWAP(int, gl->ccalls, gl->cspareCalls);
+  SWNVG__SWAP(NVGvertex*, gl->verts, gl->spareVerts);
+  SWNVG__SWAP(int, gl->cverts, gl->cspareVerts);
+  SWNVG__SWAP(rgba32_t*, gl->ramps, gl->spareRamps);
+  SWNVG__SWAP(int, gl->cramps, gl->cspareRamps);
+  SWNVG__SWAP(SWNVGedge*, gl->edges, gl->spareEdges);
+  SWNVG__SWAP(int, gl->cedges, gl->cspareEdges);
+  swnvg__renderCancel(gl);
+  return 1;
 }
 
 static void swnvg__renderFlush(void* uptr)
 {
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
-  int i, nthreads = gl->xthreads*gl->ythreads;
-  if (gl->ncalls == 0) return;
+  int i, ntiles = gl->xtiles*gl->ytiles, nthreads = gl->xthreads*gl->ythreads;
+  swnvg__finishFrame(gl);
+  gl->culledCalls = gl->culledPixels = 0;
+  NVG_STAT(memset(&gl->stats, 0, sizeof(NVGframeStats)));
+  NVG_STAT(gl->stats.edges = gl->nedges);
   //NVG_LOG("renderFlush: %d calls, %d edges, %d quad verts\n", gl->ncalls, gl->nedges, gl->nverts);
   // we assume dest buffer has already been cleared -- for(i = 0; i < h; i++) memset(&dst[i*stride], 0, w*4);
-  if(nthreads > 1) {
-    for(i = 0; i < nthreads; ++i)
-      gl->poolSubmit(swnvg__sortEdges, &gl->threads[i]);
-    gl->poolWait();
-    for(i = 0; i < nthreads; ++i)
-      gl->poolSubmit(swnvg__rasterize, &gl->threads[i]);
-    gl->poolWait();
+  //  except in damage mode, where we only clear and draw tiles touched by calls that have changed
+  if (gl->flags & NVGSW_DAMAGE) {
+    if (!gl->dirtyTiles || !swnvg__calcDamage(gl)) {
+      gl->damageValid = 0;
+      swnvg__renderCancel(gl);
+      return;
+    }
+    ntiles = gl->ndamageTiles;
   }
-  else {
-    swnvg__sortEdges(gl->threads);
-    swnvg__rasterize(gl->threads);
+  else if (gl->ncalls == 0)
+    return;
+  if (ntiles > 0) {
+    NVG_TRACE_BEGIN("binCalls", gl->ncalls);
+    if (!swnvg__binCalls(gl)) {
+      gl->damageValid = 0;
+      swnvg__renderCancel(gl);
+      NVG_TRACE_END("binCalls");
+      return;
+    }
+    NVG_TRACE_END("binCalls");
+    NVG_STAT(double t0 = nvgStatsTime());
+    NVG_TRACE_BEGIN("updateMips", -1);
+    swnvg__updateMips(gl);
+    NVG_TRACE_END("updateMips");
+    NVG_STAT(double t1 = nvgStatsTime());
+    NVG_TRACE_BEGIN("updateGlyphs", -1);
+    swnvg__updateGlyphs(gl);
+    NVG_TRACE_END("updateGlyphs");
+    NVG_STAT(gl->stats.textureMs = t1 - t0);
+    NVG_STAT(gl->stats.sortMs = 0);
+    for(i = 0; i < nthreads; ++i) {
+      gl->threads[i].nextTile = (i*ntiles)/nthreads;
+      gl->threads[i].endTile = ((i+1)*ntiles)/nthreads;
+    }
+    for(i = 0; i < nthreads; ++i) {
+      gl->threads[i].culledCalls = gl->threads[i].culledPixels = 0;
+      NVG_STAT(gl->threads[i].statCovered = gl->threads[i].statBlended = 0);
+      NVG_STAT(gl->threads[i].statRasterMs = gl->threads[i].statSortMs = 0);
+    }
+    if(nthreads > 1 && (gl->flags & NVGSW_ASYNC) && swnvg__submitFrame(gl))
+      return;
+    if(nthreads > 1) {
+      for(i = 0; i < nthreads; ++i)
+        swnvg__submit(gl, swnvg__rasterize, &gl->threads[i]);
+      swnvg__wait(gl);
+    }
+    else
+      swnvg__rasterize(gl->threads);
+    for(i = 0; i < nthreads; ++i) {
+      gl->culledCalls += gl->threads[i].culledCalls;
+      gl->culledPixels += gl->threads[i].culledPixels;
+    }
+    NVG_STAT(swnvg__threadStats(gl));
   }
   // clear temporary textures (e.g., for which user didn't save handle)
   for (i = 0; i < gl->ntextures; i++) {
-    if (gl->textures[i].flags & NVG_IMAGE_DISCARD) {
-      if(!(gl->textures[i].flags & NVG_IMAGE_NOCOPY))
-        free(gl->textures[i].data);
-      memset(&gl->textures[i], 0, sizeof(SWNVGtexture));
-    }
+    if (gl->textures[i].flags & NVG_IMAGE_DISCARD)
+      gl->textures[i].release = 1;
   }
+  swnvg__releaseTextures(gl);
   // Reset calls
   gl->nverts = 0;
   gl->nedges = 0;
   gl->ncalls = 0;
+  gl->nramps = 0;
+}
+
+static void swnvg__renderGetStats(void* uptr, NVGframeStats* stats)
+{
+#ifdef NVG_FRAME_STATS
+  SWNVGcontext* gl = (SWNVGcontext*)uptr;
+  int i;
+  stats->edges = gl->stats.edges;
+  stats->pixelsCovered = gl->stats.pixelsCovered;
+  stats->pixelsBlended = gl->stats.pixelsBlended;
+  stats->sortMs = gl->stats.sortMs;
+  stats->textureMs += gl->stats.textureMs;
+  stats->nthreads = gl->stats.nthreads;
+  for (i = 0; i < gl->stats.nthreads; ++i)
+    stats->rasterizeMs[i] = gl->stats.rasterizeMs[i];
+#else
+  NVG_NOTUSED(uptr);
+  NVG_NOTUSED(stats);
+#endif
 }
 
 static SWNVGcall* swnvg__allocCall(SWNVGcontext* gl)
@@ -1432,9 +4538,15 @@ static int swnvg__allocVerts(SWNVGcontext* gl, int n)
   return ret;
 }
 
-// Note that w/ SW renderer, premultiplying by alpha doesn't provide any benefit
+// premultiplying by alpha is only done for NVGSW_PREMULTIPLIED, where it allows composite ops to be simple
+//  multiply-adds
 static rgba32_t swnvg__convertColor(SWNVGcontext* gl, NVGcolor c)
 {
+  if(gl->flags & NVGSW_PREMULTIPLIED) {
+    c.r = (unsigned char)((c.r*c.a + 127)/255);
+    c.g = (unsigned char)((c.g*c.a + 127)/255);
+    c.b = (unsigned char)((c.b*c.a + 127)/255);
+  }
   // old way: if NVG_SRGB is set, c is assumed to be in linear RGB space (otherwise, in sRGB), in which case
   //  we convert (back) to sRGB so that opaque colors can be written quickly to output
   //int r = gl->flags & NVG_SRGB ? (int)(0.5f + powf(c.r, 1/sRGBgamma)*255.0f) : (int)(0.5f + c.r*255.0f);
@@ -1444,6 +4556,64 @@ static rgba32_t swnvg__convertColor(SWNVGcontext* gl, NVGcolor c)
   return c.r << gl->rshift | c.g << gl->gshift | c.b << gl->bshift | c.a << gl->ashift;
 }
 
+static void swnvg__setupGradient(SWNVGcontext* gl, SWNVGcall* call, NVGpaint* paint)
+{
+  const float* xf = paint->xform;
+  double det = (double)xf[0]*xf[3] - (double)xf[2]*xf[1];
+  int i;
+  call->gradType = SWNVG_GRAD_BOX;
+  call->rampOffset = -1;
+  // nvgLinearGradient() is a box gradient w/ huge extent (1e5), so parameter reduces to
+  //  (qy - extent[1])/feather + 0.5 w/ qy from paintMat; we compute coefficients in double precision to
+  //  avoid cancellation between qy and extent[1].  Not used w/ NVG_SRGB, since conversion from linear
+  //  magnifies the (tiny) difference from the box calculation near black
+  if (paint->radius == 0 && paint->extent[0] >= 1e4f && paint->extent[1] >= paint->extent[0] && det != 0
+      && !(call->flags & NVG_SRGB)) {
+    double f = call->feather;
+    call->gradType = SWNVG_GRAD_LINEAR;
+    call->gradLinear[0] = (float)(-xf[1]/det/f);
+    call->gradLinear[1] = (float)(xf[0]/det/f);
+    call->gradLinear[2] = (float)((((double)xf[1]*xf[4] - (double)xf[0]*xf[5])/det - paint->extent[1])/f + 0.5);
+  }
+  // color ramp for 2-stop gradient - not used w/ NVG_SRGB since error would exceed 1 LSB near black
+  if (paint->image == 0 && !(call->flags & NVG_SRGB)) {
+    rgba32_t c0 = call->innerCol, c1 = call->outerCol;
+    rgba32_t* ramp;
+    if (gl->nramps + SWNVG__RAMP_SIZE > gl->cramps) {
+      int cramps = swnvg__maxi(gl->nramps + SWNVG__RAMP_SIZE, 16*SWNVG__RAMP_SIZE) + gl->cramps/2;
+      ramp = (rgba32_t*)realloc(gl->ramps, sizeof(rgba32_t)*cramps);
+      if (ramp == NULL) return;
+      gl->ramps = ramp;
+      gl->cramps = cramps;
+    }
+    ramp = &gl->ramps[gl->nramps];
+    for (i = 0; i < SWNVG__RAMP_SIZE; ++i) {
+      float d = i/(float)(SWNVG__RAMP_SIZE-1);
+      unsigned int cr = (int)(0.5f + COLOR0(c0)*(1.0f - d) + COLOR0(c1)*d);
+      unsigned int cg = (int)(0.5f + COLOR1(c0)*(1.0f - d) + COLOR1(c1)*d);
+      unsigned int cb = (int)(0.5f + COLOR2(c0)*(1.0f - d) + COLOR2(c1)*d);
+      unsigned int ca = (int)(0.5f + COLOR3(c0)*(1.0f - d) + COLOR3(c1)*d);
+      ramp[i] = cr | cg << 8 | cb << 16 | ca << 24;
+    }
+    call->rampOffset = gl->nramps;
+    gl->nramps += SWNVG__RAMP_SIZE;
+  }
+}
+
+// choose mip level from texels per pixel, using the larger of x and y as GL does
+static void swnvg__setupMips(SWNVGcontext* gl, SWNVGcall* call)
+{
+  SWNVGtexture* tex = swnvg__findTexture(gl, call->image);
+  const float* m = call->paintMat;
+  float sx, sy, rho;
+  if (!tex || !(tex->flags & NVG_IMAGE_GENERATE_MIPMAPS) || tex->type != NVG_TEXTURE_RGBA)
+    return;
+  sx = swnvg__lengthf(m[0]*tex->width/call->extent[0], m[1]*tex->height/call->extent[1]);
+  sy = swnvg__lengthf(m[2]*tex->width/call->extent[0], m[3]*tex->height/call->extent[1]);
+  rho = swnvg__maxf(sx, sy);
+  call->lod = rho > 1.0f ? log2f(rho) : 0.0f;
+}
+
 static int swnvg__convertPaint(SWNVGcontext* gl, SWNVGcall* call, NVGpaint* paint, NVGscissor* scissor, int flags)
 {
   call->flags = flags | (gl->flags & NVG_SRGB);
@@ -1460,6 +4630,10 @@ static int swnvg__convertPaint(SWNVGcontext* gl, SWNVGcall* call, NVGpaint* pain
       call->scissorExt[1] = scissor->extent[1];
       call->scissorScale[0] = sqrtf(scissor->xform[0]*scissor->xform[0] + scissor->xform[2]*scissor->xform[2]);  //*gl->devicePixelRatio;
       call->scissorScale[1] = sqrtf(scissor->xform[1]*scissor->xform[1] + scissor->xform[3]*scissor->xform[3]);  //*gl->devicePixelRatio;
+      call->scissorIn[0] = call->scissorExt[0] - 0.5f/call->scissorScale[0];
+      call->scissorIn[1] = call->scissorExt[1] - 0.5f/call->scissorScale[1];
+      call->scissorOut[0] = call->scissorExt[0] + 0.5f/call->scissorScale[0];
+      call->scissorOut[1] = call->scissorExt[1] + 0.5f/call->scissorScale[1];
     }
   }
 
@@ -1469,18 +4643,128 @@ static int swnvg__convertPaint(SWNVGcontext* gl, SWNVGcall* call, NVGpaint* pain
     call->radius = paint->radius;
     call->feather = paint->feather;
     nvgTransformInverse(call->paintMat, paint->xform);
+    swnvg__setupGradient(gl, call, paint);
   } else if (paint->image != 0) {
     call->type = SWNVG_PAINT_IMAGE;
     call->image = paint->image;
     call->radius = paint->radius;  // distance offset for SDF text
     // TODO: support NVG_IMAGE_FLIPY
     nvgTransformInverse(call->paintMat, paint->xform);
+    swnvg__setupMips(gl, call);
   } else {
     call->type = SWNVG_PAINT_COLOR;
   }
   return 1;
 }
 
+// is path a simple convex polygon? - turns must all have same sign and direction along x and y can only
+//  reverse twice
+static int swnvg__isConvex(const NVGpath* path)
+{
+  int i, sgn = 0, xflips = 0, yflips = 0;
+  const NVGvertex* v = path->fill;
+  float pdx = v[path->nfill-1].x1 - v[path->nfill-1].x0, pdy = v[path->nfill-1].y1 - v[path->nfill-1].y0;
+  for (i = 0; i < path->nfill; ++i) {
+    float dx = v[i].x1 - v[i].x0, dy = v[i].y1 - v[i].y0;
+    float cross = pdx*dy - pdy*dx;
+    if (dx == 0 && dy == 0) continue;
+    if (cross != 0) {
+      if (sgn == 0) sgn = cross > 0 ? 1 : -1;
+      else if ((cross > 0 ? 1 : -1) != sgn) return 0;
+    }
+    if (dx != 0) { xflips += pdx != 0 && (dx > 0) != (pdx > 0);  pdx = dx; }
+    if (dy != 0) { yflips += pdy != 0 && (dy > 0) != (pdy > 0);  pdy = dy; }
+  }
+  return sgn != 0 && xflips <= 2 && yflips <= 2;
+}
+
+// can call hide calls beneath it: opaque paint, src over blending, and no per-pixel scissor factor
+static int swnvg__isOpaqueCall(SWNVGcontext* gl, SWNVGcall* call)
+{
+  if ((call->flags & (NVG_PATH_BLENDFUNC | NVG_PATH_SCISSOR)) || (gl->flags & NVGSW_SDFGEN))
+    return 0;
+  if (call->type == SWNVG_PAINT_IMAGE) {
+    SWNVGtexture* tex = swnvg__findTexture(gl, call->image);
+    return tex && tex->type == NVG_TEXTURE_RGBA && tex->opaque && RGBA32_IS_OPAQUE(call->innerCol);
+  }
+  return call->type == SWNVG_PAINT_COLOR && RGBA32_IS_OPAQUE(call->innerCol);
+}
+
+// for occlusion culling, find rect of pixels fully covered by opaque call: largest rect with bounding box
+//  aspect ratio centered at vertex centroid that fits inside convex path (exact for axis-aligned rects)
+static void swnvg__setupOccluder(SWNVGcontext* gl, SWNVGcall* call, const NVGpath* path)
+{
+  int i, n = path->nfill;
+  float cx = 0, cy = 0, hw, hh, s = 1.0f;
+  const NVGvertex* v = path->fill;
+  if (n < 3 || !swnvg__isOpaqueCall(gl, call) || !swnvg__isConvex(path))
+    return;
+  for (i = 0; i < n; ++i) {
+    cx += v[i].x0;
+    cy += v[i].y0;
+  }
+  cx /= n;
+  cy /= n;
+  hw = 0.5f*(path->bounds[2] - path->bounds[0]);
+  hh = 0.5f*(path->bounds[3] - path->bounds[1]);
+  for (i = 0; i < n; ++i) {
+    // outward normal n and offset d for edge, so that n.p <= d inside; corner of rect furthest along n must
+    //  satisfy n.c + s*(|nx|*hw + |ny|*hh) <= d
+    float nx = v[i].y1 - v[i].y0, ny = v[i].x0 - v[i].x1, d, ext;
+    if (nx == 0 && ny == 0) continue;
+    d = nx*v[i].x0 + ny*v[i].y0;
+    if (nx*cx + ny*cy > d) { nx = -nx;  ny = -ny;  d = -d; }
+    ext = fabsf(nx)*hw + fabsf(ny)*hh;
+    if (ext > 0)
+      s = swnvg__minf(s, (d - nx*cx - ny*cy)/ext);
+  }
+  if (s <= 0) return;
+  // pixel x is fully covered if [x, x+1] is inside rect
+  call->interior[0] = swnvg__maxi((int)ceilf(cx - s*hw), call->bounds[0]);
+  call->interior[1] = swnvg__maxi((int)ceilf(cy - s*hh), call->bounds[1]);
+  call->interior[2] = swnvg__mini((int)floorf(cx + s*hw) - 1, call->bounds[2]);
+  call->interior[3] = swnvg__mini((int)floorf(cy + s*hh) - 1, call->bounds[3]);
+  call->occluder = call->interior[0] <= call->interior[2] && call->interior[1] <= call->interior[3];
+}
+
+// precompute factors for premultiplied blending: each blend factor is k0 + ks*srca + kd*dsta; color factors and
+//  NVG_SRC_ALPHA_SATURATE set perPixel instead, so swnvg__blendPMFunc is used
+static void swnvg__setupBlend(SWNVGblend* b, const NVGcompositeOperationState* op)
+{
+  int factors[4] = { op->srcRGB, op->dstRGB, op->srcAlpha, op->dstAlpha };
+  int i;
+  b->perPixel = 0;
+  for(i = 0; i < 4; ++i) {
+    int f = factors[i];
+    b->perPixel |= f == NVG_SRC_COLOR || f == NVG_ONE_MINUS_SRC_COLOR || f == NVG_DST_COLOR
+        || f == NVG_ONE_MINUS_DST_COLOR || f == NVG_SRC_ALPHA_SATURATE;
+    b->k0[i] = f == NVG_ONE || f == NVG_ONE_MINUS_SRC_ALPHA || f == NVG_ONE_MINUS_DST_ALPHA ? 255 : 0;
+    b->ks[i] = f == NVG_SRC_ALPHA ? 1 : (f == NVG_ONE_MINUS_SRC_ALPHA ? -1 : 0);
+    b->kd[i] = f == NVG_DST_ALPHA ? 1 : (f == NVG_ONE_MINUS_DST_ALPHA ? -1 : 0);
+  }
+  b->srcOver = op->srcRGB == NVG_ONE && op->srcAlpha == NVG_ONE
+      && op->dstRGB == NVG_ONE_MINUS_SRC_ALPHA && op->dstAlpha == NVG_ONE_MINUS_SRC_ALPHA;
+}
+
+// SDF generation writes pixels within sdfRadius of path, limited to pixels w/ centers inside AABB of scissor
+static void swnvg__sdfBounds(SWNVGcontext* gl, SWNVGcall* call, const float* bounds, NVGscissor* scissor)
+{
+  int rad = gl->sdfRadius;
+  call->bounds[0] = swnvg__maxi((int)floorf(bounds[0]) - rad, 0);
+  call->bounds[1] = swnvg__maxi((int)floorf(bounds[1]) - rad, 0);
+  call->bounds[2] = swnvg__mini((int)ceilf(bounds[2]) + rad, gl->width-1);
+  call->bounds[3] = swnvg__mini((int)ceilf(bounds[3]) + rad, gl->height-1);
+  if (scissor->extent[0] > -0.5f && scissor->extent[1] > -0.5f) {
+    float* sxform = scissor->xform;
+    float tex = scissor->extent[0]*swnvg__absf(sxform[0]) + scissor->extent[1]*swnvg__absf(sxform[2]);
+    float tey = scissor->extent[0]*swnvg__absf(sxform[1]) + scissor->extent[1]*swnvg__absf(sxform[3]);
+    call->bounds[0] = swnvg__maxi(call->bounds[0], ceilf(sxform[4] - tex - 0.5f));
+    call->bounds[1] = swnvg__maxi(call->bounds[1], ceilf(sxform[5] - tey - 0.5f));
+    call->bounds[2] = swnvg__mini(call->bounds[2], floorf(sxform[4] + tex - 0.5f));
+    call->bounds[3] = swnvg__mini(call->bounds[3], floorf(sxform[5] + tey - 0.5f));
+  }
+}
+
 static void swnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperationState compOp,
                 NVGscissor* scissor, int flags, const float* bounds, const NVGpath* paths, int npaths)
 {
@@ -1499,6 +4783,8 @@ static void swnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperation
   call->bounds[1] = swnvg__clampi((int)bounds[1], 0, gl->height-1);
   call->bounds[2] = swnvg__clampi((int)(ceilf(bounds[2])), 0, gl->width-1);
   call->bounds[3] = swnvg__clampi((int)(ceilf(bounds[3])), 0, gl->height-1);
+  if (gl->flags & NVGSW_SDFGEN)
+    swnvg__sdfBounds(gl, call, bounds, scissor);
   // note that bounds are inclusive (hence > instead of >=)
   if (call->bounds[0] > call->bounds[2] || call->bounds[1] > call->bounds[3]) {
     --gl->ncalls;
@@ -1507,18 +4793,13 @@ static void swnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperation
 
   swnvg__convertPaint(gl, call, paint, scissor, flags);
   call->blendFunc = compOp;
+  swnvg__setupBlend(&call->blend, &compOp);
   if (compOp.srcRGB != NVG_ONE || compOp.srcAlpha != NVG_ONE ||
        compOp.dstRGB != NVG_ONE_MINUS_SRC_ALPHA || compOp.dstAlpha != NVG_ONE_MINUS_SRC_ALPHA) {
     call->flags |= NVG_PATH_BLENDFUNC;
   }
-  if ((gl->flags & NVGSW_PATHS_XC) && !(call->flags & NVG_PATH_NO_AA) && !(call->flags & NVG_PATH_EVENODD)) {
+  if ((gl->flags & NVGSW_PATHS_XC) && !(call->flags & NVG_PATH_NO_AA) && !(call->flags & NVG_PATH_EVENODD))
     call->flags |= NVG_PATH_XC;
-    if(!gl->covtex) {
-      size_t n = gl->width * gl->height * sizeof(float);
-      gl->covtex = (float*)malloc(n);
-      memset(gl->covtex, 0, n);
-    }
-  }
 
   call->triangleCount = 0;
   call->edgeOffset = gl->nedges;
@@ -1526,17 +4807,178 @@ static void swnvg__renderFill(void* uptr, NVGpaint* paint, NVGcompositeOperation
     const NVGpath* path = &paths[i];
     for (j = 0; j < path->nfill; ++j)
       if(call->flags & NVG_PATH_XC)
-        swnvg__addEdgeXC(gl, &path->fill[j], path->bounds[2]);
+        swnvg__addEdgeXC(gl, &path->fill[j]);
       else
         swnvg__addEdge(gl, &path->fill[j]);
   }
   call->edgeCount = gl->nedges - call->edgeOffset;
+  if (npaths == 1)
+    swnvg__setupOccluder(gl, call, &paths[0]);
+}
+
+static int swnvg__renderRect(void* uptr, NVGpaint* paint, NVGcompositeOperationState compOp, NVGscissor* scissor,
+    int flags, const float* bounds, const float* rect, float radius)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)uptr;
+  SWNVGcall* call;
+  float inset = radius*(1 - sqrtf(0.5f));  // inner rect clear of corner arcs
+  if (gl->flags & NVGSW_SDFGEN) return 0;
+  call = swnvg__allocCall(gl);
+  if (call == NULL) return 0;
+
+  // exact bounds, since coverage is exact
+  call->bounds[0] = swnvg__maxi((int)floorf(bounds[0]), 0);
+  call->bounds[1] = swnvg__maxi((int)floorf(bounds[1]), 0);
+  call->bounds[2] = swnvg__mini((int)ceilf(bounds[2]) - 1, gl->width-1);
+  call->bounds[3] = swnvg__mini((int)ceilf(bounds[3]) - 1, gl->height-1);
+  if (call->bounds[0] > call->bounds[2] || call->bounds[1] > call->bounds[3]) {
+    --gl->ncalls;
+    return 1;
+  }
+
+  swnvg__convertPaint(gl, call, paint, scissor, flags);
+  call->blendFunc = compOp;
+  swnvg__setupBlend(&call->blend, &compOp);
+  if (compOp.srcRGB != NVG_ONE || compOp.srcAlpha != NVG_ONE ||
+       compOp.dstRGB != NVG_ONE_MINUS_SRC_ALPHA || compOp.dstAlpha != NVG_ONE_MINUS_SRC_ALPHA) {
+    call->flags |= NVG_PATH_BLENDFUNC;
+  }
+  call->rect = 1;
+  memcpy(call->shape, rect, 4*sizeof(float));
+  call->shape[4] = radius;
+  call->edgeOffset = gl->nedges;
+  if (swnvg__isOpaqueCall(gl, call)) {
+    call->interior[0] = swnvg__maxi((int)ceilf(rect[0] + inset), call->bounds[0]);
+    call->interior[1] = swnvg__maxi((int)ceilf(rect[1] + inset), call->bounds[1]);
+    call->interior[2] = swnvg__mini((int)floorf(rect[2] - inset) - 1, call->bounds[2]);
+    call->interior[3] = swnvg__mini((int)floorf(rect[3] - inset) - 1, call->bounds[3]);
+    call->occluder = call->interior[0] <= call->interior[2] && call->interior[1] <= call->interior[3];
+  }
+  return 1;
+}
+
+static SWNVGedge* swnvg__allocEdge(SWNVGcontext* gl)
+{
+  if (gl->nedges+1 > gl->cedges) {
+    int cedges = gl->cedges > 0 ? gl->cedges * 2 : 64;
+    SWNVGedge* edges = (SWNVGedge*)realloc(gl->edges, sizeof(SWNVGedge) * cedges);
+    if (edges == NULL) return NULL;
+    gl->edges = edges;
+    gl->cedges = cedges;
+  }
+  return &gl->edges[gl->nedges++];
+}
+
+static int swnvg__renderLines(void* uptr, NVGpaint* paint, NVGcompositeOperationState compOp, NVGscissor* scissor,
+    int flags, const float* bounds, float strokeWidth, int lineCap, const NVGpath* paths, int npaths)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)uptr;
+  SWNVGcall* call;
+  float hw = 0.5f*strokeWidth;
+  int i, j, chunk = -1;
+  if (gl->flags & NVGSW_SDFGEN) return 0;
+  call = swnvg__allocCall(gl);
+  if (call == NULL) return 0;
+
+  call->bounds[0] = swnvg__clampi((int)bounds[0], 0, gl->width-1);
+  call->bounds[1] = swnvg__clampi((int)bounds[1], 0, gl->height-1);
+  call->bounds[2] = swnvg__clampi((int)(ceilf(bounds[2])), 0, gl->width-1);
+  call->bounds[3] = swnvg__clampi((int)(ceilf(bounds[3])), 0, gl->height-1);
+  if (call->bounds[0] > call->bounds[2] || call->bounds[1] > call->bounds[3]
+      || bounds[2] < 0 || bounds[3] < 0 || bounds[0] > gl->width || bounds[1] > gl->height) {
+    --gl->ncalls;
+    return 1;
+  }
+
+  swnvg__convertPaint(gl, call, paint, scissor, flags);
+  call->blendFunc = compOp;
+  swnvg__setupBlend(&call->blend, &compOp);
+  if (compOp.srcRGB != NVG_ONE || compOp.srcAlpha != NVG_ONE ||
+       compOp.dstRGB != NVG_ONE_MINUS_SRC_ALPHA || compOp.dstAlpha != NVG_ONE_MINUS_SRC_ALPHA) {
+    call->flags |= NVG_PATH_BLENDFUNC;
+  }
+  call->lines = 1;
+  call->lineWidth = strokeWidth;
+  call->sortState = 2;  // edges are chunks of segments, not to be sorted by row
+  call->edgeOffset = gl->nedges;
+  for (i = 0; i < npaths; ++i) {
+    const NVGpath* path = &paths[i];
+    int closed = path->closed && path->nfill > 2;
+    for (j = 0; j < path->nfill; ++j) {
+      const NVGvertex* v = &path->fill[j];
+      float x0 = v->x0, y0 = v->y0, x1 = v->x1, y1 = v->y1;
+      int ends = 0;
+      SWNVGedge *e, *c;
+      if (!closed && lineCap != NVG_ROUND)
+        ends = (j == 0 ? SWNVG__BUTT_START : 0) | (j == path->nfill-1 ? SWNVG__BUTT_END : 0);
+      if (ends && lineCap == NVG_SQUARE) {
+        // square cap is butt end extended by half width
+        float dx = x1 - x0, dy = y1 - y0, len = sqrtf(dx*dx + dy*dy);
+        float ex = len > 0 ? hw*dx/len : hw, ey = len > 0 ? hw*dy/len : 0;
+        if (ends & SWNVG__BUTT_START) { x0 -= ex;  y0 -= ey; }
+        if (ends & SWNVG__BUTT_END) { x1 += ex;  y1 += ey; }
+      }
+      else if (ends && x0 == x1 && y0 == y1)
+        continue;  // single point w/ butt caps
+      if (chunk < 0 || gl->edges[chunk].dir == SWNVG__LINE_CHUNK) {
+        if (!(c = swnvg__allocEdge(gl))) break;
+        chunk = gl->nedges - 1;
+        c->x0 = c->y0 = 1e30f;
+        c->x1 = c->y1 = -1e30f;
+        c->dir = 0;
+      }
+      if (!(e = swnvg__allocEdge(gl))) break;
+      e->x0 = x0;  e->y0 = y0;  e->x1 = x1;  e->y1 = y1;
+      e->dir = ends;
+      c = &gl->edges[chunk];
+      c->x0 = swnvg__minf(c->x0, swnvg__minf(x0, x1));
+      c->y0 = swnvg__minf(c->y0, swnvg__minf(y0, y1));
+      c->x1 = swnvg__maxf(c->x1, swnvg__maxf(x0, x1));
+      c->y1 = swnvg__maxf(c->y1, swnvg__maxf(y0, y1));
+      c->dir++;
+    }
+  }
+  call->edgeCount = gl->nedges - call->edgeOffset;
+  return 1;
+}
+
+// for atlas quads not aligned with pixel grid, get mapping from pixels to atlas texels from first quad
+static void swnvg__setupAffineQuads(SWNVGcontext* gl, SWNVGcall* call, const NVGvertex* verts, int nverts)
+{
+  int i, j;
+  SWNVGtexture* tex = swnvg__findTexture(gl, call->image);
+  if (!tex) return;
+  for (i = 0; i < nverts; i += 6) {
+    const NVGvertex *c0 = &verts[i], *c1 = NULL, *c3 = NULL;
+    float e1x, e1y, e3x, e3y, det, ds, dt;
+    // c1 has texcoords (s1,t0), c3 has (s0,t1)
+    for (j = i+1; j < i + 6; ++j) {
+      if (verts[j].x1 != c0->x1 && verts[j].y1 == c0->y1) c1 = &verts[j];
+      if (verts[j].x1 == c0->x1 && verts[j].y1 != c0->y1) c3 = &verts[j];
+    }
+    if (!c1 || !c3) continue;
+    e1x = c1->x0 - c0->x0;  e1y = c1->y0 - c0->y0;
+    e3x = c3->x0 - c0->x0;  e3y = c3->y0 - c0->y0;
+    if (i == 0 && e1y == 0 && e3x == 0 && e1x > 0 && e3y > 0)
+      return;  // axis-aligned
+    det = e1x*e3y - e3x*e1y;
+    if (det == 0) continue;
+    // inverse of [e1 e3], scaled by texel extent of quad
+    ds = (c1->x1 - c0->x1)*tex->width/det;
+    dt = (c3->y1 - c0->y1)*tex->height/det;
+    call->quadMat[0] = ds*e3y;
+    call->quadMat[1] = -ds*e3x;
+    call->quadMat[2] = -dt*e1y;
+    call->quadMat[3] = dt*e1x;
+    call->affineQuads = 1;
+    return;
+  }
 }
 
 static void swnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOperationState compOp,
     NVGscissor* scissor, const NVGvertex* verts, int nverts)
 {
-  int i;
+  int i, j;
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
   SWNVGcall* call = swnvg__allocCall(gl);
   if (call == NULL) return;
@@ -1547,12 +4989,23 @@ static void swnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOper
   //if (offset == -1) goto error;
   call->triangleOffset = offset;
 
+  float xmin = (float)gl->width, ymin = (float)gl->height, xmax = 0, ymax = 0;
   for (i = 0; i < nverts; i += 6) {
+    // quad is stored as corners with texcoords (s0,t0) and (s1,t1); order of triangle verts depends on winding
+    int k11 = verts[i+1].x1 != verts[i].x1 && verts[i+1].y1 != verts[i].y1 ? i+1 : i+2;
     gl->verts[offset++] = verts[i];
-    gl->verts[offset++] = verts[i+1];
+    gl->verts[offset++] = verts[k11];
+    for (j = i; j < i + 6; ++j) {
+      xmin = swnvg__minf(xmin, verts[j].x0);  ymin = swnvg__minf(ymin, verts[j].y0);
+      xmax = swnvg__maxf(xmax, verts[j].x0);  ymax = swnvg__maxf(ymax, verts[j].y0);
+    }
   }
 
-  call->bounds[0] = 0; call->bounds[1] = 0; call->bounds[2] = gl->width-1; call->bounds[3] = gl->height-1;
+  // bounds of quads, so that call is only binned to tiles containing text
+  call->bounds[0] = swnvg__maxi(0, (int)floorf(xmin));
+  call->bounds[1] = swnvg__maxi(0, (int)floorf(ymin));
+  call->bounds[2] = swnvg__mini(gl->width-1, (int)ceilf(xmax));
+  call->bounds[3] = swnvg__mini(gl->height-1, (int)ceilf(ymax));
   // cut and paste from nanovg.c - alternative is to pass scissor bounds to renderTriangles()
   if (scissor->extent[0] > -0.5f && scissor->extent[1] > -0.5f) {
     float* sxform = scissor->xform;
@@ -1565,8 +5018,16 @@ static void swnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGcompositeOper
     call->bounds[3] = swnvg__mini(call->bounds[3], ceilf(sxform[5]+tey));
   }
 
+  if (call->bounds[0] > call->bounds[2] || call->bounds[1] > call->bounds[3]) {
+    --gl->ncalls;
+    gl->nverts -= call->triangleCount;
+    return;
+  }
   swnvg__convertPaint(gl, call, paint, scissor, 0);
+  swnvg__setupBlend(&call->blend, &compOp);
   call->type = SWNVG_PAINT_ATLAS;
+  call->glyphOffset = -1;
+  swnvg__setupAffineQuads(gl, call, verts, nverts);
   return;
 }
 
@@ -1576,27 +5037,56 @@ static void swnvg__renderDelete(void* uptr)
   SWNVGcontext* gl = (SWNVGcontext*)uptr;
   if (gl == NULL) return;
 
+  swnvg__finishFrame(gl);
+  swnvg__poolDelete(gl->pool);
   nthreads = gl->xthreads*gl->ythreads;
   for(ii = 0; ii < nthreads; ++ii) {
-    SWNVGmemPage* p = gl->threads[ii].pages;
-    while (p != NULL) {
-      SWNVGmemPage* next = p->next;
-      free(p);
-      p = next;
-    }
+    free(gl->threads[ii].aetX);
+    free(gl->threads[ii].aetDx);
+    free(gl->threads[ii].aetEy);
+    free(gl->threads[ii].aetDir);
     free(gl->threads[ii].scanline);
+    free(gl->threads[ii].spanColors);
+    free(gl->threads[ii].spanDist);
+    free(gl->threads[ii].mipColors);
+    free(gl->threads[ii].clipRows);
     free(gl->threads[ii].lineLimits);
+    free(gl->threads[ii].covtex);
+    free(gl->threads[ii].sdfDist);
+    free(gl->threads[ii].lineCov);
+    free(gl->threads[ii].lineRows);
+    free(gl->threads[ii].sortEdges);
+    free(gl->threads[ii].sortCounts);
   }
   for (ii = 0; ii < gl->ntextures; ++ii) {
     if (gl->textures[ii].id != 0 && (gl->textures[ii].flags & NVG_IMAGE_NOCOPY) == 0)
       free(gl->textures[ii].data);
+    free(gl->textures[ii].mips);
   }
   free(gl->threads);
-  free(gl->covtex);
+  free(gl->tileCallStart);
+  free(gl->tileCalls);
+  free(gl->prevCalls);
+  free(gl->curCalls);
+  free(gl->dirtyTiles);
+  free(gl->damageTiles);
+  free(gl->damageRects);
   free(gl->textures);
   free(gl->verts);
+  free(gl->ramps);
   free(gl->calls);
   free(gl->edges);
+  free(gl->spareCalls);
+  free(gl->spareVerts);
+  free(gl->spareRamps);
+  free(gl->spareEdges);
+  free(gl->flight);
+  for (ii = 0; ii < gl->nglyphs; ++ii)
+    free(gl->glyphs[ii].cover);
+  free(gl->glyphs);
+  free(gl->glyphHash);
+  free(gl->quadGlyphs);
+  free(gl->newGlyphs);
   free(gl);
 }
 
@@ -1607,8 +5097,12 @@ NVGcontext* nvgswCreate(int flags)
   SWNVGcontext* gl = (SWNVGcontext*)malloc(sizeof(SWNVGcontext));
   if (gl == NULL) goto error;
   memset(gl, 0, sizeof(SWNVGcontext));
+  gl->freeGlyph = gl->lruHead = gl->lruTail = -1;
+  gl->maxGlyphBytes = 4 << 20;
+  gl->sdfRadius = 4;
+  gl->sdfScale = -32.0f;
+  gl->sdfOffset = 127.0f;
 
-  flags |= NVG_ROTATED_TEXT_AS_PATHS;  // we don't support rotated text with font atlas
   memset(&params, 0, sizeof(params));
   params.renderCreate = swnvg__renderCreate;
   params.renderCreateTexture = swnvg__renderCreateTexture;
@@ -1620,11 +5114,17 @@ NVGcontext* nvgswCreate(int flags)
   params.renderFlush = swnvg__renderFlush;
   params.renderFill = swnvg__renderFill;
   params.renderTriangles = swnvg__renderTriangles;
+  params.renderRect = swnvg__renderRect;
+  params.renderLines = swnvg__renderLines;
+  params.thinStrokeWidth = NVGSW_THIN_STROKE_WIDTH;
   params.renderDelete = swnvg__renderDelete;
+  params.renderGetStats = swnvg__renderGetStats;
   params.userPtr = gl;
   params.flags = flags;
 
-  gl->flags = flags;
+  // premultiplied kernels do not support linear blending
+  gl->flags = flags & NVGSW_PREMULTIPLIED ? flags & ~NVG_SRGB : flags;
+  swnvg__initKernels(gl);
   ctx = nvgCreateInternal(&params);
   if (ctx == NULL) goto error;
   // default (no threading) setup
@@ -1659,44 +5159,149 @@ void nvgswSetThreading(NVGcontext* vg, int xthreads, int ythreads, poolSubmit_t
   gl->ythreads = ythreads;
   gl->poolSubmit = submit;
   gl->poolWait = wait;
+  swnvg__poolDelete(gl->pool);
+  gl->pool = NULL;
   NVG_LOG("nvg2: %d x %d threads\n", xthreads, ythreads);
 }
 
-void nvgswSetFramebuffer(NVGcontext* vg, void* dest, int w, int h, int rshift, int gshift, int bshift, int ashift)
+void nvgswSetThreadCount(NVGcontext* vg, int n)
 {
-  int ii, jj;
   SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
-  if(gl->covtex && (w != gl->width || h != gl->height)) {
-    free(gl->covtex);
-    gl->covtex = NULL;
+  SWNVGpool* pool;
+  if (n < 2 || gl->bitmap) return;
+  pool = swnvg__poolCreate(n - 1, gl->flags & NVGSW_PIN_THREADS);
+  if (!pool) return;
+  nvgswSetThreading(vg, n, 1, NULL, NULL);
+  if (gl->xthreads*gl->ythreads != n) {
+    swnvg__poolDelete(pool);
+    return;
+  }
+  gl->pool = pool;
+}
+
+static void swnvg__setFramebuffer(SWNVGcontext* gl, void* dest, int w, int h, int stride, int format,
+    int rshift, int gshift, int bshift, int ashift)
+{
+  int ii;
+  int tileW = gl->tileW, tileH = gl->tileH, width = gl->width;
+  swnvg__finishFrame(gl);
+  if (format != gl->format || !gl->bpp) {
+    swnvg__initFormat(gl, format);
+    gl->damageValid = 0;
   }
-  gl->bitmap = (unsigned char*)dest;  gl->width = w;  gl->height = h;  gl->stride = 4*w;
+  if (stride <= 0)
+    stride = w*gl->bpp;
+  if (dest != gl->bitmap || w != gl->width || h != gl->height || stride != gl->stride || rshift != gl->rshift
+      || gshift != gl->gshift || bshift != gl->bshift || ashift != gl->ashift)
+    gl->damageValid = 0;
+  gl->bitmap = (unsigned char*)dest;  gl->width = w;  gl->height = h;  gl->stride = stride;
   gl->rshift = rshift;  gl->gshift = gshift;  gl->bshift = bshift;  gl->ashift = ashift;
 
-  int threadw = w/gl->xthreads + 1;
-  int threadh = h/gl->ythreads + 1;
-  for (jj = 0; jj < gl->ythreads; ++jj) {
-    for (ii = 0; ii < gl->xthreads; ++ii) {
-      SWNVGthreadCtx* r = &gl->threads[jj*gl->xthreads + ii];
-      r->x0 = ii*threadw;
-      r->y0 = jj*threadh;
-      r->x1 = swnvg__mini(w, r->x0 + threadw) - 1;
-      r->y1 = swnvg__mini(h, r->y0 + threadh) - 1;
-      if (r->x1 - r->x0 + 1 > r->cscanline) {
-        r->cscanline = r->x1 - r->x0 + 1;
-        r->scanline = (unsigned char*)realloc(r->scanline, r->cscanline);
-        if (r->scanline == NULL) return;
-        memset(r->scanline, 0, r->cscanline);
-      }
-      // reset lineLimits whenever covtex is reset (whenever FB dimensions change)
-      if(r->lineLimits && !gl->covtex) {
-        free(r->lineLimits);
-        r->lineLimits = NULL;
-      }
+  // single threaded, we use wide tiles to reduce per-tile overhead (but still small enough for XC coverage
+  //  buffer to stay in cache), unless damage tracking, where smaller tiles mean less to redraw; tile height is
+  //  the same for any thread count, so that output is too: the sub-scanline rasterizer starts edges again at the
+  //  top of each tile instead of continuing its fixed point stepping from above, so edge positions (and thus
+  //  output) depend on where tiles start, though they are slightly more accurate for restarting
+  gl->tileW = swnvg__mini(w, gl->xthreads*gl->ythreads > 1 || (gl->flags & NVGSW_DAMAGE) ?
+      NVGSW_TILE_SIZE : 16*NVGSW_TILE_SIZE);
+  gl->tileH = swnvg__mini(h, NVGSW_TILE_SIZE);
+  gl->xtiles = (w + gl->tileW - 1)/gl->tileW;
+  gl->ytiles = (h + gl->tileH - 1)/gl->tileH;
+  gl->tileCallStart = (int*)realloc(gl->tileCallStart, sizeof(int)*(gl->xtiles*gl->ytiles + 1));
+  if (gl->tileCallStart == NULL) return;
+  if (gl->flags & NVGSW_DAMAGE) {
+    int ntiles = gl->xtiles*gl->ytiles;
+    gl->dirtyTiles = (unsigned char*)realloc(gl->dirtyTiles, ntiles);
+    gl->damageTiles = (int*)realloc(gl->damageTiles, sizeof(int)*ntiles);
+    gl->damageRects = (int*)realloc(gl->damageRects, sizeof(int)*4*ntiles);
+    gl->ndamageRects = 0;
+    if (!gl->dirtyTiles || !gl->damageTiles || !gl->damageRects) return;
+  }
+  for (ii = 0; ii < gl->xthreads*gl->ythreads; ++ii) {
+    SWNVGthreadCtx* r = &gl->threads[ii];
+    if (gl->tileW > r->cscanline) {
+      r->cscanline = gl->tileW;
+      r->scanline = (unsigned char*)realloc(r->scanline, r->cscanline);
+      r->spanColors = (rgba32_t*)realloc(r->spanColors, r->cscanline*sizeof(rgba32_t));
+      r->spanDist = (float*)realloc(r->spanDist, r->cscanline*sizeof(float));
+      r->mipColors = (rgba32_t*)realloc(r->mipColors, r->cscanline*sizeof(rgba32_t));
+      if (!r->scanline || !r->spanColors || !r->spanDist || !r->mipColors) return;
+      memset(r->scanline, 0, r->cscanline);
+    }
+    // reset XC buffers if tile size changes, or width, which lineLimits are reset to
+    if(tileW != gl->tileW || tileH != gl->tileH || width != gl->width) {
+      free(r->covtex);
+      free(r->lineLimits);
+      free(r->sdfDist);
+      free(r->lineCov);
+      free(r->lineRows);
+      r->covtex = NULL;
+      r->lineLimits = NULL;
+      r->sdfDist = NULL;
+      r->lineCov = NULL;
+      r->lineRows = NULL;
     }
   }
 }
 
+void nvgswSetFramebuffer(NVGcontext* vg, void* dest, int w, int h, int rshift, int gshift, int bshift, int ashift)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
+  swnvg__setFramebuffer(gl, dest, w, h, 0, NVGSW_RGBA8, rshift, gshift, bshift, ashift);
+}
+
+void nvgswSetFramebufferFormat(NVGcontext* vg, void* dest, int w, int h, int stride, int format)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
+  // colors (including texture data) are converted to framebuffer channel order; other formats use RGBA order
+  if (format == NVGSW_BGRA8)
+    swnvg__setFramebuffer(gl, dest, w, h, stride, format, 16, 8, 0, 24);
+  else
+    swnvg__setFramebuffer(gl, dest, w, h, stride, format, 0, 8, 16, 24);
+}
+
+int nvgswGetDamage(NVGcontext* vg, const int** rects)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
+  if (rects) *rects = gl->damageRects;
+  return gl->ndamageRects;
+}
+
+void nvgswSetSDFParams(NVGcontext* vg, int radius, float scale, float offset)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
+  swnvg__finishFrame(gl);
+  gl->sdfRadius = swnvg__maxi(radius, 0);
+  gl->sdfScale = scale;
+  gl->sdfOffset = offset;
+}
+
+void nvgswSetGlyphCacheSize(NVGcontext* vg, int maxBytes)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
+  swnvg__finishFrame(gl);
+  gl->maxGlyphBytes = swnvg__maxi(maxBytes, 0);
+  while (gl->glyphBytes > gl->maxGlyphBytes && gl->lruTail >= 0)
+    swnvg__removeGlyph(gl, gl->lruTail);
+}
+
+void nvgswSetThinStrokeWidth(NVGcontext* vg, float width)
+{
+  nvgInternalParams(vg)->thinStrokeWidth = width;
+}
+
+void nvgswWaitFrame(NVGcontext* vg)
+{
+  swnvg__finishFrame((SWNVGcontext*)nvgInternalParams(vg)->userPtr);
+}
+
+void nvgswGetCullStats(NVGcontext* vg, int* skippedCalls, int* skippedPixels)
+{
+  SWNVGcontext* gl = (SWNVGcontext*)nvgInternalParams(vg)->userPtr;
+  if (skippedCalls) *skippedCalls = gl->culledCalls;
+  if (skippedPixels) *skippedPixels = gl->culledPixels;
+}
+
 void nvgswDelete(NVGcontext* ctx)
 {
   nvgDeleteInternal(ctx);